@@ -395,6 +395,40 @@ TEST_F(DBOptionsTest, SetOptionsMayTriggerCompaction) {
   ASSERT_EQ("0,1", FilesPerLevel());
 }
 
+TEST_F(DBOptionsTest, SetOptionsFilterKindPerLevel) {
+  Options options;
+  options.create_if_missing = true;
+  options.env = env_;
+  BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  auto num_files_without_filter = [&]() {
+    TablePropertiesCollection props;
+    EXPECT_OK(db_->GetPropertiesOfAllTables(&props));
+    int count = 0;
+    for (const auto& item : props) {
+      if (item.second->filter_size == 0) {
+        count++;
+      }
+    }
+    return count;
+  };
+
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(0, num_files_without_filter());
+
+  ASSERT_OK(dbfull()->SetOptions(
+      {{"filter_kind_per_level", "kFilterKindNone:kFilterKindOtLexPdt"}}));
+  ASSERT_EQ(2U, dbfull()->GetOptions().filter_kind_per_level.size());
+  ASSERT_OK(Put("foo", "v2"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, num_files_without_filter());
+  ASSERT_EQ("v2", Get("foo"));
+}
+
 TEST_F(DBOptionsTest, SetBackgroundCompactionThreads) {
   Options options;
   options.create_if_missing = true;
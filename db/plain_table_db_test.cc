@@ -1127,6 +1127,91 @@ TEST_P(PlainTableDBTest, NonExistingKeyToNonEmptyBucket) {
   delete iter;
 }
 
+TEST_P(PlainTableDBTest, PrefixTrieIndex) {
+  for (EncodingType encoding_type : {kPlain, kPrefix}) {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    PlainTableOptions plain_table_options;
+    plain_table_options.user_key_len = 16;
+    plain_table_options.bloom_bits_per_key = 10;
+    plain_table_options.index_sparseness = 2;
+    plain_table_options.encoding_type = encoding_type;
+    plain_table_options.prefix_trie_index = true;
+
+    options.table_factory.reset(NewPlainTableFactory(plain_table_options));
+    DestroyAndReopen(&options);
+    ASSERT_OK(Put("0000000000000bar", "v0"));
+    for (int i = 0; i < 10; i++) {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "1000000000000%03d", i);
+      ASSERT_OK(Put(buf, ToString(i)));
+    }
+    ASSERT_OK(Put("3000000000000bar", "v3"));
+    ASSERT_OK(Put("5000000000000foo", "v5"));
+    dbfull()->TEST_FlushMemTable();
+
+    TablePropertiesCollection ptc;
+    reinterpret_cast<DB*>(dbfull())->GetPropertiesOfAllTables(&ptc);
+    ASSERT_EQ(1U, ptc.size());
+    auto& user_props = ptc.begin()->second->user_collected_properties;
+    ASSERT_EQ("0", user_props.at("plain_table_hash_table_size"));
+    ASSERT_TRUE(user_props.find("plain_table_prefix_trie_size") !=
+                user_props.end());
+
+    ASSERT_EQ("v0", Get("0000000000000bar"));
+    ASSERT_EQ("0", Get("1000000000000000"));
+    ASSERT_EQ("7", Get("1000000000000007"));
+    ASSERT_EQ("9", Get("1000000000000009"));
+    ASSERT_EQ("v3", Get("3000000000000bar"));
+    ASSERT_EQ("v5", Get("5000000000000foo"));
+    ASSERT_EQ("NOT_FOUND", Get("1000000000000010"));
+    ASSERT_EQ("NOT_FOUND", Get("2000000000000bar"));
+    ASSERT_EQ("NOT_FOUND", Get("9000000000000bar"));
+
+    Iterator* iter = dbfull()->NewIterator(ReadOptions());
+    iter->Seek("1000000000000004");
+    for (int i = 4; i < 10; i++) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ("1000000000000" + std::string(2, '0') + ToString(i),
+                iter->key().ToString());
+      iter->Next();
+    }
+    iter->Seek("2000000000000bar");
+    ASSERT_TRUE(!iter->Valid());
+    delete iter;
+
+    // The trie keeps the prefixes in order, which allows total order seeks.
+    ReadOptions ro;
+    ro.total_order_seek = true;
+    iter = dbfull()->NewIterator(ro);
+    iter->Seek("");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("0000000000000bar", iter->key().ToString());
+    iter->Seek("2");
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("3000000000000bar", iter->key().ToString());
+    iter->Seek("1000000000000005");
+    for (int i = 5; i < 10; i++) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(ToString(i), iter->value().ToString());
+      iter->Next();
+    }
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("3000000000000bar", iter->key().ToString());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ("5000000000000foo", iter->key().ToString());
+    iter->Next();
+    ASSERT_TRUE(!iter->Valid());
+    iter->Seek("5000000000000fop");
+    ASSERT_TRUE(!iter->Valid());
+    iter->Seek("6");
+    ASSERT_TRUE(!iter->Valid());
+    ASSERT_OK(iter->status());
+    delete iter;
+  }
+}
+
 static std::string Key(int i) {
   char buf[100];
   snprintf(buf, sizeof(buf), "key_______%06d", i);
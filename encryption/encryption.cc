@@ -10,6 +10,7 @@
 #include <openssl/opensslv.h>
 
 #include "port/port.h"
+#include "util/mutexlock.h"
 
 namespace rocksdb {
 namespace encryption {
@@ -46,6 +47,52 @@ void PutBigEndian64(uint64_t value, unsigned char* buf) {
 }
 }  // anonymous namespace
 
+AESCTRCipherStream::~AESCTRCipherStream() {
+  for (EVP_CIPHER_CTX* ctx : free_contexts_) {
+    EVP_CIPHER_CTX_free(ctx);
+  }
+}
+
+Status AESCTRCipherStream::AcquireContext(EVP_CIPHER_CTX** ctx) {
+  {
+    MutexLock l(&mutex_);
+    if (!free_contexts_.empty()) {
+      *ctx = free_contexts_.back();
+      free_contexts_.pop_back();
+      return Status::OK();
+    }
+  }
+  *ctx = EVP_CIPHER_CTX_new();
+  if (*ctx == nullptr) {
+    return Status::IOError("Failed to create cipher context.");
+  }
+  // The context is always keyed for encryption, which CTR mode also uses to
+  // decrypt.
+  int ret = EVP_CipherInit_ex(
+      *ctx, cipher_, nullptr /*engine*/,
+      reinterpret_cast<const unsigned char*>(key_.data()), nullptr /*iv*/,
+      1 /*enc*/);
+  if (ret != 1) {
+    EVP_CIPHER_CTX_free(*ctx);
+    *ctx = nullptr;
+    return Status::IOError("Failed to init cipher.");
+  }
+  // Disable padding. After disabling padding, data size should always be
+  // multiply of block size.
+  ret = EVP_CIPHER_CTX_set_padding(*ctx, 0);
+  if (ret != 1) {
+    EVP_CIPHER_CTX_free(*ctx);
+    *ctx = nullptr;
+    return Status::IOError("Failed to disable padding for cipher context.");
+  }
+  return Status::OK();
+}
+
+void AESCTRCipherStream::ReleaseContext(EVP_CIPHER_CTX* ctx) {
+  MutexLock l(&mutex_);
+  free_contexts_.push_back(ctx);
+}
+
 // AESCTRCipherStream use OpenSSL EVP API with CTR mode to encrypt and decrypt
 // data, instead of using the CTR implementation provided by
 // BlockAccessCipherStream. Benefits:
@@ -59,21 +106,32 @@ void PutBigEndian64(uint64_t value, unsigned char* buf) {
 // * SO answer for random access: https://stackoverflow.com/a/57147140/11014942
 // * https://medium.com/@amit.kulkarni/encrypting-decrypting-a-file-using-openssl-evp-b26e0e4d28d4
 Status AESCTRCipherStream::Cipher(uint64_t file_offset, char* data,
-                                  size_t data_size, bool is_encrypt) {
+                                  size_t data_size) {
 #if OPENSSL_VERSION_NUMBER < 0x01000200f
   (void)file_offset;
   (void)data;
   (void)data_size;
-  (void)is_encrypt;
   return Status::NotSupported("OpenSSL version < 1.0.2");
 #else
-  int ret = 1;
   EVP_CIPHER_CTX* ctx = nullptr;
-  InitCipherContext(ctx);
-  if (ctx == nullptr) {
-    return Status::IOError("Failed to create cipher context.");
+  Status s = AcquireContext(&ctx);
+  if (!s.ok()) {
+    return s;
+  }
+  s = Cipher(ctx, file_offset, data, data_size);
+  if (s.ok()) {
+    ReleaseContext(ctx);
+  } else {
+    // Do not reuse a context left in an unknown state
+    EVP_CIPHER_CTX_free(ctx);
   }
+  return s;
+#endif
+}
 
+Status AESCTRCipherStream::Cipher(EVP_CIPHER_CTX* ctx, uint64_t file_offset,
+                                  char* data, size_t data_size) {
+  int ret = 1;
   uint64_t block_index = file_offset / AES_BLOCK_SIZE;
   uint64_t block_offset = file_offset % AES_BLOCK_SIZE;
 
@@ -92,18 +150,12 @@ Status AESCTRCipherStream::Cipher(uint64_t file_offset, char* data,
   PutBigEndian64(iv_high, iv);
   PutBigEndian64(iv_low, iv + sizeof(uint64_t));
 
-  ret = EVP_CipherInit(ctx, cipher_,
-                       reinterpret_cast<const unsigned char*>(key_.data()), iv,
-                       (is_encrypt ? 1 : 0));
+  // Only set the IV, which also resets the block counter. The key schedule
+  // is kept from AcquireContext().
+  ret = EVP_CipherInit_ex(ctx, nullptr /*cipher*/, nullptr /*engine*/,
+                          nullptr /*key*/, iv, 1 /*enc*/);
   if (ret != 1) {
-    return Status::IOError("Failed to init cipher.");
-  }
-
-  // Disable padding. After disabling padding, data size should always be
-  // multiply of block size.
-  ret = EVP_CIPHER_CTX_set_padding(ctx, 0);
-  if (ret != 1) {
-    return Status::IOError("Failed to disable padding for cipher context.");
+    return Status::IOError("Failed to set cipher iv.");
   }
 
   uint64_t data_offset = 0;
@@ -175,9 +227,7 @@ Status AESCTRCipherStream::Cipher(uint64_t file_offset, char* data,
     }
     memcpy(data + data_offset, partial_block, remaining_data_size);
   }
-  FreeCipherContext(ctx);
   return Status::OK();
-#endif
 }
 
 Status NewAESCTRCipherStream(EncryptionMethod method, const std::string& key,
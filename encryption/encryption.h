@@ -7,7 +7,9 @@
 #include <openssl/evp.h>
 
 #include <string>
+#include <vector>
 
+#include "port/port.h"
 #include "rocksdb/encryption.h"
 #include "rocksdb/env_encryption.h"
 #include "util/string_util.h"
@@ -48,18 +50,19 @@ class AESCTRCipherStream : public BlockAccessCipherStream {
         initial_iv_high_(iv_high),
         initial_iv_low_(iv_low) {}
 
-  ~AESCTRCipherStream() = default;
+  ~AESCTRCipherStream();
 
   size_t BlockSize() override {
     return AES_BLOCK_SIZE;  // 16
   }
 
   Status Encrypt(uint64_t file_offset, char* data, size_t data_size) override {
-    return Cipher(file_offset, data, data_size, true /*is_encrypt*/);
+    return Cipher(file_offset, data, data_size);
   }
 
   Status Decrypt(uint64_t file_offset, char* data, size_t data_size) override {
-    return Cipher(file_offset, data, data_size, false /*is_encrypt*/);
+    // CTR mode decrypts by encrypting again.
+    return Cipher(file_offset, data, data_size);
   }
 
  protected:
@@ -81,13 +84,24 @@ class AESCTRCipherStream : public BlockAccessCipherStream {
   }
 
  private:
-  Status Cipher(uint64_t file_offset, char* data, size_t data_size,
-                bool is_encrypt);
+  Status Cipher(uint64_t file_offset, char* data, size_t data_size);
+  Status Cipher(EVP_CIPHER_CTX* ctx, uint64_t file_offset, char* data,
+                size_t data_size);
+
+  // Returns a context keyed with key_, taken from the free ones if any.
+  // Setting the key runs the whole AES key schedule, the contexts are reused
+  // so that each call only resets the IV.
+  Status AcquireContext(EVP_CIPHER_CTX** ctx);
+  void ReleaseContext(EVP_CIPHER_CTX* ctx);
 
   const EVP_CIPHER* cipher_;
   const std::string key_;
   const uint64_t initial_iv_high_;
   const uint64_t initial_iv_low_;
+
+  port::Mutex mutex_;
+  // Keyed contexts not in use, one per concurrent caller at most
+  std::vector<EVP_CIPHER_CTX*> free_contexts_;
 };
 
 extern Status NewAESCTRCipherStream(
@@ -0,0 +1,267 @@
+// Copyright 2020 TiKV Project Authors. Licensed under Apache-2.0.
+
+#if !defined(GFLAGS) || defined(ROCKSDB_LITE) || !defined(OPENSSL)
+#include <cstdio>
+int main() {
+  fprintf(stderr,
+          "Please install gflags and build with OpenSSL to run "
+          "encryption_bench\n");
+  return 1;
+}
+#else
+
+#include <cinttypes>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "encryption/encryption.h"
+#include "encryption/in_memory_key_manager.h"
+#include "port/port.h"
+#include "rocksdb/encryption.h"
+#include "rocksdb/env.h"
+#include "test_util/testutil.h"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+#include "util/string_util.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_string(benchmarks, "cipher,cipher_rekey,append,read",
+              "Comma-separated list of benchmarks to run, among cipher "
+              "(en/decrypt through one cipher stream), cipher_rekey (a new "
+              "cipher stream per call, setting the key every time), append "
+              "and read (file writes and random reads through the encrypted "
+              "env, compared to the plain one)");
+DEFINE_string(encryption_method, "AES128CTR",
+              "AES128CTR, AES192CTR or AES256CTR");
+DEFINE_int32(block_size, 4096, "Size of each read, write or cipher call");
+DEFINE_int64(num_ops, 100000, "Number of calls of each benchmark and thread");
+DEFINE_int64(file_size, 64 << 20, "Size of the file written and read");
+DEFINE_int32(threads, 1, "Number of threads of the cipher and read "
+             "benchmarks");
+DEFINE_string(path, "", "Directory of the benchmark file, a test directory "
+              "by default");
+DEFINE_int64(seed, 301, "Seed of the random offsets");
+
+namespace rocksdb {
+namespace encryption {
+
+namespace {
+
+class EncryptionBench {
+ public:
+  explicit EncryptionBench(EncryptionMethod method)
+      : env_(Env::Default()),
+        method_(method),
+        key_manager_(new InMemoryKeyManager(method)),
+        encrypted_env_(NewKeyManagedEncryptedEnv(env_, key_manager_)) {
+    Random rnd(static_cast<uint32_t>(FLAGS_seed));
+    key_ = test::RandomHumanReadableString(&rnd,
+                                           static_cast<int>(KeySize(method)));
+    iv_ = test::RandomHumanReadableString(&rnd, AES_BLOCK_SIZE);
+  }
+
+  Status Init() {
+    std::string path = FLAGS_path;
+    if (path.empty()) {
+      Status s = env_->GetTestDirectory(&path);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    env_->CreateDirIfMissing(path);
+    fname_ = path + "/encryption_bench";
+    return Status::OK();
+  }
+
+  bool Run(const std::string& name) {
+    Status s;
+    if (name == "cipher" || name == "cipher_rekey") {
+      s = RunThreads(name, nullptr /*env*/, [&](int id, Status* ts) {
+        CipherOps(id, name == "cipher_rekey", ts);
+      });
+    } else if (name == "append") {
+      s = CompareEnvs(
+          [&](Env* env, Status* ts) { *ts = Append(env, true /*report*/); });
+    } else if (name == "read") {
+      s = CompareEnvs([&](Env* env, Status* ts) {
+        *ts = Append(env, false /*report*/);
+        if (ts->ok()) {
+          *ts = RunThreads(name, env, [&](int id, Status* rs) {
+            ReadOps(env, id, rs);
+          });
+        }
+      });
+    } else {
+      fprintf(stderr, "Unknown benchmark %s\n", name.c_str());
+      return false;
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "%s: %s\n", name.c_str(), s.ToString().c_str());
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  // Runs fn in FLAGS_threads threads and reports the rate of all their calls
+  template <typename Fn>
+  Status RunThreads(const std::string& name, Env* env, Fn fn) {
+    std::vector<port::Thread> threads;
+    std::vector<Status> status(FLAGS_threads);
+    uint64_t start = env_->NowNanos();
+    for (int i = 0; i < FLAGS_threads; i++) {
+      threads.emplace_back([&, i]() { fn(i, &status[i]); });
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    uint64_t elapsed = env_->NowNanos() - start;
+    for (const auto& s : status) {
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    Report(name, env, FLAGS_num_ops * FLAGS_threads, elapsed);
+    return Status::OK();
+  }
+
+  // Runs fn on the plain env then on the encrypted one
+  template <typename Fn>
+  Status CompareEnvs(Fn fn) {
+    for (Env* env : {env_, encrypted_env_.get()}) {
+      Status s;
+      fn(env, &s);
+      env->DeleteFile(fname_);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    return Status::OK();
+  }
+
+  void Report(const std::string& name, Env* env, int64_t ops,
+              uint64_t elapsed_nanos) {
+    double secs = elapsed_nanos / 1e9;
+    const char* env_name =
+        env == nullptr ? "" : (env == env_ ? " (plain)" : " (encrypted)");
+    fprintf(stdout, "%-12s%-12s : %10.1f ns/op %10.1f MB/s\n", name.c_str(),
+            env_name, static_cast<double>(elapsed_nanos) / ops,
+            ops * FLAGS_block_size / 1048576.0 / secs);
+  }
+
+  void CipherOps(int id, bool rekey, Status* s) {
+    std::unique_ptr<AESCTRCipherStream> stream;
+    std::string data(FLAGS_block_size, 'x');
+    Random64 rnd(FLAGS_seed + id);
+    for (int64_t i = 0; i < FLAGS_num_ops && s->ok(); i++) {
+      if (rekey || stream == nullptr) {
+        *s = NewAESCTRCipherStream(method_, key_, iv_, &stream);
+        if (!s->ok()) {
+          break;
+        }
+      }
+      uint64_t offset = rnd.Uniform(FLAGS_file_size);
+      *s = (i % 2 == 0)
+               ? stream->Encrypt(offset, &data[0], data.size())
+               : stream->Decrypt(offset, &data[0], data.size());
+    }
+  }
+
+  Status Append(Env* env, bool report) {
+    std::unique_ptr<WritableFile> file;
+    Status s = env->NewWritableFile(fname_, &file, EnvOptions());
+    if (!s.ok()) {
+      return s;
+    }
+    std::string data(FLAGS_block_size, 'x');
+    int64_t ops = FLAGS_file_size / FLAGS_block_size;
+    uint64_t start = env_->NowNanos();
+    for (int64_t i = 0; i < ops && s.ok(); i++) {
+      s = file->Append(data);
+    }
+    if (s.ok()) {
+      s = file->Sync();
+    }
+    if (s.ok()) {
+      s = file->Close();
+    }
+    if (s.ok() && report) {
+      Report("append", env, ops, env_->NowNanos() - start);
+    }
+    return s;
+  }
+
+  void ReadOps(Env* env, int id, Status* s) {
+    std::unique_ptr<RandomAccessFile> file;
+    *s = env->NewRandomAccessFile(fname_, &file, EnvOptions());
+    if (!s->ok()) {
+      return;
+    }
+    std::unique_ptr<char[]> scratch(new char[FLAGS_block_size]);
+    Random64 rnd(FLAGS_seed + id);
+    uint64_t max_offset = FLAGS_file_size - FLAGS_block_size;
+    Slice result;
+    for (int64_t i = 0; i < FLAGS_num_ops && s->ok(); i++) {
+      *s = file->Read(rnd.Uniform(max_offset + 1), FLAGS_block_size, &result,
+                      scratch.get());
+    }
+  }
+
+  Env* env_;
+  const EncryptionMethod method_;
+  std::shared_ptr<KeyManager> key_manager_;
+  std::unique_ptr<Env> encrypted_env_;
+  std::string key_;
+  std::string iv_;
+  std::string fname_;
+};
+
+}  // namespace
+
+}  // namespace encryption
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+
+  using rocksdb::encryption::EncryptionMethod;
+  EncryptionMethod method = EncryptionMethod::kUnknown;
+  if (!strcasecmp(FLAGS_encryption_method.c_str(), "AES128CTR")) {
+    method = EncryptionMethod::kAES128_CTR;
+  } else if (!strcasecmp(FLAGS_encryption_method.c_str(), "AES192CTR")) {
+    method = EncryptionMethod::kAES192_CTR;
+  } else if (!strcasecmp(FLAGS_encryption_method.c_str(), "AES256CTR")) {
+    method = EncryptionMethod::kAES256_CTR;
+  }
+  if (method == EncryptionMethod::kUnknown) {
+    fprintf(stderr, "Unknown encryption method %s\n",
+            FLAGS_encryption_method.c_str());
+    return 1;
+  }
+  if (FLAGS_block_size <= 0 || FLAGS_num_ops <= 0 || FLAGS_threads <= 0 ||
+      FLAGS_file_size < FLAGS_block_size) {
+    fprintf(stderr, "Invalid size, operation or thread options\n");
+    return 1;
+  }
+
+  rocksdb::encryption::EncryptionBench bench(method);
+  rocksdb::Status s = bench.Init();
+  if (!s.ok()) {
+    fprintf(stderr, "%s\n", s.ToString().c_str());
+    return 1;
+  }
+  bool ok = true;
+  for (const auto& name : rocksdb::StringSplit(FLAGS_benchmarks, ',')) {
+    ok = bench.Run(name) && ok;
+  }
+  return ok ? 0 : 1;
+}
+
+#endif  // GFLAGS
@@ -2,9 +2,12 @@
 
 #include "encryption/encryption.h"
 
+#include "encryption/in_memory_key_manager.h"
 #include "port/stack_trace.h"
+#include "rocksdb/encryption.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/file_reader_writer.h"
 
 #ifndef ROCKSDB_LITE
 #ifdef OPENSSL
@@ -146,6 +149,41 @@ TEST_P(EncryptionTest, EncryptionTest) {
   EXPECT_TRUE(TestEncryption(16, 16 * 2, IV_OVERFLOW_FULL));
 }
 
+TEST_P(EncryptionTest, ReuseCipherStream) {
+  // A stream reuses its cipher contexts across calls, each call must still
+  // start from the counter of its own offset.
+  GenerateCiphertext(IV_RANDOM);
+  EncryptionMethod method = std::get<1>(GetParam());
+  std::string key_str(reinterpret_cast<const char*>(KEY), KeySize(method));
+  std::string iv_str(reinterpret_cast<const char*>(IV_RANDOM), 16);
+  std::unique_ptr<AESCTRCipherStream> cipher_stream;
+  ASSERT_OK(NewAESCTRCipherStream(method, key_str, iv_str, &cipher_stream));
+
+  const std::pair<size_t, size_t> ranges[] = {{16 * 5, 16 * 8},
+                                               {0, 16},
+                                               {16 * 5 + 1, 16 * 8 + 15},
+                                               {16 * 2 + 3, 16 * 3}};
+  char data[MAX_SIZE];
+  for (int i = 0; i < 2; i++) {
+    for (const auto& range : ranges) {
+      size_t data_size = range.second - range.first;
+      if (std::get<0>(GetParam())) {
+        memcpy(data, plaintext + range.first, data_size);
+        ASSERT_OK(cipher_stream->Encrypt(range.first, data, data_size));
+        ASSERT_EQ(0, memcmp(ciphertext + range.first, data, data_size));
+        ASSERT_OK(cipher_stream->Decrypt(range.first, data, data_size));
+        ASSERT_EQ(0, memcmp(plaintext + range.first, data, data_size));
+      } else {
+        memcpy(data, ciphertext + range.first, data_size);
+        ASSERT_OK(cipher_stream->Decrypt(range.first, data, data_size));
+        ASSERT_EQ(0, memcmp(plaintext + range.first, data, data_size));
+        ASSERT_OK(cipher_stream->Encrypt(range.first, data, data_size));
+        ASSERT_EQ(0, memcmp(ciphertext + range.first, data, data_size));
+      }
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(
     EncryptionTestInstance, EncryptionTest,
     testing::Combine(testing::Bool(),
@@ -153,6 +191,108 @@ INSTANTIATE_TEST_CASE_P(
                                      EncryptionMethod::kAES192_CTR,
                                      EncryptionMethod::kAES256_CTR)));
 
+// Fails the appends to the files it creates while fail_append is set
+class FailAppendEnv : public EnvWrapper {
+ public:
+  explicit FailAppendEnv(Env* base) : EnvWrapper(base), fail_append(false) {}
+
+  Status NewWritableFile(const std::string& fname,
+                         std::unique_ptr<WritableFile>* result,
+                         const EnvOptions& options) override {
+    class FailAppendFile : public WritableFileWrapper {
+     public:
+      FailAppendFile(std::unique_ptr<WritableFile>&& file,
+                     const std::atomic<bool>* fail_append)
+          : WritableFileWrapper(file.get()),
+            file_(std::move(file)),
+            fail_append_(fail_append) {}
+
+      Status Append(const Slice& data) override {
+        if (*fail_append_) {
+          return Status::IOError("Fake IO error");
+        }
+        return WritableFileWrapper::Append(data);
+      }
+
+     private:
+      std::unique_ptr<WritableFile> file_;
+      const std::atomic<bool>* fail_append_;
+    };
+
+    std::unique_ptr<WritableFile> file;
+    Status s = target()->NewWritableFile(fname, &file, options);
+    if (s.ok()) {
+      result->reset(new FailAppendFile(std::move(file), &fail_append));
+    }
+    return s;
+  }
+
+  std::atomic<bool> fail_append;
+};
+
+// The writer encrypts its own buffer when writing to a key managed
+// encrypted file, the data must still read back as written, including
+// after a failed write is retried.
+TEST(KeyManagedEncryptedEnvTest, WritableFileWriterAppendInPlace) {
+  std::unique_ptr<Env> mem_env(NewMemEnv(Env::Default()));
+  FailAppendEnv base_env(mem_env.get());
+  std::shared_ptr<KeyManager> key_manager(
+      new InMemoryKeyManager(EncryptionMethod::kAES256_CTR));
+  std::unique_ptr<Env> env(NewKeyManagedEncryptedEnv(&base_env, key_manager));
+  const std::string fname = "/encrypted_file";
+  const EnvOptions env_options;
+
+  std::unique_ptr<WritableFile> file;
+  ASSERT_OK(env->NewWritableFile(fname, &file, env_options));
+  ASSERT_TRUE(file->SupportsAppendInPlace());
+  WritableFileWriter writer(std::move(file), fname, env_options);
+
+  Random rnd(301);
+  const int large_size =
+      static_cast<int>(3 * env_options.writable_file_max_buffer_size);
+  std::string expected;
+  for (int i = 0; i < 20; i++) {
+    // small appends, then ones larger than the writer's buffer
+    std::string data =
+        test::RandomHumanReadableString(&rnd, i < 15 ? 10000 : large_size);
+    ASSERT_OK(writer.Append(data));
+    expected.append(data);
+  }
+  std::string data = test::RandomHumanReadableString(&rnd, 10000);
+  ASSERT_OK(writer.Append(data));
+  expected.append(data);
+  base_env.fail_append = true;
+  ASSERT_NOK(writer.Flush());
+  base_env.fail_append = false;
+  data = test::RandomHumanReadableString(&rnd, 10000);
+  ASSERT_OK(writer.Append(data));
+  expected.append(data);
+  ASSERT_OK(writer.Close());
+
+  // the data is encrypted on the base env
+  uint64_t file_size = 0;
+  ASSERT_OK(base_env.GetFileSize(fname, &file_size));
+  ASSERT_EQ(expected.size(), file_size);
+  std::unique_ptr<RandomAccessFile> raw_file;
+  ASSERT_OK(base_env.NewRandomAccessFile(fname, &raw_file, env_options));
+  std::unique_ptr<char[]> scratch(new char[expected.size()]);
+  Slice result;
+  ASSERT_OK(raw_file->Read(0, expected.size(), &result, scratch.get()));
+  ASSERT_EQ(expected.size(), result.size());
+  ASSERT_NE(expected, result.ToString());
+
+  std::unique_ptr<RandomAccessFile> reader;
+  ASSERT_OK(env->NewRandomAccessFile(fname, &reader, env_options));
+  ASSERT_OK(reader->Read(0, expected.size(), &result, scratch.get()));
+  ASSERT_EQ(expected, result.ToString());
+  for (int i = 0; i < 100; i++) {
+    uint64_t offset = rnd.Uniform(static_cast<int>(expected.size()));
+    size_t n = rnd.Uniform(10000) + 1;
+    ASSERT_OK(reader->Read(offset, n, &result, scratch.get()));
+    ASSERT_EQ(expected.substr(offset, n), result.ToString());
+  }
+}
+
 }  // namespace encryption
 }  // namespace rocksdb
 
@@ -263,6 +263,30 @@ class EncryptedWritableFile : public WritableFileWrapper {
     return status;
   }
 
+  // Encrypts in the caller's buffer, saving the copy made by Append().
+  Status AppendInPlace(char* data, size_t size) override {
+    Status status;
+    if (size == 0) {
+      return file_->Append(Slice());
+    }
+    auto offset = file_->GetFileSize(); // size including prefix
+    {
+      PERF_TIMER_GUARD(encrypt_data_nanos);
+      status = stream_->Encrypt(offset, data, size);
+    }
+    if (!status.ok()) {
+      return status;
+    }
+    status = file_->Append(Slice(data, size));
+    if (!status.ok()) {
+      // Give the plain data back, for the caller to retry
+      stream_->Decrypt(offset, data, size);
+    }
+    return status;
+  }
+
+  bool SupportsAppendInPlace() const override { return true; }
+
   // Indicates the upper layers if the current WritableFile implementation
   // uses direct IO.
   bool use_direct_io() const override { return file_->use_direct_io(); }
@@ -56,6 +56,21 @@ enum CompactionPri : char {
   kMinOverlappingRatio = 0x3,
 };
 
+// The filter built for the table files of a level, see filter_kind_per_level.
+// Only block based tables with a filter_policy build filters.
+enum FilterKind : char {
+  // Full (or partitioned) bloom filter
+  kFilterKindBloom = 0x0,
+  // Ot lex pdt trie, which has no false positives on whole keys and can also
+  // serve range and prefix queries, but is usually larger than a bloom filter
+  kFilterKindOtLexPdt = 0x1,
+  // No filter
+  kFilterKindNone = 0x2,
+  // Pick between kFilterKindBloom and kFilterKindOtLexPdt for each file once
+  // all its keys have been seen, see adaptive_filter_max_size_ratio
+  kFilterKindAdaptive = 0x3,
+};
+
 struct CompactionOptionsFIFO {
   // once the total sum of table files reaches this, we will delete the oldest
   // table file
@@ -666,6 +681,72 @@ struct AdvancedColumnFamilyOptions {
   // data is left uncompressed (unless compression is also requested).
   uint64_t sample_for_compression = 0;
 
+  // The filter kind of the table files written to each level, for block
+  // based tables with a filter_policy. filter_kind_per_level[i] applies to
+  // level i, levels past the end use the last entry, and files of an unknown
+  // level (e.g. written by SstFileWriter) use the first one.
+  //
+  // kFilterKindOtLexPdt needs the builtin bloom filter policy; other
+  // policies build their own filter instead. Partitioned filters can't wait
+  // for the whole file to be seen, so kFilterKindAdaptive builds bloom
+  // partitions with partition_filters.
+  //
+  // Default: empty, i.e. bloom filters for L0 and L1 and ot lex pdt filters
+  // from L2 on
+  //
+  // Dynamically changeable through SetOptions() API
+  std::vector<FilterKind> filter_kind_per_level;
+
+  // Bits per key of the bloom filters built for each level, indexed like
+  // filter_kind_per_level. A value <= 0 keeps the bits per key of the
+  // builtin bloom filter policy. Ignored for other policies.
+  //
+  // Default: empty
+  //
+  // Dynamically changeable through SetOptions() API
+  std::vector<int> bloom_bits_per_key_per_level;
+
+  // Fingerprint bits per key of the ot lex pdt filters built for each level,
+  // indexed like filter_kind_per_level. A value > 0 builds an approximate
+  // trie, which only holds the prefix that tells every key apart from its
+  // neighbors plus a hash of that many bits (at most 32) of the whole key:
+  // much smaller for long keys, with a false positive rate of about
+  // 2^-bits. A value <= 0 builds the exact trie. Ignored unless the builtin
+  // bloom filter policy is used.
+  //
+  // Default: empty
+  //
+  // Dynamically changeable through SetOptions() API
+  std::vector<int> pdt_fingerprint_bits_per_level;
+
+  // With kFilterKindAdaptive, a file gets an ot lex pdt filter when the trie
+  // is at most this many times the size of the bloom filter it would get
+  // instead, trading filter memory for no false positives. The trie size is
+  // first projected from the key count and the bytes the keys don't share
+  // with their predecessor, and the trie is only built when the projection
+  // fits. A value <= 0 always picks the bloom filter.
+  //
+  // Default: 2.0
+  //
+  // Dynamically changeable through SetOptions() API
+  double adaptive_filter_max_size_ratio = 2.0;
+
+  // If true, the keys of an ot lex pdt filter are appended to the trie by a
+  // task scheduled on the BOTTOM priority thread pool of the Env, while the
+  // table builder goes on writing data blocks. That pool has no threads by
+  // default, give it some with
+  // Env::SetBackgroundThreads(n, Env::Priority::BOTTOM); note that the
+  // compactions to the last level then run there too. The table builder
+  // only waits for the task when the filter block is written, and appends
+  // whatever it has not picked up yet itself, so a busy pool or one without
+  // threads degrades to building the trie inline. Ignored unless the builtin
+  // bloom filter policy is used.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool pdt_background_build = false;
+
   // Create ColumnFamilyOptions with default values for all fields
   AdvancedColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
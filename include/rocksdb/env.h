@@ -744,6 +744,17 @@ class WritableFile {
     return Status::NotSupported();
   }
 
+  // Same as Append(), except that the caller gives up the content of
+  // data[0, size): the file may overwrite it, e.g. to encrypt the data in
+  // place instead of in a copy. On failure, the content is left unchanged.
+  virtual Status AppendInPlace(char* data, size_t size) {
+    return Append(Slice(data, size));
+  }
+
+  // true if AppendInPlace() saves a copy of the data over Append(). The
+  // writers then append their own buffers with it.
+  virtual bool SupportsAppendInPlace() const { return false; }
+
   // Truncate is necessary to trim the file to the correct size
   // before closing. It is not always possible to keep track of the file
   // size due to whole pages writes. The behavior is undefined if called
@@ -1428,6 +1439,12 @@ class WritableFileWrapper : public WritableFile {
   Status PositionedAppend(const Slice& data, uint64_t offset) override {
     return target_->PositionedAppend(data, offset);
   }
+  Status AppendInPlace(char* data, size_t size) override {
+    return target_->AppendInPlace(data, size);
+  }
+  bool SupportsAppendInPlace() const override {
+    return target_->SupportsAppendInPlace();
+  }
   Status Truncate(uint64_t size) override { return target_->Truncate(size); }
   Status Close() override { return target_->Close(); }
   Status Flush() override { return target_->Flush(); }
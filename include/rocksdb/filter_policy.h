@@ -77,6 +77,10 @@ class FilterBitsReader {
       may_match[i] = MayMatch(*keys[i]);
     }
   }
+
+  // Memory held by the reader on top of the filter contents it was built
+  // from, e.g. decoded structures. Used to charge the block cache.
+  virtual size_t ApproximateMemoryUsage() const { return 0; }
 };
 
 // We add a new format of filter block called full filter block
@@ -76,6 +76,12 @@ struct PerfContext {
                                                // dictionary block reads
   uint64_t block_checksum_time;    // total nanos spent on block checksum
   uint64_t block_decompress_time;  // total nanos spent on block decompression
+  uint64_t persistent_cache_hit_count;   // total number of persistent cache
+                                         // hits
+  uint64_t persistent_cache_miss_count;  // total number of persistent cache
+                                         // misses
+  uint64_t persistent_cache_read_time;   // total nanos spent on persistent
+                                         // cache lookups
 
   uint64_t get_read_bytes;       // bytes for vals returned by Get
   uint64_t multiget_read_bytes;  // bytes for vals returned by MultiGet
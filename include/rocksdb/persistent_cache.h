@@ -18,6 +18,8 @@
 
 namespace rocksdb {
 
+class EventListener;
+
 // PersistentCache
 //
 // Persistent cache interface for caching IO pages on a persistent medium. The
@@ -49,6 +51,15 @@ class PersistentCache {
   // True if the cache is configured to store uncompressed data else false
   virtual bool IsCompressed() = 0;
 
+  // Erase all the pages of the table file fname, the file name given to
+  // Insert(), once the file is deleted
+  //
+  // Returns NotSupported if the cache does not keep track of the files of
+  // its pages
+  virtual Status EraseFile(const std::string& /*fname*/) {
+    return Status::NotSupported();
+  }
+
   // Return stats as map of {string, double} per-tier
   //
   // Persistent cache can be initialized as a tier of caches. The stats are per
@@ -71,4 +82,13 @@ Status NewPersistentmyCache(Env* const env, const std::string& path,
                           const bool optimized_for_nvm,
                           std::shared_ptr<PersistentCache>* cache);
 
+#ifndef ROCKSDB_LITE
+// Returns a listener which erases the pages of the table files deleted by
+// the DB from cache, to be added to DBOptions::listeners of the DB using
+// cache. The pages of dead files would otherwise keep their space until
+// they are evicted.
+std::shared_ptr<EventListener> NewPersistentCacheFileEraser(
+    const std::shared_ptr<PersistentCache>& cache);
+#endif  // ROCKSDB_LITE
+
 }  // namespace rocksdb
@@ -338,6 +338,25 @@ enum Tickers : uint32_t {
   BLOCK_CACHE_COMPRESSION_DICT_ADD,
   BLOCK_CACHE_COMPRESSION_DICT_BYTES_INSERT,
   BLOCK_CACHE_COMPRESSION_DICT_BYTES_EVICT,
+
+  // Tickers of the persistent cache tiers that are given a Statistics
+  // (PersistentCacheConfig::statistics).
+  // # of blocks written to the persistent cache.
+  PERSISTENT_CACHE_ADD,
+  // # of blocks dropped because the writes of the tier are backlogged.
+  PERSISTENT_CACHE_ADD_DROPPED,
+  // # of blocks not admitted by the admission policy of the tier.
+  PERSISTENT_CACHE_ADD_REJECTED,
+  // # of blocks evicted to make room for new ones.
+  PERSISTENT_CACHE_EVICT,
+  // # of bytes read from and written to the persistent cache.
+  PERSISTENT_CACHE_BYTES_READ,
+  PERSISTENT_CACHE_BYTES_WRITE,
+  // number of times a range filter was checked before seeking into a file
+  // with iterate_upper_bound set, and the number of times it found no key in
+  // [seek key, upper bound), so the file was skipped.
+  BLOOM_FILTER_RANGE_CHECKED,
+  BLOOM_FILTER_RANGE_USEFUL,
   TICKER_ENUM_MAX
 };
 
@@ -428,6 +447,11 @@ enum Histograms : uint32_t {
   FLUSH_TIME,
   SST_BATCH_SIZE,
   DB_WRITE_WAL_TIME,
+  // Persistent cache lookup latency, hits and misses.
+  PERSISTENT_CACHE_READ_MICROS,
+  // Persistent cache write latency, of a batch of blocks when the writes
+  // are pipelined.
+  PERSISTENT_CACHE_WRITE_MICROS,
 
   HISTOGRAM_ENUM_MAX,
 };
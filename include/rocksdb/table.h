@@ -119,6 +119,12 @@ struct BlockBasedTableOptions {
     // slice, and you need to call Valid()/status() afterwards.
     // TODO(kolmike): Fix it.
     kBinarySearchWithFirstKey = 0x03,
+
+    // The separator keys are stored in a compacted trie, with the block
+    // handles in a separate succinct array, instead of in a binary-search
+    // index block. Keys with long shared prefixes make for a much smaller
+    // index. Only works with the bytewise comparator.
+    kTrieSearch = 0x04,
   };
 
   IndexType index_type = kBinarySearch;
@@ -157,6 +163,14 @@ struct BlockBasedTableOptions {
   // IF NULL, no page cache is used
   std::shared_ptr<PersistentCache> persistent_cache = nullptr;
 
+  // If true, the data blocks go to persistent_cache when they are evicted
+  // from block_cache instead of when they are read from the file, so that
+  // the persistent cache holds the blocks that were worth caching in RAM
+  // and does not take a write for every block read. Blocks found in
+  // persistent_cache are promoted back to block_cache. Requires
+  // block_cache, and persistent_cache storing uncompressed pages.
+  bool persistent_cache_demote_on_evict = false;
+
   // If non-NULL use the specified cache for compressed blocks.
   // If NULL, rocksdb will not use a compressed block cache.
   // Note: though it looks similar to `block_cache`, RocksDB doesn't put the
@@ -203,6 +217,16 @@ struct BlockBasedTableOptions {
   // incompatible with block-based filters.
   bool partition_filters = false;
 
+  // If true, the block handles of each index partition are stored as an
+  // Elias-Fano sequence after the partition's restart array instead of in
+  // the values of its entries. The partitions get smaller and the handle of
+  // any entry is decoded in constant time, without going through the delta
+  // encoded handles of its restart interval. Ignored unless index_type is
+  // kTwoLevelIndexSearch.
+  //
+  // Default: false
+  bool elias_fano_partition_handles = false;
+
   // Use delta encoding to compress keys in blocks.
   // ReadOptions::pin_data requires this option to be disabled.
   //
@@ -226,6 +250,15 @@ struct BlockBasedTableOptions {
   //bool use_pdt = false;
   //bool use_pdt = true;
 
+  // If true, ot lex pdt filter blocks also map the rank of every key in the
+  // trie to the data block holding it, and point lookups that hit the trie
+  // go straight to that data block instead of searching the index block.
+  // Ignored unless the table uses an ot lex pdt filter, keys are ordered by
+  // BytewiseComparator() and block_align is false.
+  //
+  // Default: false
+  bool pdt_data_block_index = false;
+
   // If used, For every data block we load into memory, we will create a bitmap
   // of size ((block_size / `read_amp_bytes_per_bit`) / 8) bytes. This bitmap
   // will be used to figure out the percentage we actually read of the blocks.
@@ -410,6 +443,17 @@ struct PlainTableOptions {
   //                       file building and store it in file. When reading
   //                       file, index will be mmaped instead of recomputation.
   bool store_index_in_file = false;
+
+  // @prefix_trie_index: with a prefix extractor, index the distinct key
+  //                     prefixes in a trie instead of a hash table when the
+  //                     index is computed on open. Lookups of prefixes not in
+  //                     the file are answered without a bloom filter, so
+  //                     bloom_bits_per_key is not used, and iterators also
+  //                     support total_order_seek. The prefix extractor has
+  //                     to keep the order of the keys under the bytewise
+  //                     comparator. Ignored for files with the index stored
+  //                     in them.
+  bool prefix_trie_index = false;
 };
 
 // -- Plain Table with prefix-only seek
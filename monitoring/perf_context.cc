@@ -51,6 +51,9 @@ PerfContext::PerfContext(const PerfContext& other) {
   compression_dict_block_read_count = other.compression_dict_block_read_count;
   block_checksum_time = other.block_checksum_time;
   block_decompress_time = other.block_decompress_time;
+  persistent_cache_hit_count = other.persistent_cache_hit_count;
+  persistent_cache_miss_count = other.persistent_cache_miss_count;
+  persistent_cache_read_time = other.persistent_cache_read_time;
   get_read_bytes = other.get_read_bytes;
   multiget_read_bytes = other.multiget_read_bytes;
   iter_read_bytes = other.iter_read_bytes;
@@ -146,6 +149,9 @@ PerfContext::PerfContext(PerfContext&& other) noexcept {
   compression_dict_block_read_count = other.compression_dict_block_read_count;
   block_checksum_time = other.block_checksum_time;
   block_decompress_time = other.block_decompress_time;
+  persistent_cache_hit_count = other.persistent_cache_hit_count;
+  persistent_cache_miss_count = other.persistent_cache_miss_count;
+  persistent_cache_read_time = other.persistent_cache_read_time;
   get_read_bytes = other.get_read_bytes;
   multiget_read_bytes = other.multiget_read_bytes;
   iter_read_bytes = other.iter_read_bytes;
@@ -243,6 +249,9 @@ PerfContext& PerfContext::operator=(const PerfContext& other) {
   compression_dict_block_read_count = other.compression_dict_block_read_count;
   block_checksum_time = other.block_checksum_time;
   block_decompress_time = other.block_decompress_time;
+  persistent_cache_hit_count = other.persistent_cache_hit_count;
+  persistent_cache_miss_count = other.persistent_cache_miss_count;
+  persistent_cache_read_time = other.persistent_cache_read_time;
   get_read_bytes = other.get_read_bytes;
   multiget_read_bytes = other.multiget_read_bytes;
   iter_read_bytes = other.iter_read_bytes;
@@ -339,6 +348,9 @@ void PerfContext::Reset() {
   compression_dict_block_read_count = 0;
   block_checksum_time = 0;
   block_decompress_time = 0;
+  persistent_cache_hit_count = 0;
+  persistent_cache_miss_count = 0;
+  persistent_cache_read_time = 0;
   get_read_bytes = 0;
   multiget_read_bytes = 0;
   iter_read_bytes = 0;
@@ -458,6 +470,9 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(compression_dict_block_read_count);
   PERF_CONTEXT_OUTPUT(block_checksum_time);
   PERF_CONTEXT_OUTPUT(block_decompress_time);
+  PERF_CONTEXT_OUTPUT(persistent_cache_hit_count);
+  PERF_CONTEXT_OUTPUT(persistent_cache_miss_count);
+  PERF_CONTEXT_OUTPUT(persistent_cache_read_time);
   PERF_CONTEXT_OUTPUT(get_read_bytes);
   PERF_CONTEXT_OUTPUT(multiget_read_bytes);
   PERF_CONTEXT_OUTPUT(iter_read_bytes);
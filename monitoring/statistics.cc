@@ -174,6 +174,14 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
      "rocksdb.block.cache.compression.dict.bytes.insert"},
     {BLOCK_CACHE_COMPRESSION_DICT_BYTES_EVICT,
      "rocksdb.block.cache.compression.dict.bytes.evict"},
+    {PERSISTENT_CACHE_ADD, "rocksdb.persistent.cache.add"},
+    {PERSISTENT_CACHE_ADD_DROPPED, "rocksdb.persistent.cache.add.dropped"},
+    {PERSISTENT_CACHE_ADD_REJECTED, "rocksdb.persistent.cache.add.rejected"},
+    {PERSISTENT_CACHE_EVICT, "rocksdb.persistent.cache.evict"},
+    {PERSISTENT_CACHE_BYTES_READ, "rocksdb.persistent.cache.bytes.read"},
+    {PERSISTENT_CACHE_BYTES_WRITE, "rocksdb.persistent.cache.bytes.write"},
+    {BLOOM_FILTER_RANGE_CHECKED, "rocksdb.bloom.filter.range.checked"},
+    {BLOOM_FILTER_RANGE_USEFUL, "rocksdb.bloom.filter.range.useful"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -226,6 +234,8 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {FLUSH_TIME, "rocksdb.db.flush.micros"},
     {SST_BATCH_SIZE, "rocksdb.sst.batch.size"},
     {DB_WRITE_WAL_TIME, "rocksdb.db.write.wal.time"},
+    {PERSISTENT_CACHE_READ_MICROS, "rocksdb.persistent.cache.read.micros"},
+    {PERSISTENT_CACHE_WRITE_MICROS, "rocksdb.persistent.cache.write.micros"},
 };
 
 } // namespace rocksdb
@@ -195,6 +195,40 @@ void MutableCFOptions::Dump(Logger* log) const {
                  report_bg_io_stats);
   ROCKS_LOG_INFO(log, "                              compression: %d",
                  static_cast<int>(compression));
+  result.clear();
+  for (const auto k : filter_kind_per_level) {
+    snprintf(buf, sizeof(buf), "%d, ", static_cast<int>(k));
+    result += buf;
+  }
+  if (result.size() >= 2) {
+    result.resize(result.size() - 2);
+  }
+  ROCKS_LOG_INFO(log, "                    filter_kind_per_level: %s",
+                 result.c_str());
+  result.clear();
+  for (const auto b : bloom_bits_per_key_per_level) {
+    snprintf(buf, sizeof(buf), "%d, ", b);
+    result += buf;
+  }
+  if (result.size() >= 2) {
+    result.resize(result.size() - 2);
+  }
+  ROCKS_LOG_INFO(log, "             bloom_bits_per_key_per_level: %s",
+                 result.c_str());
+  result.clear();
+  for (const auto b : pdt_fingerprint_bits_per_level) {
+    snprintf(buf, sizeof(buf), "%d, ", b);
+    result += buf;
+  }
+  if (result.size() >= 2) {
+    result.resize(result.size() - 2);
+  }
+  ROCKS_LOG_INFO(log, "           pdt_fingerprint_bits_per_level: %s",
+                 result.c_str());
+  ROCKS_LOG_INFO(log, "           adaptive_filter_max_size_ratio: %f",
+                 adaptive_filter_max_size_ratio);
+  ROCKS_LOG_INFO(log, "                     pdt_background_build: %d",
+                 pdt_background_build);
 
   // Universal Compaction Options
   ROCKS_LOG_INFO(log, "compaction_options_universal.size_ratio : %d",
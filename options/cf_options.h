@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -162,7 +163,12 @@ struct MutableCFOptions {
         paranoid_file_checks(options.paranoid_file_checks),
         report_bg_io_stats(options.report_bg_io_stats),
         compression(options.compression),
-        sample_for_compression(options.sample_for_compression) {
+        sample_for_compression(options.sample_for_compression),
+        filter_kind_per_level(options.filter_kind_per_level),
+        bloom_bits_per_key_per_level(options.bloom_bits_per_key_per_level),
+        pdt_fingerprint_bits_per_level(options.pdt_fingerprint_bits_per_level),
+        adaptive_filter_max_size_ratio(options.adaptive_filter_max_size_ratio),
+        pdt_background_build(options.pdt_background_build) {
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
   }
 
@@ -195,7 +201,9 @@ struct MutableCFOptions {
         paranoid_file_checks(false),
         report_bg_io_stats(false),
         compression(Snappy_Supported() ? kSnappyCompression : kNoCompression),
-        sample_for_compression(0) {}
+        sample_for_compression(0),
+        adaptive_filter_max_size_ratio(2.0),
+        pdt_background_build(false) {}
 
   explicit MutableCFOptions(const Options& options);
 
@@ -214,6 +222,34 @@ struct MutableCFOptions {
     return max_bytes_for_level_multiplier_additional[level];
   }
 
+  // The filter kind of the files written to `level`, -1 if unknown
+  FilterKind FilterKindForLevel(int level) const {
+    if (filter_kind_per_level.empty()) {
+      return level > 1 ? kFilterKindOtLexPdt : kFilterKindBloom;
+    }
+    return filter_kind_per_level[PerLevelIndex(filter_kind_per_level, level)];
+  }
+
+  // The bloom bits per key of the files written to `level`, <= 0 to use the
+  // filter policy's
+  int BloomBitsPerKeyForLevel(int level) const {
+    if (bloom_bits_per_key_per_level.empty()) {
+      return 0;
+    }
+    return bloom_bits_per_key_per_level[PerLevelIndex(
+        bloom_bits_per_key_per_level, level)];
+  }
+
+  // The fingerprint bits per key of the ot lex pdt filters of the files
+  // written to `level`, <= 0 for exact tries
+  int PdtFingerprintBitsForLevel(int level) const {
+    if (pdt_fingerprint_bits_per_level.empty()) {
+      return 0;
+    }
+    return pdt_fingerprint_bits_per_level[PerLevelIndex(
+        pdt_fingerprint_bits_per_level, level)];
+  }
+
   void Dump(Logger* log) const;
 
   // Memtable related options
@@ -253,9 +289,26 @@ struct MutableCFOptions {
   CompressionType compression;
   uint64_t sample_for_compression;
 
+  // Filter related options
+  std::vector<FilterKind> filter_kind_per_level;
+  std::vector<int> bloom_bits_per_key_per_level;
+  std::vector<int> pdt_fingerprint_bits_per_level;
+  double adaptive_filter_max_size_ratio;
+  bool pdt_background_build;
+
   // Derived options
   // Per-level target file size.
   std::vector<uint64_t> max_file_size;
+
+ private:
+  template <typename T>
+  static size_t PerLevelIndex(const std::vector<T>& per_level, int level) {
+    assert(!per_level.empty());
+    if (level < 0) {
+      return 0;
+    }
+    return std::min(static_cast<size_t>(level), per_level.size() - 1);
+  }
 };
 
 uint64_t MultiplyCheckOverflow(uint64_t op1, double op2);
@@ -85,7 +85,12 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       report_bg_io_stats(options.report_bg_io_stats),
       ttl(options.ttl),
       periodic_compaction_seconds(options.periodic_compaction_seconds),
-      sample_for_compression(options.sample_for_compression) {
+      sample_for_compression(options.sample_for_compression),
+      filter_kind_per_level(options.filter_kind_per_level),
+      bloom_bits_per_key_per_level(options.bloom_bits_per_key_per_level),
+      pdt_fingerprint_bits_per_level(options.pdt_fingerprint_bits_per_level),
+      adaptive_filter_max_size_ratio(options.adaptive_filter_max_size_ratio),
+      pdt_background_build(options.pdt_background_build) {
   assert(memtable_factory.get() != nullptr);
   if (max_bytes_for_level_multiplier_additional.size() <
       static_cast<unsigned int>(num_levels)) {
@@ -355,6 +360,28 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "         Options.periodic_compaction_seconds: %" PRIu64,
                      periodic_compaction_seconds);
+    if (!filter_kind_per_level.empty()) {
+      for (unsigned int i = 0; i < filter_kind_per_level.size(); i++) {
+        ROCKS_LOG_HEADER(log, "         Options.filter_kind_per_level[%d]: %d",
+                         i, static_cast<int>(filter_kind_per_level[i]));
+      }
+    } else {
+      ROCKS_LOG_HEADER(log, "         Options.filter_kind_per_level: default");
+    }
+    for (unsigned int i = 0; i < bloom_bits_per_key_per_level.size(); i++) {
+      ROCKS_LOG_HEADER(log,
+                       "  Options.bloom_bits_per_key_per_level[%d]: %d", i,
+                       bloom_bits_per_key_per_level[i]);
+    }
+    for (unsigned int i = 0; i < pdt_fingerprint_bits_per_level.size(); i++) {
+      ROCKS_LOG_HEADER(log,
+                       "Options.pdt_fingerprint_bits_per_level[%d]: %d", i,
+                       pdt_fingerprint_bits_per_level[i]);
+    }
+    ROCKS_LOG_HEADER(log, "      Options.adaptive_filter_max_size_ratio: %f",
+                     adaptive_filter_max_size_ratio);
+    ROCKS_LOG_HEADER(log, "                Options.pdt_background_build: %d",
+                     pdt_background_build);
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
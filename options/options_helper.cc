@@ -204,6 +204,14 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.report_bg_io_stats = mutable_cf_options.report_bg_io_stats;
   cf_opts.compression = mutable_cf_options.compression;
   cf_opts.sample_for_compression = mutable_cf_options.sample_for_compression;
+  cf_opts.filter_kind_per_level = mutable_cf_options.filter_kind_per_level;
+  cf_opts.bloom_bits_per_key_per_level =
+      mutable_cf_options.bloom_bits_per_key_per_level;
+  cf_opts.pdt_fingerprint_bits_per_level =
+      mutable_cf_options.pdt_fingerprint_bits_per_level;
+  cf_opts.adaptive_filter_max_size_ratio =
+      mutable_cf_options.adaptive_filter_max_size_ratio;
+  cf_opts.pdt_background_build = mutable_cf_options.pdt_background_build;
 
   cf_opts.table_factory = options.table_factory;
   // TODO(yhchiang): find some way to handle the following derived options
@@ -248,6 +256,13 @@ std::unordered_map<std::string, CompressionType>
         {"kZSTD", kZSTD},
         {"kZSTDNotFinalCompression", kZSTDNotFinalCompression},
         {"kDisableCompressionOption", kDisableCompressionOption}};
+
+std::unordered_map<std::string, FilterKind>
+    OptionsHelper::filter_kind_string_map = {
+        {"kFilterKindBloom", kFilterKindBloom},
+        {"kFilterKindOtLexPdt", kFilterKindOtLexPdt},
+        {"kFilterKindNone", kFilterKindNone},
+        {"kFilterKindAdaptive", kFilterKindAdaptive}};
 #ifndef ROCKSDB_LITE
 
 const std::string kNameComparator = "comparator";
@@ -284,8 +299,9 @@ bool SerializeEnum(const std::unordered_map<std::string, T>& type_map,
   return false;
 }
 
-bool SerializeVectorCompressionType(const std::vector<CompressionType>& types,
-                                    std::string* value) {
+template <typename T>
+bool SerializeVectorEnum(const std::unordered_map<std::string, T>& type_map,
+                         const std::vector<T>& types, std::string* value) {
   std::stringstream ss;
   bool result;
   for (size_t i = 0; i < types.size(); ++i) {
@@ -293,8 +309,7 @@ bool SerializeVectorCompressionType(const std::vector<CompressionType>& types,
       ss << ':';
     }
     std::string string_type;
-    result = SerializeEnum<CompressionType>(compression_type_string_map,
-                                            types[i], &string_type);
+    result = SerializeEnum<T>(type_map, types[i], &string_type);
     if (result == false) {
       return result;
     }
@@ -304,30 +319,28 @@ bool SerializeVectorCompressionType(const std::vector<CompressionType>& types,
   return true;
 }
 
-bool ParseVectorCompressionType(
-    const std::string& value,
-    std::vector<CompressionType>* compression_per_level) {
-  compression_per_level->clear();
+template <typename T>
+bool ParseVectorEnum(const std::unordered_map<std::string, T>& type_map,
+                     const std::string& value, std::vector<T>* types) {
+  types->clear();
   size_t start = 0;
   while (start < value.size()) {
     size_t end = value.find(':', start);
     bool is_ok;
-    CompressionType type;
+    T type;
     if (end == std::string::npos) {
-      is_ok = ParseEnum<CompressionType>(compression_type_string_map,
-                                         value.substr(start), &type);
+      is_ok = ParseEnum<T>(type_map, value.substr(start), &type);
       if (!is_ok) {
         return false;
       }
-      compression_per_level->emplace_back(type);
+      types->emplace_back(type);
       break;
     } else {
-      is_ok = ParseEnum<CompressionType>(
-          compression_type_string_map, value.substr(start, end - start), &type);
+      is_ok = ParseEnum<T>(type_map, value.substr(start, end - start), &type);
       if (!is_ok) {
         return false;
       }
-      compression_per_level->emplace_back(type);
+      types->emplace_back(type);
       start = end + 1;
     }
   }
@@ -514,8 +527,13 @@ bool ParseOptionHelper(char* opt_address, const OptionType& opt_type,
           compression_type_string_map, value,
           reinterpret_cast<CompressionType*>(opt_address));
     case OptionType::kVectorCompressionType:
-      return ParseVectorCompressionType(
-          value, reinterpret_cast<std::vector<CompressionType>*>(opt_address));
+      return ParseVectorEnum<CompressionType>(
+          compression_type_string_map, value,
+          reinterpret_cast<std::vector<CompressionType>*>(opt_address));
+    case OptionType::kVectorFilterKind:
+      return ParseVectorEnum<FilterKind>(
+          filter_kind_string_map, value,
+          reinterpret_cast<std::vector<FilterKind>*>(opt_address));
     case OptionType::kSliceTransform:
       return ParseSliceTransform(
           value, reinterpret_cast<std::shared_ptr<const SliceTransform>*>(
@@ -647,10 +665,15 @@ bool SerializeSingleOptionHelper(const char* opt_address,
           compression_type_string_map,
           *(reinterpret_cast<const CompressionType*>(opt_address)), value);
     case OptionType::kVectorCompressionType:
-      return SerializeVectorCompressionType(
+      return SerializeVectorEnum<CompressionType>(
+          compression_type_string_map,
           *(reinterpret_cast<const std::vector<CompressionType>*>(opt_address)),
           value);
-      break;
+    case OptionType::kVectorFilterKind:
+      return SerializeVectorEnum<FilterKind>(
+          filter_kind_string_map,
+          *(reinterpret_cast<const std::vector<FilterKind>*>(opt_address)),
+          value);
     case OptionType::kSliceTransform: {
       const auto* slice_transform_ptr =
           reinterpret_cast<const std::shared_ptr<const SliceTransform>*>(
@@ -1679,7 +1702,8 @@ std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kTwoLevelIndexSearch",
          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
         {"kBinarySearchWithFirstKey",
-         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey}};
+         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey},
+        {"kTrieSearch", BlockBasedTableOptions::IndexType::kTrieSearch}};
 
 std::unordered_map<std::string, BlockBasedTableOptions::DataBlockIndexType>
     OptionsHelper::block_base_table_data_block_index_type_string_map = {
@@ -2031,7 +2055,27 @@ std::unordered_map<std::string, OptionTypeInfo>
         {"sample_for_compression",
          {offset_of(&ColumnFamilyOptions::sample_for_compression),
           OptionType::kUInt64T, OptionVerificationType::kNormal, true,
-          offsetof(struct MutableCFOptions, sample_for_compression)}}};
+          offsetof(struct MutableCFOptions, sample_for_compression)}},
+        {"filter_kind_per_level",
+         {offset_of(&ColumnFamilyOptions::filter_kind_per_level),
+          OptionType::kVectorFilterKind, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, filter_kind_per_level)}},
+        {"bloom_bits_per_key_per_level",
+         {offset_of(&ColumnFamilyOptions::bloom_bits_per_key_per_level),
+          OptionType::kVectorInt, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, bloom_bits_per_key_per_level)}},
+        {"pdt_fingerprint_bits_per_level",
+         {offset_of(&ColumnFamilyOptions::pdt_fingerprint_bits_per_level),
+          OptionType::kVectorInt, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, pdt_fingerprint_bits_per_level)}},
+        {"adaptive_filter_max_size_ratio",
+         {offset_of(&ColumnFamilyOptions::adaptive_filter_max_size_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, adaptive_filter_max_size_ratio)}},
+        {"pdt_background_build",
+         {offset_of(&ColumnFamilyOptions::pdt_background_build),
+          OptionType::kBoolean, OptionVerificationType::kNormal, true,
+          offsetof(struct MutableCFOptions, pdt_background_build)}}};
 
 std::unordered_map<std::string, OptionTypeInfo>
     OptionsHelper::fifo_compaction_options_type_info = {
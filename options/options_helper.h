@@ -61,6 +61,7 @@ enum class OptionType {
   kSliceTransform,
   kCompressionType,
   kVectorCompressionType,
+  kVectorFilterKind,
   kTableFactory,
   kComparator,
   kCompactionFilter,
@@ -155,6 +156,7 @@ struct OptionsHelper {
   static std::unordered_map<std::string, ChecksumType> checksum_type_string_map;
   static std::unordered_map<std::string, CompressionType>
       compression_type_string_map;
+  static std::unordered_map<std::string, FilterKind> filter_kind_string_map;
 #ifndef ROCKSDB_LITE
   static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info;
   static std::unordered_map<std::string, OptionTypeInfo>
@@ -212,6 +214,7 @@ static auto& lru_cache_options_type_info =
     OptionsHelper::lru_cache_options_type_info;
 static auto& compression_type_string_map =
     OptionsHelper::compression_type_string_map;
+static auto& filter_kind_string_map = OptionsHelper::filter_kind_string_map;
 static auto& block_base_table_index_type_string_map =
     OptionsHelper::block_base_table_index_type_string_map;
 static auto& block_base_table_data_block_index_type_string_map =
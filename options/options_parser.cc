@@ -555,6 +555,13 @@ bool AreEqualOptions(
           reinterpret_cast<const std::vector<CompressionType>*>(offset2);
       return (*vec1 == *vec2);
     }
+    case OptionType::kVectorFilterKind: {
+      const auto* vec1 =
+          reinterpret_cast<const std::vector<FilterKind>*>(offset1);
+      const auto* vec2 =
+          reinterpret_cast<const std::vector<FilterKind>*>(offset2);
+      return (*vec1 == *vec2);
+    }
     case OptionType::kChecksumType:
       return (*reinterpret_cast<const ChecksumType*>(offset1) ==
               *reinterpret_cast<const ChecksumType*>(offset2));
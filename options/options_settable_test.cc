@@ -137,6 +137,7 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "cache_index_and_filter_blocks_with_high_priority=true;"
       "pin_l0_filter_and_index_blocks_in_cache=1;"
       "pin_top_level_index_and_filter=1;"
+      "persistent_cache_demote_on_evict=1;"
       "index_type=kHashSearch;"
       "data_block_index_type=kDataBlockBinaryAndHash;"
       "index_shortening=kNoShortening;"
@@ -146,11 +147,13 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "block_size_deviation=8;block_restart_interval=4; "
       "metadata_block_size=1024;"
       "partition_filters=false;"
+      "elias_fano_partition_handles=true;"
       "index_block_restart_interval=4;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;"
       "format_version=1;"
       "hash_index_allow_collision=false;"
-      "verify_compression=true;read_amp_bytes_per_bit=0;"
+      "verify_compression=true;pdt_data_block_index=true;"
+      "read_amp_bytes_per_bit=0;"
       "enable_index_compression=false;"
       "block_align=true",
       new_bbto));
@@ -343,6 +346,12 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<MemTableRepFactory>)},
       {offset_of(&ColumnFamilyOptions::table_properties_collector_factories),
        sizeof(ColumnFamilyOptions::TablePropertiesCollectorFactories)},
+      {offset_of(&ColumnFamilyOptions::filter_kind_per_level),
+       sizeof(std::vector<FilterKind>)},
+      {offset_of(&ColumnFamilyOptions::bloom_bits_per_key_per_level),
+       sizeof(std::vector<int>)},
+      {offset_of(&ColumnFamilyOptions::pdt_fingerprint_bits_per_level),
+       sizeof(std::vector<int>)},
       {offset_of(&ColumnFamilyOptions::comparator), sizeof(Comparator*)},
       {offset_of(&ColumnFamilyOptions::merge_operator),
        sizeof(std::shared_ptr<MergeOperator>)},
@@ -457,6 +466,11 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "ttl=60;"
       "periodic_compaction_seconds=3600;"
       "sample_for_compression=0;"
+      "filter_kind_per_level=kFilterKindBloom:kFilterKindAdaptive;"
+      "bloom_bits_per_key_per_level=8:12;"
+      "pdt_fingerprint_bits_per_level=0:16;"
+      "adaptive_filter_max_size_ratio=3.5;"
+      "pdt_background_build=true;"
       "compaction_options_fifo={max_table_files_size=3;allow_"
       "compaction=false;};",
       new_options));
@@ -74,6 +74,13 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"level_compaction_dynamic_level_bytes", "true"},
       {"max_bytes_for_level_multiplier", "15.0"},
       {"max_bytes_for_level_multiplier_additional", "16:17:18"},
+      {"filter_kind_per_level",
+       "kFilterKindBloom:kFilterKindOtLexPdt:kFilterKindNone:"
+       "kFilterKindAdaptive"},
+      {"bloom_bits_per_key_per_level", "6:10"},
+      {"pdt_fingerprint_bits_per_level", "0:12:20"},
+      {"adaptive_filter_max_size_ratio", "1.5"},
+      {"pdt_background_build", "true"},
       {"max_compaction_bytes", "21"},
       {"soft_rate_limit", "1.1"},
       {"hard_rate_limit", "2.1"},
@@ -188,6 +195,20 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.max_bytes_for_level_multiplier_additional[0], 16);
   ASSERT_EQ(new_cf_opt.max_bytes_for_level_multiplier_additional[1], 17);
   ASSERT_EQ(new_cf_opt.max_bytes_for_level_multiplier_additional[2], 18);
+  ASSERT_EQ(new_cf_opt.filter_kind_per_level.size(), 4U);
+  ASSERT_EQ(new_cf_opt.filter_kind_per_level[0], kFilterKindBloom);
+  ASSERT_EQ(new_cf_opt.filter_kind_per_level[1], kFilterKindOtLexPdt);
+  ASSERT_EQ(new_cf_opt.filter_kind_per_level[2], kFilterKindNone);
+  ASSERT_EQ(new_cf_opt.filter_kind_per_level[3], kFilterKindAdaptive);
+  ASSERT_EQ(new_cf_opt.bloom_bits_per_key_per_level.size(), 2U);
+  ASSERT_EQ(new_cf_opt.bloom_bits_per_key_per_level[0], 6);
+  ASSERT_EQ(new_cf_opt.bloom_bits_per_key_per_level[1], 10);
+  ASSERT_EQ(new_cf_opt.pdt_fingerprint_bits_per_level.size(), 3U);
+  ASSERT_EQ(new_cf_opt.pdt_fingerprint_bits_per_level[0], 0);
+  ASSERT_EQ(new_cf_opt.pdt_fingerprint_bits_per_level[1], 12);
+  ASSERT_EQ(new_cf_opt.pdt_fingerprint_bits_per_level[2], 20);
+  ASSERT_EQ(new_cf_opt.adaptive_filter_max_size_ratio, 1.5);
+  ASSERT_EQ(new_cf_opt.pdt_background_build, true);
   ASSERT_EQ(new_cf_opt.max_compaction_bytes, 21);
   ASSERT_EQ(new_cf_opt.hard_pending_compaction_bytes_limit, 211);
   ASSERT_EQ(new_cf_opt.arena_block_size, 22U);
@@ -688,7 +709,8 @@ TEST_F(OptionsTest, GetPlainTableOptionsFromString) {
   ASSERT_OK(GetPlainTableOptionsFromString(table_opt,
             "user_key_len=66;bloom_bits_per_key=20;hash_table_ratio=0.5;"
             "index_sparseness=8;huge_page_tlb_size=4;encoding_type=kPrefix;"
-            "full_scan_mode=true;store_index_in_file=true",
+            "full_scan_mode=true;store_index_in_file=true;"
+            "prefix_trie_index=true",
             &new_opt));
   ASSERT_EQ(new_opt.user_key_len, 66);
   ASSERT_EQ(new_opt.bloom_bits_per_key, 20);
@@ -698,6 +720,7 @@ TEST_F(OptionsTest, GetPlainTableOptionsFromString) {
   ASSERT_EQ(new_opt.encoding_type, EncodingType::kPrefix);
   ASSERT_TRUE(new_opt.full_scan_mode);
   ASSERT_TRUE(new_opt.store_index_in_file);
+  ASSERT_TRUE(new_opt.prefix_trie_index);
 
   // unknown option
   ASSERT_NOK(GetPlainTableOptionsFromString(table_opt,
@@ -117,11 +117,13 @@ LIB_SOURCES =                                                   \
   table/block_based/block_prefix_index.cc                       \
   table/block_based/data_block_hash_index.cc                    \
   table/block_based/data_block_footer.cc                        \
+  table/block_based/elias_fano_block_handles.cc                 \
   table/block_based/filter_block_reader_common.cc               \
   table/block_based/flush_block_policy.cc                       \
   table/block_based/full_filter_block.cc                        \
   table/block_based/index_builder.cc                            \
   table/block_based/partitioned_filter_block.cc                 \
+  table/block_based/trie_index.cc                               \
   table/block_based/uncompression_dict_reader.cc                \
   table/block_fetcher.cc                             		\
   table/bloom_block.cc                               		\
@@ -138,6 +140,7 @@ LIB_SOURCES =                                                   \
   table/plain/plain_table_factory.cc                            \
   table/plain/plain_table_index.cc                              \
   table/plain/plain_table_key_coding.cc                         \
+  table/plain/plain_table_prefix_trie.cc                        \
   table/plain/plain_table_reader.cc                             \
   table/sst_file_reader.cc                                      \
   table/sst_file_writer.cc                                      \
@@ -202,6 +205,7 @@ LIB_SOURCES =                                                   \
   utilities/persistent_cache/block_cache_tier.cc                \
   utilities/persistent_cache/block_cache_tier_file.cc           \
   utilities/persistent_cache/block_cache_tier_metadata.cc       \
+  utilities/persistent_cache/persistent_cache_admission.cc      \
   utilities/persistent_cache/persistent_cache_tier.cc           \
   utilities/persistent_cache/volatile_tier_impl.cc              \
   utilities/simulator_cache/cache_simulator.cc                  \
@@ -346,6 +350,7 @@ MAIN_SOURCES =                                                          \
   db/write_batch_test.cc                                                \
   db/write_callback_test.cc                                             \
   db/write_controller_test.cc                                           \
+  encryption/encryption_bench.cc                                        \
   env/env_basic_test.cc                                                 \
   env/env_test.cc                                                       \
   env/mock_env_test.cc                                                  \
@@ -391,6 +396,7 @@ MAIN_SOURCES =                                                          \
   util/crc32c_test.cc                                                   \
   util/dynamic_bloom_test.cc                                            \
   util/filelock_test.cc                                                 \
+  util/filter_bench.cc                                                  \
   util/log_write_bench.cc                                               \
   util/rate_limiter_test.cc                                             \
   util/repeatable_thread_test.cc                                        \
@@ -22,6 +22,7 @@
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/data_block_footer.h"
+#include "table/block_based/elias_fano_block_handles.h"
 #include "table/format.h"
 #include "util/coding.h"
 
@@ -608,12 +609,34 @@ bool IndexBlockIter::ParseNextIndexKey() {
   }
   // else we are in the middle of a restart interval and the restart_index_
   // thus has not changed
-  if (value_delta_encoded_ || global_seqno_state_ != nullptr) {
+  if (block_handles_ != nullptr) {
+    UpdateOrdinal();
+  } else if (value_delta_encoded_ || global_seqno_state_ != nullptr) {
     DecodeCurrentValue(shared);
   }
   return true;
 }
 
+// Entries are only ever parsed going forward from a restart point, and every
+// restart interval but the last one holds restart_interval() entries.
+void IndexBlockIter::UpdateOrdinal() {
+  const uint64_t restart_interval = block_handles_->restart_interval();
+  if (current_ == GetRestartPoint(restart_index_)) {
+    ordinal_ = restart_index_ * restart_interval;
+  } else if (restart_index_ + 1 < num_restarts_ &&
+             current_ == GetRestartPoint(restart_index_ + 1)) {
+    // restart_index_ only moves past a restart point once the entry after it
+    // is parsed
+    ordinal_ = (restart_index_ + 1) * restart_interval;
+  } else {
+    ordinal_++;
+  }
+}
+
+IndexValue IndexBlockIter::ValueFromBlockHandles() const {
+  return IndexValue(block_handles_->Get(ordinal_), Slice());
+}
+
 // The format:
 // restart_point   0: k, v (off, sz), k, v (delta-sz), ..., k, v (delta-sz)
 // restart_point   1: k, v (off, sz), k, v (delta-sz), ..., k, v (delta-sz)
@@ -798,6 +821,12 @@ uint32_t Block::NumRestarts() const {
     // Such check is for backward compatibility. We can ensure legacy block
     // with a vary large num_restarts i.e. >= 0x80000000 can be interpreted
     // correctly as no HashIndex even if the MSB of num_restarts is set.
+    //
+    // Index blocks with EliasFanoBlockHandles may be that large too, their
+    // flag is the only other bit that can be set.
+    if (num_restarts < 0x80000000u && HasBlockHandlesFlag(num_restarts)) {
+      num_restarts &= ~PackBlockHandlesFlag(0);
+    }
     return num_restarts;
   }
   BlockBasedTableOptions::DataBlockIndexType index_type;
@@ -840,6 +869,18 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
     num_restarts_ = NumRestarts();
     switch (IndexType()) {
       case BlockBasedTableOptions::kDataBlockBinarySearch:
+        if (HasBlockHandlesFlag(
+                DecodeFixed32(data_ + size_ - sizeof(uint32_t)))) {
+          uint32_t restarts_end = 0;
+          Status s = EliasFanoBlockHandles::Open(contents_.data, &restarts_end,
+                                                 &block_handles_);
+          restart_offset_ = restarts_end - num_restarts_ * sizeof(uint32_t);
+          if (!s.ok() || restart_offset_ > restarts_end) {
+            block_handles_.reset();
+            size_ = 0;
+          }
+          break;
+        }
         restart_offset_ = static_cast<uint32_t>(size_) -
                           (1 + num_restarts_) * sizeof(uint32_t);
         if (restart_offset_ > size_ - sizeof(uint32_t)) {
@@ -941,7 +982,7 @@ IndexBlockIter* Block::NewIndexIterator(
     ret_iter->Initialize(cmp, ucmp, data_, restart_offset_, num_restarts_,
                          global_seqno_, prefix_index_ptr, have_first_key,
                          key_includes_seq, value_is_full,
-                         block_contents_pinned);
+                         block_contents_pinned, block_handles_.get());
   }
 
   return ret_iter;
@@ -957,6 +998,9 @@ size_t Block::ApproximateMemoryUsage() const {
   if (read_amp_bitmap_) {
     usage += read_amp_bitmap_->ApproximateMemoryUsage();
   }
+  if (block_handles_) {
+    usage += block_handles_->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
@@ -42,6 +42,7 @@ class BlockIter;
 class DataBlockIter;
 class IndexBlockIter;
 class BlockPrefixIndex;
+class EliasFanoBlockHandles;
 
 // BlockReadAmpBitmap is a bitmap that map the rocksdb::Block data bytes to
 // a bitmap with ratio bytes_per_bit. Whenever we access a range of bytes in
@@ -222,6 +223,9 @@ class Block {
   const SequenceNumber global_seqno_;
 
   DataBlockHashIndex data_block_hash_index_;
+  // handles of an index block that keeps them out of its entries, see
+  // EliasFanoBlockHandles
+  std::unique_ptr<EliasFanoBlockHandles> block_handles_;
 
   // No copying allowed
   Block(const Block&) = delete;
@@ -482,7 +486,11 @@ class DataBlockIter final : public BlockIter<Slice> {
 
 class IndexBlockIter final : public BlockIter<IndexValue> {
  public:
-  IndexBlockIter() : BlockIter(), prefix_index_(nullptr) {}
+  IndexBlockIter()
+      : BlockIter(),
+        prefix_index_(nullptr),
+        block_handles_(nullptr),
+        ordinal_(0) {}
 
   virtual Slice key() const override {
     assert(Valid());
@@ -497,13 +505,15 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
                   uint32_t restarts, uint32_t num_restarts,
                   SequenceNumber global_seqno, BlockPrefixIndex* prefix_index,
                   bool have_first_key, bool key_includes_seq,
-                  bool value_is_full, bool block_contents_pinned) {
+                  bool value_is_full, bool block_contents_pinned,
+                  const EliasFanoBlockHandles* block_handles) {
     InitializeBase(key_includes_seq ? comparator : user_comparator, data,
                    restarts, num_restarts, kDisableGlobalSequenceNumber,
                    block_contents_pinned);
     key_includes_seq_ = key_includes_seq;
     key_.SetIsUserKey(!key_includes_seq_);
     prefix_index_ = prefix_index;
+    block_handles_ = block_handles;
     value_delta_encoded_ = !value_is_full;
     have_first_key_ = have_first_key;
     if (have_first_key_ && global_seqno != kDisableGlobalSequenceNumber) {
@@ -522,7 +532,9 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
 
   virtual IndexValue value() const override {
     assert(Valid());
-    if (value_delta_encoded_ || global_seqno_state_ != nullptr) {
+    if (block_handles_ != nullptr) {
+      return ValueFromBlockHandles();
+    } else if (value_delta_encoded_ || global_seqno_state_ != nullptr) {
       return decoded_value_;
     } else {
       IndexValue entry;
@@ -567,6 +579,11 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   bool value_delta_encoded_;
   bool have_first_key_;  // value includes first_internal_key
   BlockPrefixIndex* prefix_index_;
+  // Set when the handles are kept out of the entries, which then have empty
+  // values, see EliasFanoBlockHandles. ordinal_ is the position of the
+  // current entry in the block.
+  const EliasFanoBlockHandles* block_handles_;
+  uint64_t ordinal_;
   // Whether the value is delta encoded. In that case the value is assumed to be
   // BlockHandle. The first value in each restart interval is the full encoded
   // BlockHandle; the restart of encoded size part of the BlockHandle. The
@@ -608,6 +625,11 @@ class IndexBlockIter final : public BlockIter<IndexValue> {
   // When value_delta_encoded_ is enabled it decodes the value which is assumed
   // to be BlockHandle and put it to decoded_value_
   inline void DecodeCurrentValue(uint32_t shared);
+
+  // Sets ordinal_ for the entry just parsed
+  inline void UpdateOrdinal();
+
+  IndexValue ValueFromBlockHandles() const;
 };
 
 }  // namespace rocksdb
@@ -39,6 +39,7 @@
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/format.h"
+#include "table/full_filter_bits_builder.h"
 #include "table/table_builder.h"
 
 #include "memory/memory_allocator.h"
@@ -59,63 +60,120 @@ typedef BlockBasedTableOptions::IndexType IndexType;
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
 
+// Bits builder of the full filters of a level, with the level's bloom bits
+// per key when it overrides the builtin policy's
+FilterBitsBuilder* CreateFullFilterBitsBuilder(
+    const MutableCFOptions& mopt, const BlockBasedTableOptions& table_opt,
+    int level) {
+  const int bits_per_key = mopt.BloomBitsPerKeyForLevel(level);
+  if (bits_per_key > 0 && strcmp(table_opt.filter_policy->Name(),
+                                 kBuiltinBloomFilterPolicyName) == 0) {
+    std::unique_ptr<const FilterPolicy> level_policy(
+        NewBloomFilterPolicy(bits_per_key, false));
+    return level_policy->GetFilterBitsBuilder(false);
+  }
+  return table_opt.filter_policy->GetFilterBitsBuilder(false);
+}
+
+// Bits builder of the ot lex pdt filters of a level. With the builtin policy
+// it is approximate when the level has fingerprint bits, and builds the trie
+// on the BOTTOM priority pool of the Env with pdt_background_build.
+FilterBitsBuilder* CreateOtLexPdtBitsBuilder(
+    const ImmutableCFOptions& opt, const MutableCFOptions& mopt,
+    const BlockBasedTableOptions& table_opt, int level) {
+  const int fingerprint_bits = mopt.PdtFingerprintBitsForLevel(level);
+  if ((fingerprint_bits > 0 || mopt.pdt_background_build) &&
+      strcmp(table_opt.filter_policy->Name(),
+             kBuiltinBloomFilterPolicyName) == 0) {
+    return new OtLexPdtBloomBitsBuilder(
+        fingerprint_bits, mopt.pdt_background_build ? opt.env : nullptr);
+  }
+  return table_opt.filter_policy->GetFilterBitsBuilder(true);
+}
+
 // Create a filter block builder based on its type.
 FilterBlockBuilder* CreateFilterBlockBuilder(
-    const ImmutableCFOptions& /*opt*/, const MutableCFOptions& mopt,
+    const ImmutableCFOptions& opt, const MutableCFOptions& mopt,
     const BlockBasedTableOptions& table_opt,
     const bool use_delta_encoding_for_index_values,
-    PartitionedIndexBuilder* const p_index_builder,int level) {
+    PartitionedIndexBuilder* const p_index_builder, int level) {
   if (table_opt.filter_policy == nullptr) return nullptr;
 
-  FilterBitsBuilder* filter_bits_builder;
-
-  if(level>=2)
-  {
-     filter_bits_builder=
-      table_opt.filter_policy->GetFilterBitsBuilder(true);
+  FilterKind filter_kind = mopt.FilterKindForLevel(level);
+  if (filter_kind == kFilterKindNone) {
+    return nullptr;
   }
-  else
-  {
-    filter_bits_builder=
-      table_opt.filter_policy->GetFilterBitsBuilder(false);
+  if (filter_kind == kFilterKindAdaptive && table_opt.partition_filters) {
+    // partitions are cut before the whole file is seen
+    filter_kind = kFilterKindBloom;
   }
-  
-  
+
+  // A block based filter policy has no bits builder of either kind
+  std::unique_ptr<FilterBitsBuilder> filter_bits_builder(
+      filter_kind == kFilterKindOtLexPdt
+          ? CreateOtLexPdtBitsBuilder(opt, mopt, table_opt, level)
+          : CreateFullFilterBitsBuilder(mopt, table_opt, level));
   if (filter_bits_builder == nullptr) {
     return new BlockBasedFilterBlockBuilder(mopt.prefix_extractor.get(),
                                             table_opt);
-  } else {
-    if (table_opt.partition_filters) {
-      assert(p_index_builder != nullptr);
-      // Since after partition cut request from filter builder it takes time
-      // until index builder actully cuts the partition, we take the lower bound
-      // as partition size.
-      assert(table_opt.block_size_deviation <= 100);
-      auto partition_size =
-          static_cast<uint32_t>(((table_opt.metadata_block_size *
-                                  (100 - table_opt.block_size_deviation)) +
-                                 99) /
-                                100);
-      partition_size = std::max(partition_size, static_cast<uint32_t>(1));
-      return new PartitionedFilterBlockBuilder(
-          mopt.prefix_extractor.get(), table_opt.whole_key_filtering,
-          filter_bits_builder, table_opt.index_block_restart_interval,
-          use_delta_encoding_for_index_values, p_index_builder, partition_size);
-    } else {
-      if(level>1)
-      {
-        return new OtLexPdtFilterBlockBuilder(filter_bits_builder);
-      }
-      else
-      {
-        // fprintf(stderr,"FullFilterBlockBuilder\n");
-        return new FullFilterBlockBuilder(mopt.prefix_extractor.get(),
-                                        table_opt.whole_key_filtering,
-                                        filter_bits_builder);
-      }
-      
+  }
+
+  if (table_opt.partition_filters) {
+    assert(p_index_builder != nullptr);
+    // Since after partition cut request from filter builder it takes time
+    // until index builder actully cuts the partition, we take the lower bound
+    // as partition size.
+    assert(table_opt.block_size_deviation <= 100);
+    auto partition_size =
+        static_cast<uint32_t>(((table_opt.metadata_block_size *
+                                (100 - table_opt.block_size_deviation)) +
+                               99) /
+                              100);
+    partition_size = std::max(partition_size, static_cast<uint32_t>(1));
+    if (filter_kind == kFilterKindOtLexPdt) {
+      return new PartitionedOtLexPdtFilterBlockBuilder(
+          filter_bits_builder.release(), table_opt.index_block_restart_interval,
+          use_delta_encoding_for_index_values, p_index_builder,
+          partition_size);
     }
+    return new PartitionedFilterBlockBuilder(
+        mopt.prefix_extractor.get(), table_opt.whole_key_filtering,
+        filter_bits_builder.release(), table_opt.index_block_restart_interval,
+        use_delta_encoding_for_index_values, p_index_builder, partition_size);
+  }
+
+  if (filter_kind == kFilterKindBloom) {
+    return new FullFilterBlockBuilder(mopt.prefix_extractor.get(),
+                                      table_opt.whole_key_filtering,
+                                      filter_bits_builder.release());
+  }
+
+  // the block index relies on trie ranks following the table order
+  // and on data blocks being written back to back
+  const bool build_block_index =
+      table_opt.pdt_data_block_index && !table_opt.block_align &&
+      opt.user_comparator == BytewiseComparator() &&
+      strcmp(table_opt.filter_policy->Name(),
+             kBuiltinBloomFilterPolicyName) == 0;
+  if (filter_kind == kFilterKindOtLexPdt) {
+    return new OtLexPdtFilterBlockBuilder(filter_bits_builder.release(),
+                                          build_block_index);
   }
+
+  assert(filter_kind == kFilterKindAdaptive);
+  std::unique_ptr<FilterBitsBuilder> pdt_bits_builder(
+      CreateOtLexPdtBitsBuilder(opt, mopt, table_opt, level));
+  auto* full_filter_builder = new FullFilterBlockBuilder(
+      mopt.prefix_extractor.get(), table_opt.whole_key_filtering,
+      filter_bits_builder.release());
+  if (pdt_bits_builder == nullptr) {
+    return full_filter_builder;
+  }
+  return new AdaptiveFilterBlockBuilder(
+      full_filter_builder,
+      new OtLexPdtFilterBlockBuilder(pdt_bits_builder.release(),
+                                     build_block_index),
+      mopt.adaptive_filter_max_size_ratio);
 }
 
 bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
@@ -872,20 +930,14 @@ void BlockBasedTableBuilder::WriteFilterBlock(
     std::string key;
     if (rep_->filter_builder->IsBlockBased()) {
       key = BlockBasedTable::kFilterBlockPrefix;
+    } else if (rep_->table_options.partition_filters) {
+      key = rep_->filter_builder->IsOtLexPdt()
+                ? BlockBasedTable::kPartitionedOtLexPdtFilterBlockPrefix
+                : BlockBasedTable::kPartitionedFilterBlockPrefix;
     } else {
-      if(rep_->table_options.partition_filters)
-      {
-        key=BlockBasedTable::kPartitionedFilterBlockPrefix;
-      }
-      else
-      {
-        if(level>1) {
-          key = BlockBasedTable::kOtLexPdtFilterBlockPrefix;
-        }
-        else {
-          key = BlockBasedTable::kFullFilterBlockPrefix;
-        }
-      }
+      key = rep_->filter_builder->IsOtLexPdt()
+                ? BlockBasedTable::kOtLexPdtFilterBlockPrefix
+                : BlockBasedTable::kFullFilterBlockPrefix;
     }
     key.append(rep_->table_options.filter_policy->Name());
     meta_index_builder->Add(key, filter_block_handle);
@@ -1228,4 +1280,6 @@ const std::string BlockBasedTable::kPartitionedFilterBlockPrefix =
 
 //wp
 const std::string BlockBasedTable::kOtLexPdtFilterBlockPrefix = "otlexpdtfilter."; //xp
+const std::string BlockBasedTable::kPartitionedOtLexPdtFilterBlockPrefix =
+    "partitionedotlexpdtfilter.";
 }  // namespace rocksdb
@@ -192,6 +192,12 @@ BlockBasedTableFactory::BlockBasedTableFactory(
     // We do not support partitioned filters without partitioning indexes
     table_options_.partition_filters = false;
   }
+  if (table_options_.elias_fano_partition_handles &&
+      table_options_.index_type !=
+          BlockBasedTableOptions::kTwoLevelIndexSearch) {
+    // Only index partitions store their handles this way
+    table_options_.elias_fano_partition_handles = false;
+  }
 }
 
 Status BlockBasedTableFactory::NewTableReader(
@@ -236,6 +242,12 @@ Status BlockBasedTableFactory::SanitizeOptions(
         "Hash index is specified for block-based "
         "table, but prefix_extractor is not given");
   }
+  if (table_options_.index_type == BlockBasedTableOptions::kTrieSearch &&
+      cf_opts.comparator != BytewiseComparator()) {
+    return Status::InvalidArgument(
+        "Trie index is specified for block-based "
+        "table, but the comparator is not bytewise");
+  }
   if (table_options_.cache_index_and_filter_blocks &&
       table_options_.no_block_cache) {
     return Status::InvalidArgument(
@@ -248,6 +260,14 @@ Status BlockBasedTableFactory::SanitizeOptions(
         "Enable pin_l0_filter_and_index_blocks_in_cache, "
         ", but block cache is disabled");
   }
+  if (table_options_.persistent_cache_demote_on_evict &&
+      table_options_.persistent_cache &&
+      (table_options_.no_block_cache ||
+       table_options_.persistent_cache->IsCompressed())) {
+    return Status::InvalidArgument(
+        "Enable persistent_cache_demote_on_evict, but block cache is "
+        "disabled or persistent cache stores compressed pages");
+  }
   if (!BlockBasedTableSupportedVersion(table_options_.format_version)) {
     return Status::InvalidArgument(
         "Unsupported BlockBasedTable format_version. Please check "
@@ -357,6 +377,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  persistent_cache: %p\n",
            static_cast<void*>(table_options_.persistent_cache.get()));
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  persistent_cache_demote_on_evict: %d\n",
+           table_options_.persistent_cache_demote_on_evict);
+  ret.append(buffer);
   if (table_options_.persistent_cache) {
     snprintf(buffer, kBufferSize, "  persistent_cache_options:\n");
     ret.append(buffer);
@@ -380,6 +403,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  partition_filters: %d\n",
            table_options_.partition_filters);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  elias_fano_partition_handles: %d\n",
+           table_options_.elias_fano_partition_handles);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  use_delta_encoding: %d\n",
            table_options_.use_delta_encoding);
   ret.append(buffer);
@@ -394,6 +420,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  verify_compression: %d\n",
            table_options_.verify_compression);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  pdt_data_block_index: %d\n",
+           table_options_.pdt_data_block_index);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  read_amp_bytes_per_bit: %d\n",
            table_options_.read_amp_bytes_per_bit);
   ret.append(buffer);
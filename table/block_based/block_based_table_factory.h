@@ -162,6 +162,9 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"partition_filters",
          {offsetof(struct BlockBasedTableOptions, partition_filters),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"elias_fano_partition_handles",
+         {offsetof(struct BlockBasedTableOptions, elias_fano_partition_handles),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"filter_policy",
          {offsetof(struct BlockBasedTableOptions, filter_policy),
           OptionType::kFilterPolicy, OptionVerificationType::kByName, false,
@@ -178,6 +181,9 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"verify_compression",
          {offsetof(struct BlockBasedTableOptions, verify_compression),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"pdt_data_block_index",
+         {offsetof(struct BlockBasedTableOptions, pdt_data_block_index),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"read_amp_bytes_per_bit",
          {offsetof(struct BlockBasedTableOptions, read_amp_bytes_per_bit),
           OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
@@ -190,6 +196,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"pin_top_level_index_and_filter",
          {offsetof(struct BlockBasedTableOptions,
                    pin_top_level_index_and_filter),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"persistent_cache_demote_on_evict",
+         {offsetof(struct BlockBasedTableOptions,
+                   persistent_cache_demote_on_evict),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}}};
 #endif  // !ROCKSDB_LITE
 }  // namespace rocksdb
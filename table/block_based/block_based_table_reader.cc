@@ -12,6 +12,7 @@
 #include <array>
 #include <limits>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -35,6 +36,7 @@
 #include "table/block_based/filter_block.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/partitioned_filter_block.h"
+#include "table/block_based/trie_index.h"
 #include "table/block_fetcher.h"
 #include "table/format.h"
 #include "table/get_context.h"
@@ -63,6 +65,9 @@ extern const std::string kHashIndexPrefixesMetadataBlock;
 typedef BlockBasedTable::IndexReader IndexReader;
 
 BlockBasedTable::~BlockBasedTable() {
+  if (rep_->demote_target != nullptr) {
+    rep_->demote_target->table_closed = true;
+  }
   delete rep_;
 }
 
@@ -79,8 +84,8 @@ class BlocklikeTraits<BlockContents> {
                                size_t /* read_amp_bytes_per_bit */,
                                Statistics* /* statistics */,
                                bool /* using_zstd */,
-                               const FilterPolicy* /* filter_policy */
-                                ) {
+                               const FilterPolicy* /* filter_policy */,
+                               bool /* is_pdt_filter */) {
     return new BlockContents(std::move(contents));
   }
 
@@ -95,8 +100,8 @@ class BlocklikeTraits<Block> {
   static Block* Create(BlockContents&& contents, SequenceNumber global_seqno,
                        size_t read_amp_bytes_per_bit, Statistics* statistics,
                        bool /* using_zstd */,
-                       const FilterPolicy* /* filter_policy */
-                       ) {
+                       const FilterPolicy* /* filter_policy */,
+                       bool /* is_pdt_filter */) {
     return new Block(std::move(contents), global_seqno, read_amp_bytes_per_bit,
                      statistics);
   }
@@ -115,8 +120,10 @@ class BlocklikeTraits<ParsedFullFilterBlock> {
                                        size_t /* read_amp_bytes_per_bit */,
                                        Statistics* /* statistics */,
                                        bool /* using_zstd */,
-                                       const FilterPolicy* filter_policy) {
-    return new ParsedFullFilterBlock(filter_policy, std::move(contents));
+                                       const FilterPolicy* filter_policy,
+                                       bool is_pdt_filter) {
+    return new ParsedFullFilterBlock(filter_policy, std::move(contents),
+                                     is_pdt_filter);
   }
 
   static uint32_t GetNumRestarts(const ParsedFullFilterBlock& /* block */) {
@@ -124,6 +131,24 @@ class BlocklikeTraits<ParsedFullFilterBlock> {
   }
 };
 
+template <>
+class BlocklikeTraits<TrieIndexBlock> {
+ public:
+  static TrieIndexBlock* Create(BlockContents&& contents,
+                                SequenceNumber /* global_seqno */,
+                                size_t /* read_amp_bytes_per_bit */,
+                                Statistics* /* statistics */,
+                                bool /* using_zstd */,
+                                const FilterPolicy* /* filter_policy */,
+                                bool /* is_pdt_filter */) {
+    return new TrieIndexBlock(std::move(contents));
+  }
+
+  static uint32_t GetNumRestarts(const TrieIndexBlock& /* block */) {
+    return 0;
+  }
+};
+
 template <>
 class BlocklikeTraits<UncompressionDict> {
  public:
@@ -132,8 +157,8 @@ class BlocklikeTraits<UncompressionDict> {
                                    size_t /* read_amp_bytes_per_bit */,
                                    Statistics* /* statistics */,
                                    bool using_zstd,
-                                   const FilterPolicy* /* filter_policy */
-                                   ) {
+                                   const FilterPolicy* /* filter_policy */,
+                                   bool /* is_pdt_filter */) {
     return new UncompressionDict(contents.data, std::move(contents.allocation),
                                  using_zstd);
   }
@@ -159,7 +184,7 @@ Status ReadBlockFromFile(
     const UncompressionDict& uncompression_dict,
     const PersistentCacheOptions& cache_options, SequenceNumber global_seqno,
     size_t read_amp_bytes_per_bit, MemoryAllocator* memory_allocator,
-    bool for_compaction, bool using_zstd,const FilterPolicy* filter_policy,int level,bool is_meta_block=false) {
+    bool for_compaction, bool using_zstd,const FilterPolicy* filter_policy,bool is_pdt_filter,int level,bool is_meta_block=false) {
   assert(result);
 
   BlockContents contents;
@@ -171,7 +196,7 @@ Status ReadBlockFromFile(
   if (s.ok()) {
     result->reset(BlocklikeTraits<TBlocklike>::Create(
         std::move(contents), global_seqno, read_amp_bytes_per_bit,
-        ioptions.statistics, using_zstd,filter_policy));
+        ioptions.statistics, using_zstd,filter_policy,is_pdt_filter));
   }
 
   return s;
@@ -198,6 +223,61 @@ void DeleteCachedEntry(const Slice& /*key*/, void* value) {
   delete entry;
 }
 
+// Data block handed to the persistent cache when the block cache evicts it
+class DemotableBlock : public Block {
+ public:
+  DemotableBlock(
+      BlockContents&& contents, SequenceNumber _global_seqno,
+      size_t read_amp_bytes_per_bit, Statistics* statistics,
+      const std::shared_ptr<const BlockBasedTable::Rep::DemoteTarget>& target,
+      const BlockHandle& handle)
+      : Block(std::move(contents), _global_seqno, read_amp_bytes_per_bit,
+              statistics),
+        target_(target),
+        handle_(handle) {}
+
+  void Demote() const {
+    if (target_->table_closed.load(std::memory_order_relaxed)) {
+      return;
+    }
+    PersistentCacheHelper::InsertUncompressedPage(
+        target_->cache_options, handle_, BlockContents(Slice(data(), size())),
+        false, target_->fname);
+  }
+
+ private:
+  std::shared_ptr<const BlockBasedTable::Rep::DemoteTarget> target_;
+  BlockHandle handle_;
+};
+
+template <class TBlocklike>
+TBlocklike* NewDemotableBlock(
+    BlockContents&& /*contents*/, SequenceNumber /*global_seqno*/,
+    size_t /*read_amp_bytes_per_bit*/, Statistics* /*statistics*/,
+    const std::shared_ptr<const BlockBasedTable::Rep::DemoteTarget>& /*target*/,
+    const BlockHandle& /*handle*/) {
+  // only data blocks are demoted, never called
+  assert(false);
+  return nullptr;
+}
+
+template <>
+Block* NewDemotableBlock<Block>(
+    BlockContents&& contents, SequenceNumber global_seqno,
+    size_t read_amp_bytes_per_bit, Statistics* statistics,
+    const std::shared_ptr<const BlockBasedTable::Rep::DemoteTarget>& target,
+    const BlockHandle& handle) {
+  return new DemotableBlock(std::move(contents), global_seqno,
+                            read_amp_bytes_per_bit, statistics, target, handle);
+}
+
+// Demote and delete the block resided in the cache.
+void DemoteCachedBlock(const Slice& /*key*/, void* value) {
+  auto block = reinterpret_cast<DemotableBlock*>(value);
+  block->Demote();
+  delete block;
+}
+
 // Release the cached entry and decrement its ref count.
 void ForceReleaseCachedEntry(void* arg, void* h) {
   Cache* cache = reinterpret_cast<Cache*>(arg);
@@ -631,6 +711,131 @@ class BinarySearchIndexReader : public BlockBasedTable::IndexReaderCommon {
       : IndexReaderCommon(t, std::move(index_block)) {}
 };
 
+// Index that looks up the separators in a trie, see TrieIndex. The trie is
+// mapped once, when the block is read, and cached along with it.
+class TrieIndexReader : public BlockBasedTable::IndexReader {
+ public:
+  // Read index from the file and create an instance for `TrieIndexReader`.
+  // On success, index_reader will be populated; otherwise it will remain
+  // unmodified.
+  static Status Create(const BlockBasedTable* table,
+                       FilePrefetchBuffer* prefetch_buffer, bool use_cache,
+                       bool prefetch, bool pin,
+                       BlockCacheLookupContext* lookup_context,
+                       std::unique_ptr<IndexReader>* index_reader) {
+    assert(table != nullptr);
+    assert(table->get_rep());
+    assert(!pin || prefetch);
+    assert(index_reader != nullptr);
+
+    CachableEntry<TrieIndexBlock> index_block;
+    if (prefetch || !use_cache) {
+      Status s =
+          ReadIndexBlock(table, prefetch_buffer, ReadOptions(), use_cache,
+                         /*get_context=*/nullptr, lookup_context, &index_block);
+      if (s.ok()) {
+        s = index_block.GetValue()->status();
+      }
+      if (!s.ok()) {
+        return s;
+      }
+
+      if (use_cache && !pin) {
+        index_block.Reset();
+      }
+    }
+
+    index_reader->reset(new TrieIndexReader(table, std::move(index_block)));
+
+    return Status::OK();
+  }
+
+  InternalIteratorBase<IndexValue>* NewIterator(
+      const ReadOptions& read_options, bool /* disable_prefix_seek */,
+      IndexBlockIter* /* iter */, GetContext* get_context,
+      BlockCacheLookupContext* lookup_context) override {
+    const bool no_io = (read_options.read_tier == kBlockCacheTier);
+    CachableEntry<TrieIndexBlock> index_block;
+    Status s =
+        GetOrReadIndexBlock(no_io, get_context, lookup_context, &index_block);
+    if (s.ok()) {
+      s = index_block.GetValue()->status();
+    }
+    if (!s.ok()) {
+      return NewErrorInternalIterator<IndexValue>(s);
+    }
+
+    auto it = new TrieIndexIterator(index_block.GetValue()->index());
+    index_block.TransferTo(it);
+
+    return it;
+  }
+
+  size_t ApproximateMemoryUsage() const override {
+    size_t usage = index_block_.GetOwnValue()
+                       ? index_block_.GetValue()->ApproximateMemoryUsage()
+                       : 0;
+#ifdef ROCKSDB_MALLOC_USABLE_SIZE
+    usage += malloc_usable_size(const_cast<TrieIndexReader*>(this));
+#else
+    usage += sizeof(*this);
+#endif  // ROCKSDB_MALLOC_USABLE_SIZE
+    return usage;
+  }
+
+ private:
+  TrieIndexReader(const BlockBasedTable* t,
+                  CachableEntry<TrieIndexBlock>&& index_block)
+      : table_(t), index_block_(std::move(index_block)) {
+    assert(table_ != nullptr);
+  }
+
+  static Status ReadIndexBlock(const BlockBasedTable* table,
+                               FilePrefetchBuffer* prefetch_buffer,
+                               const ReadOptions& read_options, bool use_cache,
+                               GetContext* get_context,
+                               BlockCacheLookupContext* lookup_context,
+                               CachableEntry<TrieIndexBlock>* index_block) {
+    PERF_TIMER_GUARD(read_index_block_nanos);
+
+    assert(index_block != nullptr);
+    assert(index_block->IsEmpty());
+
+    const BlockBasedTable::Rep* const rep = table->get_rep();
+    assert(rep != nullptr);
+
+    return table->RetrieveBlock(
+        prefetch_buffer, read_options, rep->footer.index_handle(),
+        UncompressionDict::GetEmptyDict(), index_block, BlockType::kIndex,
+        get_context, lookup_context, /* for_compaction */ false, use_cache,
+        true);
+  }
+
+  Status GetOrReadIndexBlock(bool no_io, GetContext* get_context,
+                             BlockCacheLookupContext* lookup_context,
+                             CachableEntry<TrieIndexBlock>* index_block) const {
+    assert(index_block != nullptr);
+
+    if (!index_block_.IsEmpty()) {
+      index_block->SetUnownedValue(index_block_.GetValue());
+      return Status::OK();
+    }
+
+    ReadOptions read_options;
+    if (no_io) {
+      read_options.read_tier = kBlockCacheTier;
+    }
+
+    return ReadIndexBlock(
+        table_, /*prefetch_buffer=*/nullptr, read_options,
+        table_->get_rep()->table_options.cache_index_and_filter_blocks,
+        get_context, lookup_context, index_block);
+  }
+
+  const BlockBasedTable* table_;
+  CachableEntry<TrieIndexBlock> index_block_;
+};
+
 // Index that leverages an internal hash table to quicken the lookup for a given
 // key.
 class HashIndexReader : public BlockBasedTable::IndexReaderCommon {
@@ -1192,6 +1397,14 @@ Status BlockBasedTable::Open(
                              std::string(rep->persistent_cache_key_prefix,
                                          rep->persistent_cache_key_prefix_size),
                              rep->ioptions.statistics);
+  if (rep->table_options.persistent_cache_demote_on_evict &&
+      rep->table_options.persistent_cache &&
+      !rep->table_options.persistent_cache->IsCompressed() &&
+      rep->table_options.block_cache) {
+    rep->persistent_cache_options.demote_on_evict = true;
+    rep->demote_target.reset(new Rep::DemoteTarget(
+        rep->persistent_cache_options, rep->file->file_name()));
+  }
 
   // Meta-blocks are not dictionary compressed. Explicitly set the dictionary
   // handle to null, otherwise it may be seen as uninitialized during the below
@@ -1485,6 +1698,7 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
   if (rep_->filter_policy) {
     for (auto filter_type :
          {Rep::FilterType::kOtLexPdtFilter,
+          Rep::FilterType::kPartitionedOtLexPdtFilter,
          Rep::FilterType::kFullFilter, Rep::FilterType::kPartitionedFilter,
           Rep::FilterType::kBlockFilter}) {
       std::string prefix;
@@ -1492,6 +1706,9 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
         case Rep::FilterType::kOtLexPdtFilter:
           prefix = kOtLexPdtFilterBlockPrefix; //xp
           break;
+        case Rep::FilterType::kPartitionedOtLexPdtFilter:
+          prefix = kPartitionedOtLexPdtFilterBlockPrefix;
+          break;
         case Rep::FilterType::kFullFilter:
           prefix = kFullFilterBlockPrefix;
           break;
@@ -1557,17 +1774,19 @@ Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
     rep_->index_reader->CacheDependencies(pin_all);
   }
 
+  const bool partitioned_filter =
+      rep_->filter_type == Rep::FilterType::kPartitionedFilter ||
+      rep_->filter_type == Rep::FilterType::kPartitionedOtLexPdtFilter;
   // prefetch the first level of filter
   const bool prefetch_filter =
       prefetch_all ||
-      (table_options.pin_top_level_index_and_filter &&
-       rep_->filter_type == Rep::FilterType::kPartitionedFilter);
+      (table_options.pin_top_level_index_and_filter && partitioned_filter);
   // Partition fitlers cannot be enabled without partition indexes
   assert(!prefetch_filter || prefetch_index);
   // pin the first level of filter
   const bool pin_filter =
-      pin_all || (table_options.pin_top_level_index_and_filter &&
-                  rep_->filter_type == Rep::FilterType::kPartitionedFilter);
+      pin_all ||
+      (table_options.pin_top_level_index_and_filter && partitioned_filter);
 
   if (rep_->filter_policy) {
     auto filter = new_table->CreateFilterBlockReader(
@@ -1651,7 +1870,7 @@ Status BlockBasedTable::ReadMetaBlock(FilePrefetchBuffer* prefetch_buffer,
       UncompressionDict::GetEmptyDict(), rep_->persistent_cache_options,
       kDisableGlobalSequenceNumber, 0 /* read_amp_bytes_per_bit */,
       GetMemoryAllocator(rep_->table_options), false /* for_compaction */,
-      rep_->blocks_definitely_zstd_compressed,nullptr,rep_->level,true);
+      rep_->blocks_definitely_zstd_compressed,nullptr,false,rep_->level,true);
 
   if (!s.ok()) {
     ROCKS_LOG_ERROR(rep_->ioptions.info_log,
@@ -1741,7 +1960,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
             std::move(contents), rep_->get_global_seqno(block_type),
             read_amp_bytes_per_bit, statistics,
             rep_->blocks_definitely_zstd_compressed,
-             rep_->table_options.filter_policy.get()));  // uncompressed block
+             rep_->table_options.filter_policy.get(),
+             rep_->is_pdt_filter()));  // uncompressed block
 
     if (block_cache != nullptr && block_holder->own_bytes() &&
         read_options.fill_cache) {
@@ -1776,7 +1996,8 @@ Status BlockBasedTable::PutDataBlockToCache(
     CompressionType raw_block_comp_type,
     const UncompressionDict& uncompression_dict, SequenceNumber seq_no,
     MemoryAllocator* memory_allocator, BlockType block_type,
-    GetContext* get_context) const {
+    GetContext* get_context, const BlockHandle& handle,
+    bool from_persistent_cache) const {
   const ImmutableCFOptions& ioptions = rep_->ioptions;
   const uint32_t format_version = rep_->table_options.format_version;
   const size_t read_amp_bytes_per_bit =
@@ -1797,9 +2018,10 @@ Status BlockBasedTable::PutDataBlockToCache(
   Statistics* statistics = ioptions.statistics;
 
   std::unique_ptr<TBlocklike> block_holder;
+  BlockContents uncompressed_block_contents;
+  BlockContents* block_contents = raw_block_contents;
   if (raw_block_comp_type != kNoCompression) {
     // Retrieve the uncompressed contents into a new buffer
-    BlockContents uncompressed_block_contents;
     UncompressionContext context(raw_block_comp_type);
     UncompressionInfo info(context, uncompression_dict, raw_block_comp_type);
     s = UncompressBlockContents(info, raw_block_contents->data.data(),
@@ -1809,16 +2031,26 @@ Status BlockBasedTable::PutDataBlockToCache(
     if (!s.ok()) {
       return s;
     }
-
-    block_holder.reset(BlocklikeTraits<TBlocklike>::Create(
-        std::move(uncompressed_block_contents), seq_no, read_amp_bytes_per_bit,
-        statistics, rep_->blocks_definitely_zstd_compressed,
-        rep_->table_options.filter_policy.get()));
+    block_contents = &uncompressed_block_contents;
+  }
+
+  // The data blocks of the upper levels are not looked up in the persistent
+  // cache, they are not demoted either. Neither are the blocks it already
+  // holds, which would only be written there again.
+  const bool demote = std::is_same<TBlocklike, Block>::value &&
+                      rep_->demote_target != nullptr &&
+                      block_type == BlockType::kData && rep_->level >= 2 &&
+                      !from_persistent_cache && block_cache != nullptr &&
+                      block_contents->own_bytes();
+  if (demote) {
+    block_holder.reset(NewDemotableBlock<TBlocklike>(
+        std::move(*block_contents), seq_no, read_amp_bytes_per_bit, statistics,
+        rep_->demote_target, handle));
   } else {
     block_holder.reset(BlocklikeTraits<TBlocklike>::Create(
-        std::move(*raw_block_contents), seq_no, read_amp_bytes_per_bit,
-        statistics, rep_->blocks_definitely_zstd_compressed,
-        rep_->table_options.filter_policy.get()));
+        std::move(*block_contents), seq_no, read_amp_bytes_per_bit, statistics,
+        rep_->blocks_definitely_zstd_compressed,
+        rep_->table_options.filter_policy.get(), rep_->is_pdt_filter()));
   }
 
   // Insert compressed block into compressed block cache.
@@ -1851,9 +2083,10 @@ Status BlockBasedTable::PutDataBlockToCache(
   if (block_cache != nullptr && block_holder->own_bytes()) {
     size_t charge = block_holder->ApproximateMemoryUsage();
     Cache::Handle* cache_handle = nullptr;
-    s = block_cache->Insert(block_cache_key, block_holder.get(), charge,
-                            &DeleteCachedEntry<TBlocklike>, &cache_handle,
-                            priority);
+    s = block_cache->Insert(
+        block_cache_key, block_holder.get(), charge,
+        demote ? &DemoteCachedBlock : &DeleteCachedEntry<TBlocklike>,
+        &cache_handle, priority);
     if (s.ok()) {
       assert(cache_handle != nullptr);
       cached_block->SetCachedValue(block_holder.release(), block_cache,
@@ -1862,6 +2095,11 @@ Status BlockBasedTable::PutDataBlockToCache(
       UpdateCacheInsertionMetrics(block_type, get_context, charge);
     } else {
       RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
+      if (demote) {
+        // the block is not cached in RAM, give it to the persistent cache
+        // right away
+        DemoteCachedBlock(block_cache_key, block_holder.release());
+      }
     }
   } else {
     cached_block->SetOwnedValue(block_holder.release());
@@ -1886,6 +2124,10 @@ std::unique_ptr<FilterBlockReader> BlockBasedTable::CreateFilterBlockReader(
       return PartitionedFilterBlockReader::Create(
           this, prefetch_buffer, use_cache, prefetch, pin, lookup_context);
 
+    case Rep::FilterType::kPartitionedOtLexPdtFilter:
+      return PartitionedOtLexPdtFilterBlockReader::Create(
+          this, prefetch_buffer, use_cache, prefetch, pin, lookup_context);
+
     case Rep::FilterType::kBlockFilter:
       return BlockBasedFilterBlockReader::Create(
           this, prefetch_buffer, use_cache, prefetch, pin, lookup_context);
@@ -2199,6 +2441,7 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
       const bool do_uncompress = maybe_compressed && !block_cache_compressed;
       CompressionType raw_block_comp_type;
       BlockContents raw_block_contents;
+      bool from_persistent_cache = false;
       if (!contents) {
         StopWatch sw(rep_->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
         BlockFetcher block_fetcher(
@@ -2210,6 +2453,7 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
             GetMemoryAllocatorForCompressedBlock(rep_->table_options));
         s = block_fetcher.ReadBlockContents(rep_->level,is_meta_block);
         raw_block_comp_type = block_fetcher.get_compression_type();
+        from_persistent_cache = block_fetcher.got_from_persistent_cache();
         contents = &raw_block_contents;
       } else {
         raw_block_comp_type = contents->get_compression_type();
@@ -2223,7 +2467,8 @@ Status BlockBasedTable::MaybeReadBlockAndLoadToCache(
                                 block_entry, contents,
                                 raw_block_comp_type, uncompression_dict, seq_no,
                                 GetMemoryAllocator(rep_->table_options),
-                                block_type, get_context);
+                                block_type, get_context, handle,
+                                from_persistent_cache);
       }
     }
   }
@@ -2512,7 +2757,8 @@ Status BlockBasedTable::RetrieveBlock(
             : 0,
         GetMemoryAllocator(rep_->table_options), for_compaction,
         rep_->blocks_definitely_zstd_compressed,
-        rep_->table_options.filter_policy.get(),rep_->level,is_meta_block);
+        rep_->table_options.filter_policy.get(),rep_->is_pdt_filter(),
+        rep_->level,is_meta_block);
   }
 
   if (!s.ok()) {
@@ -2548,6 +2794,13 @@ template Status BlockBasedTable::RetrieveBlock<ParsedFullFilterBlock>(
     GetContext* get_context, BlockCacheLookupContext* lookup_context,
     bool for_compaction, bool use_cache,bool is_meta_block=false) const;
 
+template Status BlockBasedTable::RetrieveBlock<TrieIndexBlock>(
+    FilePrefetchBuffer* prefetch_buffer, const ReadOptions& ro,
+    const BlockHandle& handle, const UncompressionDict& uncompression_dict,
+    CachableEntry<TrieIndexBlock>* block_entry, BlockType block_type,
+    GetContext* get_context, BlockCacheLookupContext* lookup_context,
+    bool for_compaction, bool use_cache,bool is_meta_block=false) const;
+
 template Status BlockBasedTable::RetrieveBlock<UncompressionDict>(
     FilePrefetchBuffer* prefetch_buffer, const ReadOptions& ro,
     const BlockHandle& handle, const UncompressionDict& uncompression_dict,
@@ -2701,6 +2954,21 @@ bool BlockBasedTable::PrefixMayMatch(
   return may_match;
 }
 
+bool BlockBasedTable::KeysMayExistInRange(
+    const Slice& internal_key, const Slice& upper_bound,
+    BlockCacheLookupContext* lookup_context) const {
+  if (rep_->filter_type != Rep::FilterType::kOtLexPdtFilter ||
+      rep_->filter == nullptr) {
+    return true;
+  }
+  const OtLexPdtFilterBlockReader* const filter =
+      static_cast<const OtLexPdtFilterBlockReader*>(rep_->filter.get());
+  // records BLOOM_FILTER_RANGE_CHECKED/USEFUL when it gets to the filter
+  return filter->KeysMayExistInRange(ExtractUserKey(internal_key),
+                                     &upper_bound, false /* no_io */,
+                                     lookup_context);
+}
+
 template <class TBlockIter, typename TValue>
 void BlockBasedTableIterator<TBlockIter, TValue>::Seek(const Slice& target) {
   SeekImpl(&target);
@@ -2720,6 +2988,9 @@ void BlockBasedTableIterator<TBlockIter, TValue>::SeekImpl(
     ResetDataIter();
     return;
   }
+  if (target && !CheckRangeMayExist(*target)) {
+    return;
+  }
 
   bool need_seek_index = true;
   if (block_iter_points_to_real_block_ && block_iter_.Valid()) {
@@ -3126,6 +3397,15 @@ InternalIterator* BlockBasedTable::NewIterator(
   BlockCacheLookupContext lookup_context{caller};
   bool need_upper_bound_check =
       PrefixExtractorChanged(rep_->table_properties.get(), prefix_extractor);
+  const bool check_filter = !skip_filters && !read_options.total_order_seek &&
+                            prefix_extractor != nullptr;
+  // Seeks that the prefix check already covers go through
+  // OtLexPdtFilterBlockReader::RangeMayExist() instead
+  const bool check_range =
+      !skip_filters && !check_filter &&
+      read_options.iterate_upper_bound != nullptr &&
+      rep_->filter_type == Rep::FilterType::kOtLexPdtFilter &&
+      rep_->internal_comparator.user_comparator() == BytewiseComparator();
   if (arena == nullptr) {
     return new BlockBasedTableIterator<DataBlockIter>(
         this, read_options, rep_->internal_comparator,
@@ -3134,10 +3414,8 @@ InternalIterator* BlockBasedTable::NewIterator(
             need_upper_bound_check &&
                 rep_->index_type == BlockBasedTableOptions::kHashSearch,
             /*input_iter=*/nullptr, /*get_context=*/nullptr, &lookup_context),
-        !skip_filters && !read_options.total_order_seek &&
-            prefix_extractor != nullptr,
-        need_upper_bound_check, prefix_extractor, BlockType::kData, caller,
-        compaction_readahead_size);
+        check_filter, need_upper_bound_check, prefix_extractor,
+        BlockType::kData, caller, compaction_readahead_size, check_range);
   } else {
     auto* mem =
         arena->AllocateAligned(sizeof(BlockBasedTableIterator<DataBlockIter>));
@@ -3146,10 +3424,8 @@ InternalIterator* BlockBasedTable::NewIterator(
         NewIndexIterator(read_options, need_upper_bound_check,
                          /*input_iter=*/nullptr, /*get_context=*/nullptr,
                          &lookup_context),
-        !skip_filters && !read_options.total_order_seek &&
-            prefix_extractor != nullptr,
-        need_upper_bound_check, prefix_extractor, BlockType::kData, caller,
-        compaction_readahead_size);
+        check_filter, need_upper_bound_check, prefix_extractor,
+        BlockType::kData, caller, compaction_readahead_size, check_range);
   }
 }
 
@@ -3251,34 +3527,58 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
     lookup_context.get_from_user_specified_snapshot =
         read_options.snapshot != nullptr;
   }
-  const bool may_match =
-      FullFilterKeyMayMatch(read_options, filter, key, no_io, prefix_extractor,
-                            get_context, &lookup_context);
+  // An ot lex pdt filter may also know which data block holds the key, in
+  // which case the same trie lookup replaces the index block search.
+  OtLexPdtBlockIndexIterator pdt_iiter;
+  bool use_pdt_block_index = false;
+  if (filter != nullptr &&
+      rep_->filter_type == Rep::FilterType::kOtLexPdtFilter &&
+      rep_->whole_key_filtering) {
+    use_pdt_block_index =
+        static_cast<OtLexPdtFilterBlockReader*>(filter)->InitBlockIndexIterator(
+            no_io, get_context, &lookup_context, &pdt_iiter);
+  }
+  bool may_match;
+  if (use_pdt_block_index) {
+    pdt_iiter.Seek(key);
+    may_match = pdt_iiter.Valid();
+    if (may_match) {
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_FULL_POSITIVE);
+      PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_full_positive, 1, rep_->level);
+    }
+  } else {
+    may_match = FullFilterKeyMayMatch(read_options, filter, key, no_io,
+                                      prefix_extractor, get_context,
+                                      &lookup_context);
+  }
   if (!may_match) {
     RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
     PERF_COUNTER_BY_LEVEL_ADD(bloom_filter_useful, 1, rep_->level);
   } else {
     IndexBlockIter iiter_on_stack;
-    // if prefix_extractor found in block differs from options, disable
-    // BlockPrefixIndex. Only do this check when index_type is kHashSearch.
-    bool need_upper_bound_check = false;
-    if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
-      need_upper_bound_check = PrefixExtractorChanged(
-          rep_->table_properties.get(), prefix_extractor);
-    }
-    auto iiter =
-        NewIndexIterator(read_options, need_upper_bound_check, &iiter_on_stack,
-                         get_context, &lookup_context);
+    InternalIteratorBase<IndexValue>* iiter = &pdt_iiter;
     std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
-    if (iiter != &iiter_on_stack) {
-      iiter_unique_ptr.reset(iiter);
+    if (!use_pdt_block_index) {
+      // if prefix_extractor found in block differs from options, disable
+      // BlockPrefixIndex. Only do this check when index_type is kHashSearch.
+      bool need_upper_bound_check = false;
+      if (rep_->index_type == BlockBasedTableOptions::kHashSearch) {
+        need_upper_bound_check = PrefixExtractorChanged(
+            rep_->table_properties.get(), prefix_extractor);
+      }
+      iiter = NewIndexIterator(read_options, need_upper_bound_check,
+                               &iiter_on_stack, get_context, &lookup_context);
+      if (iiter != &iiter_on_stack) {
+        iiter_unique_ptr.reset(iiter);
+      }
+      iiter->Seek(key);
     }
 
     size_t ts_sz =
         rep_->internal_comparator.user_comparator()->timestamp_size();
     bool matched = false;  // if such user key mathced a key in SST
     bool done = false;
-    for (iiter->Seek(key); iiter->Valid() && !done; iiter->Next()) {
+    for (; iiter->Valid() && !done; iiter->Next()) {
       IndexValue v = iiter->value();
 
       bool not_exist_in_filter =
@@ -3828,7 +4128,8 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
   if (meta_block_name.starts_with(kFilterBlockPrefix) ||
       meta_block_name.starts_with(kFullFilterBlockPrefix) ||
       meta_block_name.starts_with(kPartitionedFilterBlockPrefix)||
-      meta_block_name.starts_with(kOtLexPdtFilterBlockPrefix)) {
+      meta_block_name.starts_with(kOtLexPdtFilterBlockPrefix) ||
+      meta_block_name.starts_with(kPartitionedOtLexPdtFilterBlockPrefix)) {
     return BlockType::kFilter;
   }
 
@@ -3953,6 +4254,11 @@ Status BlockBasedTable::CreateIndexReader(
                                              prefetch, pin, lookup_context,
                                              index_reader);
     }
+    case BlockBasedTableOptions::kTrieSearch: {
+      return TrieIndexReader::Create(this, prefetch_buffer, use_cache,
+                                     prefetch, pin, lookup_context,
+                                     index_reader);
+    }
     case BlockBasedTableOptions::kHashSearch: {
       std::unique_ptr<Block> meta_guard;
       std::unique_ptr<InternalIterator> meta_iter_guard;
@@ -10,6 +10,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -77,6 +78,7 @@ class BlockBasedTable : public TableReader {
  public:
  //wp
   static const std::string kOtLexPdtFilterBlockPrefix; //xp
+  static const std::string kPartitionedOtLexPdtFilterBlockPrefix;
   static const std::string kFilterBlockPrefix;
   static const std::string kFullFilterBlockPrefix;
   static const std::string kPartitionedFilterBlockPrefix;
@@ -121,6 +123,11 @@ class BlockBasedTable : public TableReader {
                       const bool need_upper_bound_check,
                       BlockCacheLookupContext* lookup_context) const;
 
+  // Whether the table may hold a key in [internal_key, upper_bound), as told
+  // by an OtLexPdt filter. True if the table has no such filter.
+  bool KeysMayExistInRange(const Slice& internal_key, const Slice& upper_bound,
+                           BlockCacheLookupContext* lookup_context) const;
+
   // Returns a new iterator over the table contents.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -246,6 +253,8 @@ class BlockBasedTable : public TableReader {
 
   friend class PartitionIndexReader;
 
+  friend class TrieIndexReader;
+
   friend class UncompressionDictReader;
 
  protected:
@@ -359,6 +368,8 @@ class BlockBasedTable : public TableReader {
   // PutDataBlockToCache(). After the call, the object will be invalid.
   // @param uncompression_dict Data for presetting the compression library's
   //    dictionary.
+  // @param from_persistent_cache The block was read from the persistent
+  //    cache, so it is not demoted there again when evicted.
   template <typename TBlocklike>
   Status PutDataBlockToCache(
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
@@ -367,7 +378,8 @@ class BlockBasedTable : public TableReader {
       BlockContents* raw_block_contents, CompressionType raw_block_comp_type,
       const UncompressionDict& uncompression_dict, SequenceNumber seq_no,
       MemoryAllocator* memory_allocator, BlockType block_type,
-      GetContext* get_context) const;
+      GetContext* get_context, const BlockHandle& handle,
+      bool from_persistent_cache) const;
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
@@ -451,6 +463,7 @@ class BlockBasedTable : public TableReader {
   void operator=(const TableReader&) = delete;
 
   friend class PartitionedFilterBlockReader;
+  friend class PartitionedOtLexPdtFilterBlockReader;
   friend class PartitionedFilterBlockTest;
 };
 
@@ -505,6 +518,23 @@ struct BlockBasedTable::Rep {
   char compressed_cache_key_prefix[kMaxCacheKeyPrefixSize];
   size_t compressed_cache_key_prefix_size = 0;
   PersistentCacheOptions persistent_cache_options;
+  // Where the data blocks evicted from the block cache go with
+  // persistent_cache_demote_on_evict, shared with the cached blocks that may
+  // outlive the table
+  struct DemoteTarget {
+    DemoteTarget(const PersistentCacheOptions& _cache_options,
+                 const std::string& _fname)
+        : cache_options(_cache_options), fname(_fname), table_closed(false) {}
+
+    PersistentCacheOptions cache_options;
+    std::string fname;
+    // Set when the table is closed. The blocks still cached are then dropped
+    // without being demoted: the block cache is usually cleared or destroyed
+    // after the tables at shutdown, and would otherwise write every block it
+    // holds to the persistent cache on the way out.
+    std::atomic<bool> table_closed;
+  };
+  std::shared_ptr<DemoteTarget> demote_target;
 
   // Footer contains the fixed table information
   Footer footer;
@@ -519,6 +549,7 @@ struct BlockBasedTable::Rep {
     kFullFilter,
     kBlockFilter,
     kPartitionedFilter,
+    kPartitionedOtLexPdtFilter,
   };
   FilterType filter_type;
   BlockHandle filter_handle;
@@ -573,6 +604,13 @@ struct BlockBasedTable::Rep {
                : global_seqno;
   }
 
+  // Whether the filter recorded in the meta-index is an ot lex pdt filter,
+  // which decides how its blocks are parsed
+  bool is_pdt_filter() const {
+    return filter_type == FilterType::kOtLexPdtFilter ||
+           filter_type == FilterType::kPartitionedOtLexPdtFilter;
+  }
+
   uint64_t cf_id_for_tracing() const {
     return table_properties ? table_properties->column_family_id
                             : rocksdb::TablePropertiesCollectorFactory::
@@ -604,7 +642,8 @@ class BlockBasedTableIterator : public InternalIteratorBase<TValue> {
                           bool check_filter, bool need_upper_bound_check,
                           const SliceTransform* prefix_extractor,
                           BlockType block_type, TableReaderCaller caller,
-                          size_t compaction_readahead_size = 0)
+                          size_t compaction_readahead_size = 0,
+                          bool check_range = false)
       : table_(table),
         read_options_(read_options),
         icomp_(icomp),
@@ -613,6 +652,7 @@ class BlockBasedTableIterator : public InternalIteratorBase<TValue> {
         pinned_iters_mgr_(nullptr),
         block_iter_points_to_real_block_(false),
         check_filter_(check_filter),
+        check_range_(check_range),
         need_upper_bound_check_(need_upper_bound_check),
         prefix_extractor_(prefix_extractor),
         block_type_(block_type),
@@ -715,6 +755,16 @@ class BlockBasedTableIterator : public InternalIteratorBase<TValue> {
     return true;
   }
 
+  bool CheckRangeMayExist(const Slice& ikey) {
+    if (check_range_ && read_options_.iterate_upper_bound != nullptr &&
+        !table_->KeysMayExistInRange(ikey, *read_options_.iterate_upper_bound,
+                                     &lookup_context_)) {
+      ResetDataIter();
+      return false;
+    }
+    return true;
+  }
+
   void ResetDataIter() {
     if (block_iter_points_to_real_block_) {
       if (pinned_iters_mgr_ != nullptr && pinned_iters_mgr_->PinningEnabled()) {
@@ -753,6 +803,9 @@ class BlockBasedTableIterator : public InternalIteratorBase<TValue> {
   // that block yet. A call to value() will trigger loading the block.
   bool is_at_first_key_from_index_ = false;
   bool check_filter_;
+  // Whether seeks are checked against the OtLexPdt filter for keys below
+  // iterate_upper_bound, see BlockBasedTable::KeysMayExistInRange()
+  bool check_range_;
   // TODO(Zhongyi): pick a better name
   bool need_upper_bound_check_;
   const SliceTransform* prefix_extractor_;
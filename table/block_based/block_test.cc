@@ -22,6 +22,7 @@
 #include "rocksdb/table.h"
 #include "table/block_based/block.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/elias_fano_block_handles.h"
 #include "table/format.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
@@ -613,6 +614,90 @@ TEST_P(IndexBlockTest, IndexValueEncodingTest) {
   delete iter;
 }
 
+TEST_P(IndexBlockTest, EliasFanoBlockHandlesTest) {
+  if (includeFirstKey()) {
+    // the handles section leaves no room for the first keys
+    return;
+  }
+  Random rnd(301);
+  Options options = Options();
+
+  std::vector<std::string> separators;
+  std::vector<BlockHandle> block_handles;
+  std::vector<std::string> first_keys;
+  const bool kUseDeltaEncoding = true;
+  const int kRestartInterval = 4;
+  BlockBuilder builder(kRestartInterval, kUseDeltaEncoding,
+                       useValueDeltaEncoding());
+  int num_records = 101;
+
+  GenerateRandomIndexEntries(&separators, &block_handles, &first_keys,
+                             num_records);
+  for (int i = 0; i < num_records; i++) {
+    const Slice empty;
+    builder.Add(separators[i], empty, &empty);
+  }
+  std::string rawblock;
+  EliasFanoBlockHandles::AppendTo(builder.Finish(), block_handles,
+                                  kRestartInterval, &rawblock);
+
+  // the handles are decoded in place, or from a copy when the block is not
+  // aligned
+  std::string unaligned(1, '\0');
+  unaligned.append(rawblock);
+  for (const Slice &data :
+       {Slice(rawblock), Slice(unaligned.data() + 1, rawblock.size())}) {
+    BlockContents contents;
+    contents.data = data;
+    Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+    ASSERT_EQ(static_cast<uint32_t>(
+                  (num_records + kRestartInterval - 1) / kRestartInterval),
+              reader.NumRestarts());
+
+    const bool kTotalOrderSeek = true;
+    const bool kIncludesSeq = true;
+    const bool kValueIsFull = !useValueDeltaEncoding();
+    Statistics *kNullStats = nullptr;
+    IndexBlockIter iter;
+    reader.NewIndexIterator(options.comparator, options.comparator, &iter,
+                            kNullStats, kTotalOrderSeek, includeFirstKey(),
+                            kIncludesSeq, kValueIsFull);
+    iter.SeekToFirst();
+    for (int index = 0; index < num_records; ++index) {
+      ASSERT_TRUE(iter.Valid());
+      EXPECT_EQ(separators[index], iter.key().ToString());
+      EXPECT_EQ(block_handles[index].offset(), iter.value().handle.offset());
+      EXPECT_EQ(block_handles[index].size(), iter.value().handle.size());
+      iter.Next();
+    }
+    ASSERT_FALSE(iter.Valid());
+
+    iter.SeekToLast();
+    for (int index = num_records - 1; index >= 0; --index) {
+      ASSERT_TRUE(iter.Valid());
+      EXPECT_EQ(separators[index], iter.key().ToString());
+      EXPECT_EQ(block_handles[index].offset(), iter.value().handle.offset());
+      iter.Prev();
+    }
+    ASSERT_FALSE(iter.Valid());
+
+    for (int i = 0; i < num_records * 2; i++) {
+      int index = rnd.Uniform(num_records);
+      iter.Seek(separators[index]);
+      ASSERT_TRUE(iter.Valid());
+      EXPECT_EQ(separators[index], iter.key().ToString());
+      EXPECT_EQ(block_handles[index].offset(), iter.value().handle.offset());
+      EXPECT_EQ(block_handles[index].size(), iter.value().handle.size());
+      if (index > 0) {
+        iter.Prev();
+        ASSERT_TRUE(iter.Valid());
+        EXPECT_EQ(block_handles[index - 1].offset(),
+                  iter.value().handle.offset());
+      }
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(P, IndexBlockTest,
                         ::testing::Values(std::make_tuple(false, false),
                                           std::make_tuple(false, true),
@@ -15,11 +15,13 @@ namespace rocksdb {
 
 const int kDataBlockIndexTypeBitShift = 31;
 
-// 0x7FFFFFFF
-const uint32_t kMaxNumRestarts = (1u << kDataBlockIndexTypeBitShift) - 1u;
+const int kBlockHandlesBitShift = 30;
 
-// 0x7FFFFFFF
-const uint32_t kNumRestartsMask = (1u << kDataBlockIndexTypeBitShift) - 1u;
+// 0x3FFFFFFF
+const uint32_t kMaxNumRestarts = (1u << kBlockHandlesBitShift) - 1u;
+
+// 0x3FFFFFFF
+const uint32_t kNumRestartsMask = (1u << kBlockHandlesBitShift) - 1u;
 
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
@@ -56,4 +58,12 @@ void UnPackIndexTypeAndNumRestarts(
   }
 }
 
+uint32_t PackBlockHandlesFlag(uint32_t block_footer) {
+  return block_footer | 1u << kBlockHandlesBitShift;
+}
+
+bool HasBlockHandlesFlag(uint32_t block_footer) {
+  return (block_footer & 1u << kBlockHandlesBitShift) != 0;
+}
+
 }  // namespace rocksdb
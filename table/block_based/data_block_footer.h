@@ -22,4 +22,11 @@ void UnPackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType* index_type,
     uint32_t* num_restarts);
 
+// Index blocks whose block handles are kept in an EliasFanoBlockHandles
+// section rather than in the values of the entries have this flag set in
+// their footer
+uint32_t PackBlockHandlesFlag(uint32_t block_footer);
+
+bool HasBlockHandlesFlag(uint32_t block_footer);
+
 }  // namespace rocksdb
@@ -0,0 +1,97 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/elias_fano_block_handles.h"
+
+#include <string.h>
+#include <sstream>
+
+#include "table/block_based/data_block_footer.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+namespace {
+const size_t kSectionTrailerSize = 2 * sizeof(uint32_t);
+
+size_t AlignedSectionStart(size_t restarts_end) {
+  return (restarts_end + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+}
+}  // namespace
+
+void EliasFanoBlockHandles::AppendTo(const Slice& block,
+                                     const std::vector<BlockHandle>& handles,
+                                     uint32_t restart_interval,
+                                     std::string* result) {
+  assert(block.size() >= sizeof(uint32_t));
+  const size_t restarts_end = block.size() - sizeof(uint32_t);
+  const uint32_t footer = DecodeFixed32(block.data() + restarts_end);
+
+  EliasFanoBlockHandles section;
+  section.num_handles_ = handles.size();
+  section.restart_interval_ = restart_interval;
+  if (!handles.empty()) {
+    const BlockHandle& last = handles.back();
+    rocksdb::succinct::elias_fano::elias_fano_builder extents_builder(
+        last.offset() + last.size(), 2 * handles.size());
+    for (const BlockHandle& handle : handles) {
+      extents_builder.push_back(handle.offset());
+      extents_builder.push_back(handle.offset() + handle.size());
+    }
+    rocksdb::succinct::elias_fano(&extents_builder, false)
+        .swap(section.extents_);
+  }
+  std::ostringstream frozen;
+  rocksdb::succinct::mapper::freeze(
+      section, frozen, rocksdb::succinct::mapper::freeze_flags::aligned);
+
+  result->assign(block.data(), restarts_end);
+  result->resize(AlignedSectionStart(restarts_end), '\0');
+  result->append(frozen.str());
+  PutFixed32(result, static_cast<uint32_t>(restarts_end));
+  PutFixed32(result, PackBlockHandlesFlag(footer));
+}
+
+Status EliasFanoBlockHandles::Open(
+    const Slice& block, uint32_t* restarts_end,
+    std::unique_ptr<EliasFanoBlockHandles>* handles) {
+  if (block.size() < kSectionTrailerSize) {
+    return Status::Corruption("bad block handles section");
+  }
+  const size_t section_end = block.size() - kSectionTrailerSize;
+  const uint32_t end = DecodeFixed32(block.data() + section_end);
+  const size_t section_start = AlignedSectionStart(end);
+  if (section_start > section_end) {
+    return Status::Corruption("bad block handles section");
+  }
+  std::unique_ptr<EliasFanoBlockHandles> result(new EliasFanoBlockHandles());
+  const char* base = block.data() + section_start;
+  const size_t section_size = section_end - section_start;
+  if (reinterpret_cast<uintptr_t>(base) % sizeof(uint64_t) != 0) {
+    size_t num_words =
+        (section_size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    result->aligned_copy_.reset(new uint64_t[num_words]);
+    memcpy(result->aligned_copy_.get(), base, section_size);
+    base = reinterpret_cast<const char*>(result->aligned_copy_.get());
+  }
+  size_t mapped = rocksdb::succinct::mapper::map(*result, base);
+  if (mapped > section_size || result->restart_interval_ == 0) {
+    return Status::Corruption("truncated block handles section");
+  }
+  *restarts_end = end;
+  *handles = std::move(result);
+  return Status::OK();
+}
+
+size_t EliasFanoBlockHandles::ApproximateMemoryUsage() const {
+  size_t usage = sizeof(*this);
+  if (aligned_copy_ != nullptr) {
+    usage += rocksdb::succinct::mapper::size_of(
+        const_cast<EliasFanoBlockHandles&>(*this));
+  }
+  return usage;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,87 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "succinct/elias_fano.hpp"
+#include "succinct/mapper.hpp"
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+
+namespace rocksdb {
+
+// The block handles of an index block, kept apart from its entries as an
+// Elias-Fano sequence of the start and end offsets of the blocks, so the
+// handle of any entry is decoded with two O(1) selects instead of walking
+// the delta encoded values of its restart interval. The entries of such a
+// block have empty values, and the sequence sits between the restart array
+// and the footer:
+// +------------------------------------------------------------------+
+// | entries | restart array | padding to a multiple of 8 bytes         |
+// +------------------------------------------------------------------+
+// | EliasFanoBlockHandles frozen with mapper::freeze_flags::aligned  |
+// +------------------------------------------------------------------+
+// | end of the restart array (4 bytes) | footer (4 bytes)            |
+// +------------------------------------------------------------------+
+// The footer has the flag of PackBlockHandlesFlag() set.
+class EliasFanoBlockHandles {
+ public:
+  EliasFanoBlockHandles() : num_handles_(0), restart_interval_(0) {}
+
+  // No copying allowed
+  EliasFanoBlockHandles(const EliasFanoBlockHandles&) = delete;
+  void operator=(const EliasFanoBlockHandles&) = delete;
+
+  // Stores into *result the contents of block, as finished by a BlockBuilder
+  // restarting every restart_interval entries, followed by handles, the
+  // handle of each of its entries in order.
+  static void AppendTo(const Slice& block,
+                       const std::vector<BlockHandle>& handles,
+                       uint32_t restart_interval, std::string* result);
+
+  // Maps the handles of block, which must have the flag of
+  // PackBlockHandlesFlag() set. The handles point into block, which must
+  // outlive them, unless block is not 8-byte aligned, in which case they are
+  // copied. *restarts_end is set to the end of the restart array.
+  static Status Open(const Slice& block, uint32_t* restarts_end,
+                     std::unique_ptr<EliasFanoBlockHandles>* handles);
+
+  uint64_t size() const { return num_handles_; }
+
+  // Number of entries between two restart points of the block
+  uint64_t restart_interval() const { return restart_interval_; }
+
+  BlockHandle Get(uint64_t i) const {
+    assert(i < num_handles_);
+    uint64_t offset = extents_.select(2 * i);
+    return BlockHandle(offset, extents_.select(2 * i + 1) - offset);
+  }
+
+  size_t ApproximateMemoryUsage() const;
+
+  template <typename Visitor>
+  void map(Visitor& visit) {
+    visit(num_handles_, "num_handles_")(restart_interval_,
+                                        "restart_interval_")(extents_,
+                                                             "extents_");
+  }
+
+ private:
+  uint64_t num_handles_;
+  uint64_t restart_interval_;
+  // start and end offset of every block
+  rocksdb::succinct::elias_fano extents_;
+  // section copied to be mapped at an aligned address
+  std::unique_ptr<uint64_t[]> aligned_copy_;
+};
+
+}  // namespace rocksdb
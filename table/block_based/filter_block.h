@@ -55,6 +55,7 @@ class FilterBlockBuilder {
   virtual ~FilterBlockBuilder() {}
 
   virtual bool IsBlockBased() = 0;                    // If is blockbased filter
+  virtual bool IsOtLexPdt() { return false; }        // If is ot lex pdt filter
   virtual void StartBlock(uint64_t block_offset) = 0;  // Start new block filter
   virtual void Add(const Slice& key) = 0;      // Add a key to current filter
   virtual size_t NumAdded() const = 0;         // Number of keys added
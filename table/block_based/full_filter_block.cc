@@ -5,6 +5,9 @@
 
 #include "table/block_based/full_filter_block.h"
 
+#include <algorithm>
+#include <array>
+
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
 #ifdef OS_FREEBSD
 #include <malloc_np.h>
@@ -17,14 +20,46 @@
 #include "port/port.h"
 #include "rocksdb/filter_policy.h"
 #include "table/block_based/block_based_table_reader.h"
+#include "table/full_filter_bits_builder.h"
 #include "util/coding.h"
 
 namespace rocksdb {
+OtLexPdtFilterBlockBuilder::OtLexPdtFilterBlockBuilder(
+    FilterBitsBuilder* filter_bits_builder, bool build_block_index)
+    : num_added_(0),
+      block_index_builder_(nullptr),
+      in_block_(false),
+      block_offset_(0),
+      block_first_rank_(0) {
+  filter_bits_builder_.reset(filter_bits_builder);
+  if (build_block_index) {
+    block_index_builder_ =
+        static_cast<OtLexPdtBloomBitsBuilder*>(filter_bits_builder);
+  }
+}
+
   void OtLexPdtFilterBlockBuilder::Add(const Slice& key) {
 //  fprintf(stderr, "before Add() in Otpdtblockbuilder() wpquc\n");
   AddKey(key);
 }
 
+void OtLexPdtFilterBlockBuilder::StartBlock(uint64_t block_offset) {
+  if (block_index_builder_ == nullptr) {
+    return;
+  }
+  // Called with the offset of the next data block each time one is written,
+  // so the previous block ends right before it, minus its trailer.
+  if (in_block_ && block_offset > block_offset_ + kBlockTrailerSize) {
+    block_index_builder_->AddDataBlock(
+        block_first_rank_, block_offset_,
+        block_offset - block_offset_ - kBlockTrailerSize);
+  }
+  in_block_ = true;
+  block_offset_ = block_offset;
+  // the trie rank of the next new key
+  block_first_rank_ = block_index_builder_->NumKeys();
+}
+
 inline void OtLexPdtFilterBlockBuilder::AddKey(const Slice& key) {
 //  fprintf(stderr, "before AddKey() in Otpdtblockbuilder() tyzpdk\n");
   if (filter_bits_builder_ == nullptr) {
@@ -124,6 +159,89 @@ Slice FullFilterBlockBuilder::Finish(const BlockHandle& /*tmp*/,
   return Slice();
 }
 
+namespace {
+// Trie bytes per distinct key on top of its unshared bytes: the node label
+// length and terminator, the branching char and the node's bits in the
+// tree structure. Rounded up, keys with long shared prefixes usually cost
+// less.
+const uint64_t kOtLexPdtProjectedBytesPerKey = 4;
+}  // namespace
+
+AdaptiveFilterBlockBuilder::AdaptiveFilterBlockBuilder(
+    FullFilterBlockBuilder* full_filter_builder,
+    OtLexPdtFilterBlockBuilder* pdt_filter_builder, double max_size_ratio)
+    : full_filter_builder_(full_filter_builder),
+      pdt_filter_builder_(pdt_filter_builder),
+      max_size_ratio_(max_size_ratio),
+      uses_pdt_(false),
+      num_distinct_keys_(0),
+      unshared_bytes_(0) {
+  assert(full_filter_builder != nullptr);
+  assert(pdt_filter_builder != nullptr);
+}
+
+void AdaptiveFilterBlockBuilder::StartBlock(uint64_t block_offset) {
+  full_filter_builder_->StartBlock(block_offset);
+  if (max_size_ratio_ > 0) {
+    pdt_filter_builder_->StartBlock(block_offset);
+  }
+}
+
+void AdaptiveFilterBlockBuilder::Add(const Slice& key) {
+  full_filter_builder_->Add(key);
+  if (max_size_ratio_ <= 0) {
+    // the trie would never be kept, don't buffer the keys for it
+    return;
+  }
+  pdt_filter_builder_->Add(key);
+  const Slice last_key(last_key_str_);
+  if (num_distinct_keys_ > 0 && last_key == key) {
+    return;
+  }
+  size_t shared = 0;
+  const size_t min_length = std::min(last_key.size(), key.size());
+  while (shared < min_length && last_key[shared] == key[shared]) {
+    shared++;
+  }
+  num_distinct_keys_++;
+  unshared_bytes_ += key.size() - shared;
+  last_key_str_.assign(key.data(), key.size());
+}
+
+size_t AdaptiveFilterBlockBuilder::NumAdded() const {
+  size_t num_added = full_filter_builder_->NumAdded();
+  if (pdt_filter_builder_ != nullptr) {
+    num_added = std::max(num_added, pdt_filter_builder_->NumAdded());
+  }
+  return num_added;
+}
+
+uint64_t AdaptiveFilterBlockBuilder::ProjectedOtLexPdtSize() const {
+  return unshared_bytes_ + num_distinct_keys_ * kOtLexPdtProjectedBytesPerKey +
+         kOtLexPdtMetadataLen;
+}
+
+Slice AdaptiveFilterBlockBuilder::Finish(const BlockHandle& tmp,
+                                         Status* status) {
+  Slice full_filter = full_filter_builder_->Finish(tmp, status);
+  uses_pdt_ = false;
+  if (!status->ok() || max_size_ratio_ <= 0 || num_distinct_keys_ == 0) {
+    return full_filter;
+  }
+  const double budget = max_size_ratio_ * full_filter.size();
+  if (static_cast<double>(ProjectedOtLexPdtSize()) <= budget) {
+    Status pdt_status;
+    Slice pdt_filter = pdt_filter_builder_->Finish(tmp, &pdt_status);
+    if (pdt_status.ok() && static_cast<double>(pdt_filter.size()) <= budget) {
+      uses_pdt_ = true;
+      return pdt_filter;
+    }
+  }
+  // drop the buffered keys, the full filter is kept
+  pdt_filter_builder_.reset();
+  return full_filter;
+}
+
 //xp
 OtLexPdtFilterBlockReader::OtLexPdtFilterBlockReader(const BlockBasedTable* t,
     CachableEntry<ParsedFullFilterBlock>&& filter_block)
@@ -186,7 +304,19 @@ bool OtLexPdtFilterBlockReader::PrefixMayMatch(
   (void)block_offset;
 #endif
   assert(block_offset == kNotValid);
-  return MayMatch(prefix, no_io, get_context, lookup_context);
+  // The trie holds whole keys, the prefix may only be the start of some
+  CachableEntry<ParsedFullFilterBlock> filter_block;
+  const OtLexPdtBloomBitsReader* const bits_reader = GetOtLexPdtBitsReader(
+      no_io, get_context, lookup_context, &filter_block);
+  if (bits_reader == nullptr) {
+    return true;
+  }
+  if (bits_reader->PrefixMayExist(prefix)) {
+    PERF_COUNTER_ADD(bloom_sst_hit_count, 1);
+    return true;
+  }
+  PERF_COUNTER_ADD(bloom_sst_miss_count, 1);
+  return false;
 }
 
 bool OtLexPdtFilterBlockReader::MayMatch(
@@ -329,13 +459,115 @@ size_t OtLexPdtFilterBlockReader::ApproximateMemoryUsage() const {
   return usage;
 }
 
+bool OtLexPdtFilterBlockReader::InitBlockIndexIterator(
+    bool no_io, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context,
+    OtLexPdtBlockIndexIterator* iter) const {
+  CachableEntry<ParsedFullFilterBlock> filter_block;
+  const OtLexPdtBloomBitsReader* const bits_reader = GetOtLexPdtBitsReader(
+      no_io, get_context, lookup_context, &filter_block);
+  if (bits_reader == nullptr || !bits_reader->HasBlockIndex()) {
+    return false;
+  }
+
+  iter->Init(std::move(filter_block), bits_reader,
+             table()
+                 ->get_rep()
+                 ->internal_comparator.user_comparator()
+                 ->timestamp_size());
+  return true;
+}
+
+bool OtLexPdtFilterBlockReader::KeysMayExistInRange(
+    const Slice& lower, const Slice* upper, bool no_io,
+    BlockCacheLookupContext* lookup_context) const {
+  CachableEntry<ParsedFullFilterBlock> filter_block;
+  const OtLexPdtBloomBitsReader* const bits_reader = GetOtLexPdtBitsReader(
+      no_io, nullptr /* get_context */, lookup_context, &filter_block);
+  if (bits_reader == nullptr) {
+    return true;
+  }
+  Statistics* const statistics = table()->get_rep()->ioptions.statistics;
+  RecordTick(statistics, BLOOM_FILTER_RANGE_CHECKED);
+  if (bits_reader->RangeMayExist(lower, upper)) {
+    PERF_COUNTER_ADD(bloom_sst_hit_count, 1);
+    return true;
+  }
+  RecordTick(statistics, BLOOM_FILTER_RANGE_USEFUL);
+  PERF_COUNTER_ADD(bloom_sst_miss_count, 1);
+  return false;
+}
+
+const OtLexPdtBloomBitsReader*
+OtLexPdtFilterBlockReader::GetOtLexPdtBitsReader(
+    bool no_io, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context,
+    CachableEntry<ParsedFullFilterBlock>* filter_block) const {
+  const BlockBasedTable::Rep* const rep = table()->get_rep();
+  // only the built-in policy reads the filter with OtLexPdtBloomBitsReader
+  if (rep->filter_policy == nullptr ||
+      strcmp(rep->filter_policy->Name(), kBuiltinBloomFilterPolicyName) != 0) {
+    return nullptr;
+  }
+
+  const Status s =
+      GetOrReadFilterBlock(no_io, get_context, lookup_context, filter_block);
+  if (!s.ok()) {
+    return nullptr;
+  }
+
+  assert(filter_block->GetValue());
+
+  return static_cast<const OtLexPdtBloomBitsReader*>(
+      filter_block->GetValue()->filter_bits_reader());
+}
+
+void OtLexPdtBlockIndexIterator::Init(
+    CachableEntry<ParsedFullFilterBlock>&& filter_block,
+    const OtLexPdtBloomBitsReader* bits_reader, size_t ts_sz) {
+  assert(bits_reader->HasBlockIndex());
+  filter_block_ = std::move(filter_block);
+  bits_reader_ = bits_reader;
+  ts_sz_ = ts_sz;
+  num_blocks_ = bits_reader_->block_index().NumBlocks();
+  block_ = num_blocks_;
+  status_ = Status::OK();
+}
+
+void OtLexPdtBlockIndexIterator::Seek(const Slice& target) {
+  const Slice user_key =
+      StripTimestampFromUserKey(ExtractUserKey(target), ts_sz_);
+  const size_t rank = bits_reader_->KeyRank(user_key);
+  if (rank == kOtLexPdtNotFound) {
+    PERF_COUNTER_ADD(bloom_sst_miss_count, 1);
+    block_ = num_blocks_;
+  } else {
+    PERF_COUNTER_ADD(bloom_sst_hit_count, 1);
+    block_ = bits_reader_->block_index().BlockOf(rank);
+  }
+}
+
+IndexValue OtLexPdtBlockIndexIterator::value() const {
+  assert(Valid());
+  uint64_t offset = 0;
+  uint64_t size = 0;
+  bits_reader_->block_index().GetBlock(block_, &offset, &size);
+  return IndexValue(BlockHandle(offset, size), Slice());
+}
+
 bool OtLexPdtFilterBlockReader::RangeMayExist(
     const Slice* iterate_upper_bound, const Slice& user_key,
     const SliceTransform* prefix_extractor, const Comparator* comparator,
     const Slice* const const_ikey_ptr, bool* filter_checked,
     bool need_upper_bound_check, BlockCacheLookupContext* lookup_context) {
-
-//  return true;
+  // The trie orders keys bytewise, and holds them without timestamp
+  if (iterate_upper_bound != nullptr && comparator == BytewiseComparator() &&
+      !KeysMayExistInRange(user_key, iterate_upper_bound, false /* no_io */,
+                           lookup_context)) {
+    // counted as a range check, not a prefix one
+    *filter_checked = false;
+    return false;
+  }
   if (!prefix_extractor || !prefix_extractor->InDomain(user_key)) {
     *filter_checked = false;
     return true;
@@ -391,7 +623,8 @@ bool OtLexPdtFilterBlockReader::IsFilterCompatible(
 // ==============
 
 FullFilterBlockReader::FullFilterBlockReader(
-    const BlockBasedTable* t, CachableEntry<BlockContents>&& filter_block)
+    const BlockBasedTable* t,
+    CachableEntry<ParsedFullFilterBlock>&& filter_block)
     : FilterBlockReaderCommon(t, std::move(filter_block)) {
   const SliceTransform* const prefix_extractor = table_prefix_extractor();
   if (prefix_extractor) {
@@ -423,7 +656,7 @@ std::unique_ptr<FilterBlockReader> FullFilterBlockReader::Create(
   assert(table->get_rep());
   assert(!pin || prefetch);
 
-  CachableEntry<BlockContents> filter_block;
+  CachableEntry<ParsedFullFilterBlock> filter_block;
   if (prefetch || !use_cache) {
     const Status s = ReadFilterBlock(table, prefetch_buffer, ReadOptions(),
                                      use_cache, nullptr /* get_context */,
@@ -456,7 +689,7 @@ bool FullFilterBlockReader::PrefixMayMatch(
 bool FullFilterBlockReader::MayMatch(
     const Slice& entry, bool no_io, GetContext* get_context,
     BlockCacheLookupContext* lookup_context) const {
-  CachableEntry<BlockContents> filter_block;
+  CachableEntry<ParsedFullFilterBlock> filter_block;
 
   const Status s =
       GetOrReadFilterBlock(no_io, get_context, lookup_context, &filter_block);
@@ -466,15 +699,10 @@ bool FullFilterBlockReader::MayMatch(
 
   assert(filter_block.GetValue());
 
-  if (filter_block.GetValue()->data.size() != 0) {
-    assert(table());
-    assert(table()->get_rep());
-
-    std::unique_ptr<FilterBitsReader> filter_bits_reader(
-        table()->get_rep()->filter_policy->GetFilterBitsReader(
-            filter_block.GetValue()->data,false));
-    assert(filter_bits_reader != nullptr);
+  FilterBitsReader* const filter_bits_reader =
+      filter_block.GetValue()->filter_bits_reader();
 
+  if (filter_bits_reader) {
     if (filter_bits_reader->MayMatch(entry)) {
       PERF_COUNTER_ADD(bloom_sst_hit_count, 1);
       return true;
@@ -518,7 +746,7 @@ void FullFilterBlockReader::PrefixesMayMatch(
 void FullFilterBlockReader::MayMatch(
     MultiGetRange* range, bool no_io,
     BlockCacheLookupContext* lookup_context) const {
-  CachableEntry<BlockContents> filter_block;
+  CachableEntry<ParsedFullFilterBlock> filter_block;
 
   const Status s = GetOrReadFilterBlock(no_io, range->begin()->get_context,
                                         lookup_context, &filter_block);
@@ -528,18 +756,13 @@ void FullFilterBlockReader::MayMatch(
 
   assert(filter_block.GetValue());
 
-  if (filter_block.GetValue()->data.size() == 0) {
+  FilterBitsReader* const filter_bits_reader =
+      filter_block.GetValue()->filter_bits_reader();
+
+  if (!filter_bits_reader) {
     return;
   }
 
-  assert(table());
-  assert(table()->get_rep());
-
-  std::unique_ptr<FilterBitsReader> filter_bits_reader(
-      table()->get_rep()->filter_policy->GetFilterBitsReader(
-          filter_block.GetValue()->data,false));
-  assert(filter_bits_reader != nullptr);
-
   // We need to use an array instead of autovector for may_match since
   // &may_match[0] doesn't work for autovector<bool> (compiler error). So
   // declare both keys and may_match as arrays, which is also slightly less
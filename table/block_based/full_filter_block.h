@@ -17,6 +17,7 @@
 #include "rocksdb/slice_transform.h"
 #include "table/block_based/filter_block_reader_common.h"
 #include "table/format.h"
+#include "table/internal_iterator.h"
 #include "util/hash.h"
 
 namespace rocksdb {
@@ -24,6 +25,8 @@ namespace rocksdb {
 class FilterPolicy;
 class FilterBitsBuilder;
 class FilterBitsReader;
+class OtLexPdtBloomBitsBuilder;
+class OtLexPdtBloomBitsReader;
 
 //xp
 // A compacted trie stored in a particular Table is used to construct an
@@ -46,11 +49,13 @@ class FilterBitsReader;
 
 class OtLexPdtFilterBlockBuilder : public FilterBlockBuilder {
  public:
+  // If build_block_index is set, the data block boundaries reported through
+  // StartBlock() are stored with the trie, see OtLexPdtBlockIndex. This needs
+  // filter_bits_builder to be an OtLexPdtBloomBitsBuilder, the table keys to
+  // be added in bytewise order, and data blocks to be laid out back to back
+  // (i.e. no block_align).
   explicit OtLexPdtFilterBlockBuilder(
-      FilterBitsBuilder* filter_bits_builder)
-      :num_added_(0) {
-    filter_bits_builder_.reset(filter_bits_builder);
-  }
+      FilterBitsBuilder* filter_bits_builder, bool build_block_index = false);
 
   // No copying allowed
   OtLexPdtFilterBlockBuilder(const OtLexPdtFilterBlockBuilder&) = delete;
@@ -62,7 +67,8 @@ class OtLexPdtFilterBlockBuilder : public FilterBlockBuilder {
 
   virtual const char* Name() const { return "otlexpdtfilter."; }
   virtual bool IsBlockBased() override { return false; }
-  virtual void StartBlock(uint64_t /*block_offset*/) override {}
+  virtual bool IsOtLexPdt() override { return true; }
+  virtual void StartBlock(uint64_t block_offset) override;
   virtual void Add(const Slice& key) override;
   virtual size_t NumAdded() const override { return num_added_; }
   virtual Slice Finish(const BlockHandle& tmp, Status* status) override;
@@ -78,7 +84,62 @@ class OtLexPdtFilterBlockBuilder : public FilterBlockBuilder {
   // should NOT dereference them.
   uint32_t num_added_;
   std::unique_ptr<const char[]> filter_data_;
-  //TODO vector for all boundary keys in this Table
+
+  // state of the block index, block_index_builder_ is nullptr (and the rest
+  // unused) unless the block index is built
+  OtLexPdtBloomBitsBuilder* block_index_builder_;
+  bool in_block_;
+  uint64_t block_offset_;
+  uint64_t block_first_rank_;
+};
+
+// Walks the data blocks that may hold a key, using the block index stored
+// in an ot lex pdt filter block instead of the index block. Seek() looks the
+// user key up in the trie and positions the iterator at the first data block
+// that may hold it, or makes it invalid when the key is not in the table;
+// Next() moves on to the following data blocks, for keys whose versions span
+// several blocks. There are no separator keys, so key() is not supported and
+// this is only meant for point lookups.
+class OtLexPdtBlockIndexIterator : public InternalIteratorBase<IndexValue> {
+ public:
+  OtLexPdtBlockIndexIterator()
+      : bits_reader_(nullptr), ts_sz_(0), block_(0), num_blocks_(0) {}
+
+  // bits_reader belongs to filter_block, which is kept pinned as long as
+  // this iterator lives
+  void Init(CachableEntry<ParsedFullFilterBlock>&& filter_block,
+            const OtLexPdtBloomBitsReader* bits_reader, size_t ts_sz);
+
+  bool Valid() const override { return block_ < num_blocks_; }
+  void SeekToFirst() override { block_ = 0; }
+  void SeekToLast() override { block_ = num_blocks_ > 0 ? num_blocks_ - 1 : 0; }
+  void Seek(const Slice& target) override;
+  void SeekForPrev(const Slice& /*target*/) override {
+    status_ = Status::NotSupported("SeekForPrev() on a pdt block index");
+    block_ = num_blocks_;
+  }
+  void Next() override {
+    assert(Valid());
+    ++block_;
+  }
+  void Prev() override {
+    assert(Valid());
+    block_ = block_ > 0 ? block_ - 1 : num_blocks_;
+  }
+  Slice key() const override {
+    assert(false);
+    return Slice();
+  }
+  IndexValue value() const override;
+  Status status() const override { return status_; }
+
+ private:
+  CachableEntry<ParsedFullFilterBlock> filter_block_;
+  const OtLexPdtBloomBitsReader* bits_reader_;
+  size_t ts_sz_;
+  uint64_t block_;
+  uint64_t num_blocks_;
+  Status status_;
 };
 
 // A FilterBlockReader is used to parse filter from SST table.
@@ -117,7 +178,23 @@ class OtLexPdtFilterBlockReader
 
   size_t ApproximateMemoryUsage() const override;
 
-  //TODO
+  // Sets up *iter to find data blocks through the block index stored with
+  // the filter. Returns false, leaving *iter alone, if the filter block has
+  // no block index or cannot be read (e.g. no_io and not cached).
+  bool InitBlockIndexIterator(bool no_io, GetContext* get_context,
+                              BlockCacheLookupContext* lookup_context,
+                              OtLexPdtBlockIndexIterator* iter) const;
+
+  // Whether any key of the table lies in [lower, *upper), or is not less
+  // than lower if upper is nullptr. Unlike a Bloom filter the answer is
+  // exact, but true is returned whenever the filter cannot be consulted.
+  // Only a consulted filter counts in BLOOM_FILTER_RANGE_CHECKED/USEFUL.
+  bool KeysMayExistInRange(const Slice& lower, const Slice* upper,
+                           bool no_io,
+                           BlockCacheLookupContext* lookup_context) const;
+
+  // With a bytewise comparator, [user_key, iterate_upper_bound) is checked
+  // directly, no matter the prefix extractor
   bool RangeMayExist(const Slice* iterate_upper_bound, const Slice& user_key,
                      const SliceTransform* prefix_extractor,
                      const Comparator* comparator,
@@ -136,6 +213,14 @@ class OtLexPdtFilterBlockReader
   bool IsFilterCompatible(const Slice* iterate_upper_bound, const Slice& prefix,
                           const Comparator* comparator) const;
 
+  // Returns the bits reader of the filter block, which is pinned in
+  // *filter_block, or nullptr if the table does not read its filter with
+  // OtLexPdtBloomBitsReader or the block cannot be read
+  const OtLexPdtBloomBitsReader* GetOtLexPdtBitsReader(
+      bool no_io, GetContext* get_context,
+      BlockCacheLookupContext* lookup_context,
+      CachableEntry<ParsedFullFilterBlock>* filter_block) const;
+
 // private:
   bool full_length_enabled_;
   size_t prefix_extractor_full_length_;
@@ -194,12 +279,55 @@ class FullFilterBlockBuilder : public FilterBlockBuilder {
   void operator=(const FullFilterBlockBuilder&);
 };
 
+// Feeds the keys of a table to both a full filter builder and an ot lex pdt
+// filter builder, and keeps the trie only if it is worth its size: at most
+// max_size_ratio times the size of the full filter. Building the trie is
+// the expensive part, so it is skipped when its size projected from the
+// keys already misses that budget. IsOtLexPdt() tells which filter
+// Finish() returned.
+class AdaptiveFilterBlockBuilder : public FilterBlockBuilder {
+ public:
+  // Takes ownership of both builders
+  AdaptiveFilterBlockBuilder(FullFilterBlockBuilder* full_filter_builder,
+                             OtLexPdtFilterBlockBuilder* pdt_filter_builder,
+                             double max_size_ratio);
+
+  // No copying allowed
+  AdaptiveFilterBlockBuilder(const AdaptiveFilterBlockBuilder&) = delete;
+  void operator=(const AdaptiveFilterBlockBuilder&) = delete;
+
+  virtual bool IsBlockBased() override { return false; }
+  virtual bool IsOtLexPdt() override { return uses_pdt_; }
+  virtual void StartBlock(uint64_t block_offset) override;
+  virtual void Add(const Slice& key) override;
+  virtual size_t NumAdded() const override;
+  virtual Slice Finish(const BlockHandle& tmp, Status* status) override;
+  using FilterBlockBuilder::Finish;
+
+  // Estimated trie size, from the distinct keys added so far and the bytes
+  // they don't share with the key before them
+  uint64_t ProjectedOtLexPdtSize() const;
+
+ private:
+  std::unique_ptr<FullFilterBlockBuilder> full_filter_builder_;
+  std::unique_ptr<OtLexPdtFilterBlockBuilder> pdt_filter_builder_;
+  const double max_size_ratio_;
+  bool uses_pdt_;
+
+  uint64_t num_distinct_keys_;
+  uint64_t unshared_bytes_;
+  std::string last_key_str_;
+};
+
 // A FilterBlockReader is used to parse filter from SST table.
-// KeyMayMatch and PrefixMayMatch would trigger filter checking
-class FullFilterBlockReader : public FilterBlockReaderCommon<BlockContents> {
+// KeyMayMatch and PrefixMayMatch would trigger filter checking. The filter
+// bits reader is parsed along with the block, so it is cached with it and
+// shared by all lookups instead of being created for each of them.
+class FullFilterBlockReader
+    : public FilterBlockReaderCommon<ParsedFullFilterBlock> {
  public:
   FullFilterBlockReader(const BlockBasedTable* t,
-                        CachableEntry<BlockContents>&& filter_block);
+                        CachableEntry<ParsedFullFilterBlock>&& filter_block);
 
   static std::unique_ptr<FilterBlockReader> Create(
       const BlockBasedTable* table, FilePrefetchBuffer* prefetch_buffer,
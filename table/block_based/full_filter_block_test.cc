@@ -5,6 +5,8 @@
 
 #include "table/block_based/full_filter_block.h"
 
+#include <algorithm>
+
 #include "rocksdb/filter_policy.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/full_filter_bits_builder.h"
@@ -130,9 +132,10 @@ TEST_F(PluginFullFilterBlockTest, PluginEmptyBuilder) {
   Slice slice = builder.Finish();
   ASSERT_EQ("", EscapeString(slice));
 
-  CachableEntry<BlockContents> block(
-      new BlockContents(slice), nullptr /* cache */, nullptr /* cache_handle */,
-      true /* own_value */);
+  CachableEntry<ParsedFullFilterBlock> block(
+      new ParsedFullFilterBlock(table_options_.filter_policy.get(),
+                                BlockContents(slice), false /* is_pdt */),
+      nullptr /* cache */, nullptr /* cache_handle */, true /* own_value */);
 
   FullFilterBlockReader reader(table_.get(), std::move(block));
   // Remain same symantic with blockbased filter
@@ -153,9 +156,10 @@ TEST_F(PluginFullFilterBlockTest, PluginSingleChunk) {
   builder.Add("hello");
   Slice slice = builder.Finish();
 
-  CachableEntry<BlockContents> block(
-      new BlockContents(slice), nullptr /* cache */, nullptr /* cache_handle */,
-      true /* own_value */);
+  CachableEntry<ParsedFullFilterBlock> block(
+      new ParsedFullFilterBlock(table_options_.filter_policy.get(),
+                                BlockContents(slice), false /* is_pdt */),
+      nullptr /* cache */, nullptr /* cache_handle */, true /* own_value */);
 
   FullFilterBlockReader reader(table_.get(), std::move(block));
   ASSERT_TRUE(reader.KeyMayMatch("foo", /*prefix_extractor=*/nullptr,
@@ -223,9 +227,10 @@ TEST_F(FullFilterBlockTest, EmptyBuilder) {
   Slice slice = builder.Finish();
   ASSERT_EQ("", EscapeString(slice));
 
-  CachableEntry<BlockContents> block(
-      new BlockContents(slice), nullptr /* cache */, nullptr /* cache_handle */,
-      true /* own_value */);
+  CachableEntry<ParsedFullFilterBlock> block(
+      new ParsedFullFilterBlock(table_options_.filter_policy.get(),
+                                BlockContents(slice), false /* is_pdt */),
+      nullptr /* cache */, nullptr /* cache_handle */, true /* own_value */);
 
   FullFilterBlockReader reader(table_.get(), std::move(block));
   // Remain same symantic with blockbased filter
@@ -281,9 +286,10 @@ TEST_F(FullFilterBlockTest, SingleChunk) {
   ASSERT_EQ(5, builder.NumAdded());
   Slice slice = builder.Finish();
 
-  CachableEntry<BlockContents> block(
-      new BlockContents(slice), nullptr /* cache */, nullptr /* cache_handle */,
-      true /* own_value */);
+  CachableEntry<ParsedFullFilterBlock> block(
+      new ParsedFullFilterBlock(table_options_.filter_policy.get(),
+                                BlockContents(slice), false /* is_pdt */),
+      nullptr /* cache */, nullptr /* cache_handle */, true /* own_value */);
 
   FullFilterBlockReader reader(table_.get(), std::move(block));
   ASSERT_TRUE(reader.KeyMayMatch("foo", /*prefix_extractor=*/nullptr,
@@ -321,6 +327,555 @@ TEST_F(FullFilterBlockTest, SingleChunk) {
       /*lookup_context=*/nullptr));
 }
 
+TEST_F(FullFilterBlockTest, SharedParsedBlock) {
+  FullFilterBlockBuilder builder(
+      nullptr, true, table_options_.filter_policy->GetFilterBitsBuilder());
+  builder.Add("foo");
+  builder.Add("bar");
+  Slice slice = builder.Finish();
+
+  // The bits reader is parsed once with the block and charged with it
+  ParsedFullFilterBlock parsed(table_options_.filter_policy.get(),
+                               BlockContents(slice), false /* is_pdt */);
+  ASSERT_NE(nullptr, parsed.filter_bits_reader());
+  ASSERT_GT(parsed.filter_bits_reader()->ApproximateMemoryUsage(), 0);
+  ASSERT_EQ(BlockContents(slice).ApproximateMemoryUsage() +
+                parsed.filter_bits_reader()->ApproximateMemoryUsage(),
+            parsed.ApproximateMemoryUsage());
+
+  // Readers holding the block, e.g. through the block cache, share it
+  for (int i = 0; i < 2; i++) {
+    CachableEntry<ParsedFullFilterBlock> block;
+    block.SetUnownedValue(&parsed);
+    FullFilterBlockReader reader(table_.get(), std::move(block));
+    ASSERT_TRUE(reader.KeyMayMatch("foo", /*prefix_extractor=*/nullptr,
+                                   /*block_offset=*/kNotValid,
+                                   /*no_io=*/false, /*const_ikey_ptr=*/nullptr,
+                                   /*get_context=*/nullptr,
+                                   /*lookup_context=*/nullptr));
+    ASSERT_TRUE(!reader.KeyMayMatch(
+        "missing", /*prefix_extractor=*/nullptr, /*block_offset=*/kNotValid,
+        /*no_io=*/false, /*const_ikey_ptr=*/nullptr, /*get_context=*/nullptr,
+        /*lookup_context=*/nullptr));
+  }
+}
+
+class OtLexPdtFilterBlockTest : public FullFilterBlockTest {
+ public:
+  // Keys arrive sorted from BlockBasedTableBuilder::Add()
+  Slice BuildFilter(OtLexPdtFilterBlockBuilder* builder) {
+    builder->Add("bar");
+    builder->Add("box");
+    builder->Add("box");
+    builder->Add("foo");
+    builder->Add("hello");
+    return builder->Finish();
+  }
+
+  void CheckKeys(FilterBitsReader* reader) {
+    ASSERT_TRUE(reader->MayMatch("bar"));
+    ASSERT_TRUE(reader->MayMatch("box"));
+    ASSERT_TRUE(reader->MayMatch("foo"));
+    ASSERT_TRUE(reader->MayMatch("hello"));
+    ASSERT_TRUE(!reader->MayMatch("bo"));
+    ASSERT_TRUE(!reader->MayMatch("boxes"));
+    ASSERT_TRUE(!reader->MayMatch("missing"));
+  }
+};
+
+TEST_F(OtLexPdtFilterBlockTest, SingleChunk) {
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  ASSERT_EQ(0, builder.NumAdded());
+  Slice slice = BuildFilter(&builder);
+  ASSERT_EQ(kOtLexPdtMappedSubImpl, slice[slice.size() - 4]);
+
+  CachableEntry<ParsedFullFilterBlock> block(
+      new ParsedFullFilterBlock(table_options_.filter_policy.get(),
+                                BlockContents(slice), true /* is_pdt */),
+      nullptr /* cache */, nullptr /* cache_handle */, true /* own_value */);
+
+  OtLexPdtFilterBlockReader reader(table_.get(), std::move(block));
+  ASSERT_TRUE(reader.KeyMayMatch("foo", /*prefix_extractor=*/nullptr,
+                                 /*block_offset=*/kNotValid,
+                                 /*no_io=*/false, /*const_ikey_ptr=*/nullptr,
+                                 /*get_context=*/nullptr,
+                                 /*lookup_context=*/nullptr));
+  ASSERT_TRUE(reader.KeyMayMatch("box", /*prefix_extractor=*/nullptr,
+                                 /*block_offset=*/kNotValid,
+                                 /*no_io=*/false, /*const_ikey_ptr=*/nullptr,
+                                 /*get_context=*/nullptr,
+                                 /*lookup_context=*/nullptr));
+  ASSERT_TRUE(!reader.KeyMayMatch(
+      "missing", /*prefix_extractor=*/nullptr, /*block_offset=*/kNotValid,
+      /*no_io=*/false, /*const_ikey_ptr=*/nullptr, /*get_context=*/nullptr,
+      /*lookup_context=*/nullptr));
+}
+
+TEST_F(OtLexPdtFilterBlockTest, MappedInPlace) {
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  Slice slice = BuildFilter(&builder);
+
+  // An aligned block is used in place, the reader holds no copy of the trie
+  std::unique_ptr<FilterBitsReader> reader(
+      table_options_.filter_policy->GetFilterBitsReader(slice, true));
+  CheckKeys(reader.get());
+  ASSERT_EQ(sizeof(OtLexPdtBloomBitsReader), reader->ApproximateMemoryUsage());
+}
+
+TEST_F(OtLexPdtFilterBlockTest, UnalignedBlock) {
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  Slice slice = BuildFilter(&builder);
+
+  // e.g. a block read from an mmap'd file at an odd offset
+  std::unique_ptr<uint64_t[]> buf(
+      new uint64_t[(slice.size() + 1) / sizeof(uint64_t) + 1]);
+  char* unaligned = reinterpret_cast<char*>(buf.get()) + 1;
+  memcpy(unaligned, slice.data(), slice.size());
+
+  std::unique_ptr<FilterBitsReader> reader(
+      table_options_.filter_policy->GetFilterBitsReader(
+          Slice(unaligned, slice.size()), true));
+  CheckKeys(reader.get());
+  ASSERT_GE(reader->ApproximateMemoryUsage(),
+            slice.size() - kOtLexPdtMetadataLen);
+}
+
+TEST_F(OtLexPdtFilterBlockTest, BlockIndex) {
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true),
+      true /* build_block_index */);
+  // data blocks are 95 bytes long plus a kBlockTrailerSize trailer
+  builder.StartBlock(0);
+  builder.Add("a");
+  builder.Add("b");
+  builder.StartBlock(100);
+  builder.Add("b");
+  builder.Add("b");
+  builder.Add("c");
+  builder.StartBlock(200);
+  builder.Add("c");
+  builder.StartBlock(300);
+  builder.Add("d");
+  builder.Add("e");
+  builder.StartBlock(400);
+  Slice slice = builder.Finish();
+  ASSERT_TRUE(slice[slice.size() - 2] & kOtLexPdtHasBlockIndex);
+
+  std::unique_ptr<FilterBitsReader> bits_reader(
+      table_options_.filter_policy->GetFilterBitsReader(slice, true));
+  OtLexPdtBloomBitsReader* reader =
+      static_cast<OtLexPdtBloomBitsReader*>(bits_reader.get());
+  ASSERT_TRUE(reader->HasBlockIndex());
+  const OtLexPdtBlockIndex& block_index = reader->block_index();
+  ASSERT_EQ(4U, block_index.NumBlocks());
+
+  // the block where each key shows up first
+  const char* keys[] = {"a", "b", "c", "d", "e"};
+  const uint64_t blocks[] = {0, 0, 1, 3, 3};
+  for (size_t i = 0; i < 5; i++) {
+    size_t rank = reader->KeyRank(keys[i]);
+    ASSERT_EQ(i, rank);
+    ASSERT_EQ(blocks[i], block_index.BlockOf(rank));
+  }
+  ASSERT_EQ(kOtLexPdtNotFound, reader->KeyRank("bb"));
+
+  for (uint64_t b = 0; b < 4; b++) {
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    block_index.GetBlock(b, &offset, &size);
+    ASSERT_EQ(b * 100, offset);
+    ASSERT_EQ(100 - kBlockTrailerSize, size);
+  }
+}
+
+TEST_F(OtLexPdtFilterBlockTest, NoBlockIndex) {
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  builder.StartBlock(0);
+  Slice slice = BuildFilter(&builder);
+  ASSERT_FALSE(slice[slice.size() - 2] & kOtLexPdtHasBlockIndex);
+
+  std::unique_ptr<FilterBitsReader> bits_reader(
+      table_options_.filter_policy->GetFilterBitsReader(slice, true));
+  CheckKeys(bits_reader.get());
+  ASSERT_FALSE(static_cast<OtLexPdtBloomBitsReader*>(bits_reader.get())
+                   ->HasBlockIndex());
+}
+
+TEST_F(OtLexPdtFilterBlockTest, BatchedMayMatch) {
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  std::vector<std::string> added;
+  for (int i = 0; i < 200; i += 2) {
+    added.push_back("key" + ToString(i * 7));
+  }
+  std::sort(added.begin(), added.end());
+  for (const auto& key : added) {
+    builder.Add(key);
+  }
+  Slice slice = builder.Finish();
+  std::unique_ptr<FilterBitsReader> reader(
+      table_options_.filter_policy->GetFilterBitsReader(slice, true));
+
+  // more keys than one trie batch, with prefixes and extensions of the
+  // added keys mixed in
+  std::vector<std::string> probes;
+  for (int i = 0; i < 100; i++) {
+    probes.push_back("key" + ToString(i * 7));
+  }
+  probes.push_back("");
+  probes.push_back("k");
+  probes.push_back("key");
+  probes.push_back("key00");
+  probes.push_back(std::string("key0\0", 5));
+  std::vector<Slice> slices(probes.begin(), probes.end());
+  std::vector<Slice*> keys;
+  for (auto& key : slices) {
+    keys.push_back(&key);
+  }
+  std::unique_ptr<bool[]> may_match(new bool[keys.size()]);
+  reader->MayMatch(static_cast<int>(keys.size()), &keys[0], may_match.get());
+  for (size_t i = 0; i < probes.size(); i++) {
+    bool expected = std::binary_search(added.begin(), added.end(), probes[i]);
+    ASSERT_EQ(expected, may_match[i]) << probes[i];
+    ASSERT_EQ(expected, reader->MayMatch(probes[i])) << probes[i];
+  }
+}
+
+TEST_F(OtLexPdtFilterBlockTest, StreamingBuild) {
+  std::unique_ptr<FilterBitsBuilder> bits_builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  OtLexPdtBloomBitsBuilder* builder =
+      static_cast<OtLexPdtBloomBitsBuilder*>(bits_builder.get());
+  typedef OtLexPdtBloomBitsBuilder::trie_type trie_type;
+
+  // the builder is reused for every filter, e.g. for each partition
+  for (int round = 0; round < 3; round++) {
+    std::vector<std::string> keys;
+    for (int i = 0; i < 500; i++) {
+      keys.push_back("key" + ToString(round) + ToString(i * 13));
+    }
+    std::sort(keys.begin(), keys.end());
+    for (const auto& key : keys) {
+      builder->AddKey(key);
+      builder->AddKey(key);
+    }
+    ASSERT_EQ(keys.size(), builder->NumKeys());
+    std::unique_ptr<const char[]> buf;
+    Slice slice = builder->Finish(&buf);
+    ASSERT_EQ(0U, builder->NumKeys());
+
+    // the same trie as built from all the keys at once
+    trie_type batch_trie(keys);
+    std::ostringstream expected;
+    rocksdb::succinct::mapper::freeze(
+        batch_trie, expected, rocksdb::succinct::mapper::freeze_flags::aligned);
+    ASSERT_EQ(expected.str(),
+              slice.ToString().substr(0, slice.size() - kOtLexPdtMetadataLen));
+
+    std::unique_ptr<FilterBitsReader> reader(
+        table_options_.filter_policy->GetFilterBitsReader(slice, true));
+    for (const auto& key : keys) {
+      ASSERT_TRUE(reader->MayMatch(key)) << key;
+    }
+    ASSERT_FALSE(reader->MayMatch("key" + ToString(round + 1) + "0"));
+  }
+}
+
+TEST_F(OtLexPdtFilterBlockTest, BackgroundBuild) {
+  // enough keys for a few batches of the background task
+  std::vector<std::string> keys;
+  for (int i = 0; i < 20000; i++) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%08d", i * 3);
+    keys.push_back(buf + std::string(i % 10, 'v'));
+  }
+  Env* env = Env::Default();
+  // the default Env starts without background threads
+  env->IncBackgroundThreadsIfNeeded(1, Env::Priority::BOTTOM);
+  // exact and approximate tries
+  std::unique_ptr<OtLexPdtBloomBitsBuilder> inline_builders[] = {
+      std::unique_ptr<OtLexPdtBloomBitsBuilder>(
+          new OtLexPdtBloomBitsBuilder(0)),
+      std::unique_ptr<OtLexPdtBloomBitsBuilder>(
+          new OtLexPdtBloomBitsBuilder(16))};
+  std::unique_ptr<OtLexPdtBloomBitsBuilder> background_builders[] = {
+      std::unique_ptr<OtLexPdtBloomBitsBuilder>(
+          new OtLexPdtBloomBitsBuilder(0, env)),
+      std::unique_ptr<OtLexPdtBloomBitsBuilder>(
+          new OtLexPdtBloomBitsBuilder(16, env))};
+
+  // in the first round the first Finish() waits for a batch appended in
+  // the background
+  std::atomic<int> background_batches(0);
+  SyncPoint::GetInstance()->LoadDependency(
+      {{"OtLexPdtTrieAppender::BGWork:AppendBatch",
+        "OtLexPdtTrieAppender::Finish"}});
+  SyncPoint::GetInstance()->SetCallBack(
+      "OtLexPdtTrieAppender::BGWork:AppendBatch",
+      [&](void* /*arg*/) { background_batches++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // in the second round the BOTTOM pool is kept busy, so Finish() unschedules
+  // the queued task and appends the queued keys itself
+  test::SleepingBackgroundTask sleeping_task;
+  for (int round = 0; round < 2; round++) {
+    if (round == 1) {
+      ASSERT_GT(background_batches, 0);
+      background_batches = 0;
+      env->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task,
+                    Env::Priority::BOTTOM);
+      sleeping_task.WaitUntilSleeping();
+    }
+    for (int i = 0; i < 2; i++) {
+      for (const auto& key : keys) {
+        inline_builders[i]->AddKey(key);
+        background_builders[i]->AddKey(key);
+      }
+      std::unique_ptr<const char[]> inline_buf;
+      std::unique_ptr<const char[]> background_buf;
+      Slice inline_filter = inline_builders[i]->Finish(&inline_buf);
+      Slice background_filter =
+          background_builders[i]->Finish(&background_buf);
+      ASSERT_EQ(inline_filter, background_filter);
+    }
+  }
+  ASSERT_EQ(0, background_batches);
+  ASSERT_EQ(0u, env->GetThreadPoolQueueLen(Env::Priority::BOTTOM));
+  sleeping_task.WakeUp();
+  sleeping_task.WaitUntilDone();
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(OtLexPdtFilterBlockTest, RangeAndPrefix) {
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  builder.Add("abc");
+  builder.Add("abd");
+  builder.Add("b");
+  builder.Add("bcd");
+  builder.Add("x\xff\xff");
+  Slice slice = builder.Finish();
+  std::unique_ptr<FilterBitsReader> bits_reader(
+      table_options_.filter_policy->GetFilterBitsReader(slice, true));
+  OtLexPdtBloomBitsReader* reader =
+      static_cast<OtLexPdtBloomBitsReader*>(bits_reader.get());
+
+  Slice upper("abd");
+  ASSERT_TRUE(reader->RangeMayExist("abc", &upper));
+  ASSERT_TRUE(reader->RangeMayExist("a", &upper));
+  ASSERT_FALSE(reader->RangeMayExist("abca", &upper));
+  upper = "abda";
+  ASSERT_TRUE(reader->RangeMayExist("abca", &upper));
+  upper = "b";
+  ASSERT_FALSE(reader->RangeMayExist("abe", &upper));
+  upper = "ba";
+  ASSERT_TRUE(reader->RangeMayExist("abe", &upper));
+  upper = "x";
+  ASSERT_FALSE(reader->RangeMayExist("bce", &upper));
+  upper = "";
+  ASSERT_FALSE(reader->RangeMayExist("", &upper));
+  ASSERT_TRUE(reader->RangeMayExist("", nullptr));
+  ASSERT_TRUE(reader->RangeMayExist("x", nullptr));
+  ASSERT_FALSE(reader->RangeMayExist("y", nullptr));
+
+  ASSERT_TRUE(reader->PrefixMayExist(""));
+  ASSERT_TRUE(reader->PrefixMayExist("a"));
+  ASSERT_TRUE(reader->PrefixMayExist("ab"));
+  ASSERT_TRUE(reader->PrefixMayExist("abd"));
+  ASSERT_FALSE(reader->PrefixMayExist("abe"));
+  ASSERT_FALSE(reader->PrefixMayExist("abcd"));
+  ASSERT_TRUE(reader->PrefixMayExist("b"));
+  ASSERT_TRUE(reader->PrefixMayExist("bc"));
+  ASSERT_FALSE(reader->PrefixMayExist("c"));
+  ASSERT_TRUE(reader->PrefixMayExist("x\xff"));
+  ASSERT_FALSE(reader->PrefixMayExist("\xff"));
+}
+
+TEST_F(OtLexPdtFilterBlockTest, ApproximateTrie) {
+  // long keys which are told apart early
+  std::vector<std::string> keys;
+  for (int i = 0; i < 2000; i++) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "user%08d", i * 2);
+    keys.push_back(buf + std::string(68, static_cast<char>('a' + i % 26)));
+  }
+  OtLexPdtBloomBitsBuilder exact_builder;
+  OtLexPdtBloomBitsBuilder approx_builder(16 /* fingerprint_bits */);
+  for (const auto& key : keys) {
+    exact_builder.AddKey(key);
+    approx_builder.AddKey(key);
+    approx_builder.AddKey(key);
+  }
+  ASSERT_EQ(keys.size(), approx_builder.NumKeys());
+  std::unique_ptr<const char[]> exact_buf;
+  std::unique_ptr<const char[]> approx_buf;
+  Slice exact = exact_builder.Finish(&exact_buf);
+  Slice approx = approx_builder.Finish(&approx_buf);
+  ASSERT_EQ(kOtLexPdtApproxSubImpl, approx[approx.size() - 4]);
+  ASSERT_LT(approx.size() * 4, exact.size());
+
+  std::unique_ptr<FilterBitsReader> bits_reader(
+      table_options_.filter_policy->GetFilterBitsReader(approx, true));
+  OtLexPdtBloomBitsReader* reader =
+      static_cast<OtLexPdtBloomBitsReader*>(bits_reader.get());
+  ASSERT_EQ(sizeof(*reader), reader->ApproximateMemoryUsage());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(i, reader->KeyRank(keys[i]));
+    ASSERT_TRUE(reader->PrefixMayExist(keys[i].substr(0, 30)));
+    ASSERT_TRUE(reader->RangeMayExist(keys[i], nullptr));
+  }
+
+  // missing keys sharing the stored prefixes only pass their fingerprints
+  // by chance
+  int false_positives = 0;
+  std::vector<std::string> missing;
+  for (const auto& key : keys) {
+    missing.push_back(key.substr(0, key.size() - 1) + "!");
+    missing.push_back(key.substr(0, 20));
+  }
+  std::vector<Slice> slices(missing.begin(), missing.end());
+  std::vector<Slice*> probes;
+  for (auto& key : slices) {
+    probes.push_back(&key);
+  }
+  std::unique_ptr<bool[]> may_match(new bool[probes.size()]);
+  reader->MayMatch(static_cast<int>(probes.size()), &probes[0],
+                   may_match.get());
+  for (size_t i = 0; i < probes.size(); i++) {
+    ASSERT_EQ(may_match[i], reader->MayMatch(*probes[i]));
+    false_positives += may_match[i] ? 1 : 0;
+  }
+  ASSERT_LE(false_positives, 3);
+
+  ASSERT_FALSE(reader->PrefixMayExist("user9"));
+  ASSERT_FALSE(reader->PrefixMayExist("v"));
+  ASSERT_FALSE(reader->MayMatch("v"));
+  ASSERT_FALSE(reader->RangeMayExist("v", nullptr));
+}
+
+TEST_F(OtLexPdtFilterBlockTest, LongLabels) {
+  // labels much longer than a vector register, with non ascii chars (which
+  // take two bytes in the label pool) around the register boundaries
+  const std::string prefix(100, 'k');
+  std::vector<std::string> keys;
+  for (size_t pos : {0, 15, 16, 31, 32, 33, 64}) {
+    std::string key = prefix + std::string(80, 'v');
+    key[100 + pos] = '\xc3';
+    keys.push_back(key);
+    key[100 + pos + 1] = '\x80';
+    keys.push_back(key);
+    key.resize(100 + pos + 40);
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  Slice slice = builder.Finish();
+  std::unique_ptr<FilterBitsReader> bits_reader(
+      table_options_.filter_policy->GetFilterBitsReader(slice, true));
+  OtLexPdtBloomBitsReader* reader =
+      static_cast<OtLexPdtBloomBitsReader*>(bits_reader.get());
+
+  std::vector<std::string> missing;
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(i, reader->KeyRank(keys[i]));
+    ASSERT_TRUE(reader->PrefixMayExist(keys[i].substr(0, 117)));
+    for (size_t pos : {1, 16, 17, 32, 33, 99, 101, 116, 133}) {
+      if (pos < keys[i].size()) {
+        std::string key = keys[i];
+        key[pos] = '\x81';
+        missing.push_back(key);
+        key[pos] = 'l';
+        missing.push_back(key);
+      }
+    }
+    missing.push_back(keys[i] + "v");
+    missing.push_back(keys[i].substr(0, keys[i].size() - 1));
+  }
+  std::vector<Slice> slices;
+  for (const auto& key : missing) {
+    if (!std::binary_search(keys.begin(), keys.end(), key)) {
+      ASSERT_EQ(kOtLexPdtNotFound, reader->KeyRank(key));
+      slices.push_back(key);
+    }
+  }
+  std::vector<Slice*> probes;
+  for (auto& key : slices) {
+    probes.push_back(&key);
+  }
+  std::unique_ptr<bool[]> may_match(new bool[probes.size()]);
+  reader->MayMatch(static_cast<int>(probes.size()), &probes[0],
+                   may_match.get());
+  for (size_t i = 0; i < probes.size(); i++) {
+    ASSERT_FALSE(may_match[i]);
+  }
+  ASSERT_FALSE(reader->PrefixMayExist(prefix + "vvvvw"));
+  ASSERT_FALSE(reader->PrefixMayExist(prefix + "l"));
+}
+
+TEST_F(OtLexPdtFilterBlockTest, NullBytes) {
+  // the trie strings are null-terminated, so keys holding 0 or 1 bytes are
+  // stored escaped, and "a" and "a\0..." no longer clash
+  const std::vector<std::string> keys = {
+      std::string("a"), std::string("a\0", 2), std::string("a\0\0", 3),
+      std::string("a\0b", 3), std::string("a\1", 2), std::string("a\2", 2),
+      std::string("b\0", 2)};
+  OtLexPdtFilterBlockBuilder builder(
+      table_options_.filter_policy->GetFilterBitsBuilder(true));
+  for (const auto& key : keys) {
+    builder.Add(key);
+  }
+  Slice slice = builder.Finish();
+  ASSERT_TRUE(slice[slice.size() - 2] & kOtLexPdtEscapedKeys);
+  std::unique_ptr<FilterBitsReader> bits_reader(
+      table_options_.filter_policy->GetFilterBitsReader(slice, true));
+  OtLexPdtBloomBitsReader* reader =
+      static_cast<OtLexPdtBloomBitsReader*>(bits_reader.get());
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(i, reader->KeyRank(keys[i]));
+  }
+  std::vector<std::string> missing = {std::string("a\0a", 3),
+                                      std::string("a\1\0", 3),
+                                      std::string("\0", 1), std::string("b")};
+  for (const auto& key : missing) {
+    ASSERT_EQ(kOtLexPdtNotFound, reader->KeyRank(key));
+  }
+  std::vector<Slice> slices(keys.begin(), keys.end());
+  slices.insert(slices.end(), missing.begin(), missing.end());
+  std::vector<Slice*> probes;
+  for (auto& key : slices) {
+    probes.push_back(&key);
+  }
+  std::unique_ptr<bool[]> may_match(new bool[probes.size()]);
+  reader->MayMatch(static_cast<int>(probes.size()), &probes[0],
+                   may_match.get());
+  for (size_t i = 0; i < probes.size(); i++) {
+    ASSERT_EQ(i < keys.size(), may_match[i]);
+  }
+
+  Slice upper("a\1", 2);
+  ASSERT_TRUE(reader->RangeMayExist(Slice("a\0a", 3), &upper));
+  ASSERT_FALSE(reader->RangeMayExist(Slice("a\0c", 3), &upper));
+  upper = Slice("b\0", 2);
+  ASSERT_FALSE(reader->RangeMayExist(Slice("a\3", 2), &upper));
+  ASSERT_TRUE(reader->RangeMayExist(Slice("a\3", 2), nullptr));
+  ASSERT_TRUE(reader->PrefixMayExist(Slice("a\0", 2)));
+  ASSERT_TRUE(reader->PrefixMayExist(Slice("b\0", 2)));
+  ASSERT_FALSE(reader->PrefixMayExist(Slice("a\0c", 3)));
+  ASSERT_FALSE(reader->PrefixMayExist(Slice("a\1\1", 3)));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -13,12 +13,15 @@
 #include <cinttypes>
 
 #include <list>
+#include <sstream>
 #include <string>
 
+#include "db/dbformat.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/flush_block_policy.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/format.h"
+#include "util/coding.h"
 
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace rocksdb {
@@ -54,6 +57,9 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
           table_opt.format_version, use_value_delta_encoding,
           table_opt.index_shortening, /* include_first_key */ true);
     } break;
+    case BlockBasedTableOptions::kTrieSearch: {
+      result = new TrieIndexBuilder(comparator, table_opt.index_shortening);
+    } break;
     default: {
       assert(!"Do not recognize the index type ");
     } break;
@@ -100,7 +106,8 @@ void PartitionedIndexBuilder::MakeNewSubIndexBuilder() {
   sub_index_builder_ = new ShortenedIndexBuilder(
       comparator_, table_opt_.index_block_restart_interval,
       table_opt_.format_version, use_value_delta_encoding_,
-      table_opt_.index_shortening, /* include_first_key */ false);
+      table_opt_.index_shortening, /* include_first_key */ false,
+      table_opt_.elias_fano_partition_handles);
   flush_policy_.reset(FlushBlockBySizePolicyFactory::NewFlushBlockPolicy(
       table_opt_.metadata_block_size, table_opt_.block_size_deviation,
       // Note: this is sub-optimal since sub_index_builder_ could later reset
@@ -216,4 +223,78 @@ Status PartitionedIndexBuilder::Finish(
 }
 
 size_t PartitionedIndexBuilder::NumPartitions() const { return partition_cnt_; }
+
+void TrieIndexBuilder::AddIndexEntry(std::string* last_key_in_current_block,
+                                     const Slice* first_key_in_next_block,
+                                     const BlockHandle& block_handle) {
+  if (first_key_in_next_block != nullptr) {
+    if (shortening_mode_ !=
+        BlockBasedTableOptions::IndexShorteningMode::kNoShortening) {
+      comparator_->FindShortestSeparator(last_key_in_current_block,
+                                         *first_key_in_next_block);
+    }
+  } else {
+    if (shortening_mode_ == BlockBasedTableOptions::IndexShorteningMode::
+                                kShortenSeparatorsAndSuccessor) {
+      comparator_->FindShortSuccessor(last_key_in_current_block);
+    }
+  }
+  Slice sep(*last_key_in_current_block);
+  Slice user_key = ExtractUserKey(sep);
+  if (num_blocks_ == 0 || user_key != Slice(last_user_key_)) {
+    Slice escaped = TrieIndex::EscapeKey(user_key, &escape_buf_);
+    // keep the null terminator the trie expects
+    trie_key_.assign(escaped.data(), escaped.size());
+    trie_key_.push_back('\0');
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(trie_key_.data());
+    trie_builder_.append(
+        rocksdb::succinct::util::char_range(begin, begin + trie_key_.size()),
+        rocksdb::succinct::util::identity_adaptor());
+    last_user_key_.assign(user_key.data(), user_key.size());
+    first_blocks_.push_back(num_blocks_);
+  }
+  tags_.push_back(ExtractInternalKeyFooter(sep));
+  extents_.push_back(block_handle.offset());
+  extents_.push_back(block_handle.offset() + block_handle.size());
+  num_blocks_++;
+}
+
+Status TrieIndexBuilder::Finish(
+    IndexBlocks* index_blocks,
+    const BlockHandle& /*last_partition_block_handle*/) {
+  TrieIndex index;
+  index.num_blocks_ = num_blocks_;
+  trie_builder_.finish(index.trie_);
+  if (seperator_is_key_plus_seq()) {
+    rocksdb::succinct::elias_fano::elias_fano_builder first_blocks_builder(
+        num_blocks_, first_blocks_.size());
+    for (uint64_t block : first_blocks_) {
+      first_blocks_builder.push_back(block);
+    }
+    rocksdb::succinct::elias_fano(&first_blocks_builder)
+        .swap(index.first_blocks_);
+    index.tags_.steal(tags_);
+  }
+  if (!extents_.empty()) {
+    rocksdb::succinct::elias_fano::elias_fano_builder extents_builder(
+        extents_.back(), extents_.size());
+    for (uint64_t pos : extents_) {
+      extents_builder.push_back(pos);
+    }
+    rocksdb::succinct::elias_fano(&extents_builder, false)
+        .swap(index.extents_);
+  }
+  std::ostringstream frozen;
+  rocksdb::succinct::mapper::freeze(
+      index, frozen, rocksdb::succinct::mapper::freeze_flags::aligned);
+  index_contents_ = frozen.str();
+  PutFixed32(&index_contents_, TrieIndex::kMagic);
+  PutFixed32(&index_contents_, 0);
+  tags_.clear();
+  extents_.clear();
+  index_blocks->index_block_contents = index_contents_;
+  index_size_ = index_contents_.size();
+  return Status::OK();
+}
+
 }  // namespace rocksdb
@@ -15,10 +15,13 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/comparator.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_builder.h"
+#include "table/block_based/elias_fano_block_handles.h"
+#include "table/block_based/trie_index.h"
 #include "table/format.h"
 
 namespace rocksdb {
@@ -125,7 +128,7 @@ class ShortenedIndexBuilder : public IndexBuilder {
       const int index_block_restart_interval, const uint32_t format_version,
       const bool use_value_delta_encoding,
       BlockBasedTableOptions::IndexShorteningMode shortening_mode,
-      bool include_first_key)
+      bool include_first_key, bool elias_fano_handles = false)
       : IndexBuilder(comparator),
         index_block_builder_(index_block_restart_interval,
                              true /*use_delta_encoding*/,
@@ -133,9 +136,14 @@ class ShortenedIndexBuilder : public IndexBuilder {
         index_block_builder_without_seq_(index_block_restart_interval,
                                          true /*use_delta_encoding*/,
                                          use_value_delta_encoding),
+        index_block_restart_interval_(index_block_restart_interval),
         use_value_delta_encoding_(use_value_delta_encoding),
         include_first_key_(include_first_key),
+        elias_fano_handles_(elias_fano_handles),
         shortening_mode_(shortening_mode) {
+    // the handles are kept in an EliasFanoBlockHandles section, which leaves
+    // no room for the first keys
+    assert(!elias_fano_handles_ || !include_first_key_);
     // Making the default true will disable the feature for old versions
     seperator_is_key_plus_seq_ = (format_version <= 2);
   }
@@ -169,6 +177,17 @@ class ShortenedIndexBuilder : public IndexBuilder {
     }
     auto sep = Slice(*last_key_in_current_block);
 
+    if (elias_fano_handles_) {
+      block_handles_.push_back(block_handle);
+      const Slice empty;
+      index_block_builder_.Add(sep, empty, &empty);
+      if (!seperator_is_key_plus_seq_) {
+        index_block_builder_without_seq_.Add(ExtractUserKey(sep), empty,
+                                             &empty);
+      }
+      return;
+    }
+
     assert(!include_first_key_ || !current_block_first_internal_key_.empty());
     IndexValue entry(block_handle, current_block_first_internal_key_);
     std::string encoded_entry;
@@ -202,6 +221,13 @@ class ShortenedIndexBuilder : public IndexBuilder {
       index_blocks->index_block_contents =
           index_block_builder_without_seq_.Finish();
     }
+    if (elias_fano_handles_) {
+      EliasFanoBlockHandles::AppendTo(
+          index_blocks->index_block_contents, block_handles_,
+          static_cast<uint32_t>(index_block_restart_interval_),
+          &index_block_contents_);
+      index_blocks->index_block_contents = index_block_contents_;
+    }
     index_size_ = index_blocks->index_block_contents.size();
     return Status::OK();
   }
@@ -217,9 +243,15 @@ class ShortenedIndexBuilder : public IndexBuilder {
  private:
   BlockBuilder index_block_builder_;
   BlockBuilder index_block_builder_without_seq_;
+  const int index_block_restart_interval_;
   const bool use_value_delta_encoding_;
   bool seperator_is_key_plus_seq_;
   const bool include_first_key_;
+  const bool elias_fano_handles_;
+  // with elias_fano_handles_, the handles of the entries and the index block
+  // they are appended to
+  std::vector<BlockHandle> block_handles_;
+  std::string index_block_contents_;
   BlockBasedTableOptions::IndexShorteningMode shortening_mode_;
   BlockHandle last_encoded_handle_ = BlockHandle::NullBlockHandle();
   std::string current_block_first_internal_key_;
@@ -440,4 +472,47 @@ class PartitionedIndexBuilder : public IndexBuilder {
   bool cut_filter_block = false;
   BlockHandle last_encoded_handle_;
 };
+
+// This index builder builds a TrieIndex. The separators are shortened as in
+// ShortenedIndexBuilder, then their user keys go to a path decomposed trie
+// as they come, so only the handles, and the sequence/type of the
+// separators for tables where a user key spans blocks, are kept around
+// until Finish.
+class TrieIndexBuilder : public IndexBuilder {
+ public:
+  explicit TrieIndexBuilder(
+      const InternalKeyComparator* comparator,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode)
+      : IndexBuilder(comparator), shortening_mode_(shortening_mode) {}
+
+  virtual void AddIndexEntry(std::string* last_key_in_current_block,
+                             const Slice* first_key_in_next_block,
+                             const BlockHandle& block_handle) override;
+
+  using IndexBuilder::Finish;
+  virtual Status Finish(
+      IndexBlocks* index_blocks,
+      const BlockHandle& last_partition_block_handle) override;
+
+  virtual size_t IndexSize() const override { return index_size_; }
+
+  virtual bool seperator_is_key_plus_seq() override {
+    return first_blocks_.size() < num_blocks_;
+  }
+
+ private:
+  BlockBasedTableOptions::IndexShorteningMode shortening_mode_;
+  TrieIndex::trie_type::incremental_builder trie_builder_;
+  uint64_t num_blocks_ = 0;
+  std::string last_user_key_;
+  std::string escape_buf_;
+  std::string trie_key_;
+  // blocks that start a new separator user key
+  std::vector<uint64_t> first_blocks_;
+  // packed sequence/type of the separator of every block
+  std::vector<uint64_t> tags_;
+  // start and end offset of every block
+  std::vector<uint64_t> extents_;
+  std::string index_contents_;
+};
 }  // namespace rocksdb
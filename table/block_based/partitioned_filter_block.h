@@ -68,6 +68,57 @@ class PartitionedFilterBlockBuilder : public FullFilterBlockBuilder {
   BlockHandle last_encoded_handle_;
 };
 
+// Cuts the ot lex pdt filter at the index partition boundaries, like
+// PartitionedFilterBlockBuilder does for full filters, so that a lookup
+// only needs to load the trie of one partition instead of the trie of the
+// whole file. Every partition is a separate ot lex pdt block; the top-level
+// index on them has the same format as the one of partitioned full filters.
+class PartitionedOtLexPdtFilterBlockBuilder
+    : public OtLexPdtFilterBlockBuilder {
+ public:
+  // partition_size is a target on the bytes of keys added to a partition,
+  // the trie is usually smaller than the keys it holds
+  explicit PartitionedOtLexPdtFilterBlockBuilder(
+      FilterBitsBuilder* filter_bits_builder, int index_block_restart_interval,
+      const bool use_value_delta_encoding,
+      PartitionedIndexBuilder* const p_index_builder,
+      const uint32_t partition_size);
+
+  virtual ~PartitionedOtLexPdtFilterBlockBuilder();
+
+  void AddKey(const Slice& key) override;
+
+  size_t NumAdded() const override { return num_added_; }
+
+  virtual Slice Finish(const BlockHandle& last_partition_block_handle,
+                       Status* status) override;
+
+ private:
+  // Filter data
+  BlockBuilder index_on_filter_block_builder_;  // top-level index builder
+  BlockBuilder
+      index_on_filter_block_builder_without_seq_;  // same for user keys
+  struct FilterEntry {
+    std::string key;
+    Slice filter;
+  };
+  std::list<FilterEntry> filters;  // list of partitioned tries and their keys
+  std::vector<std::unique_ptr<const char[]>> filter_gc;
+  bool finishing_filters =
+      false;  // true if Finish is called once but not complete yet.
+  // The policy of when cut a filter block and Finish it
+  void MaybeCutAFilterBlock();
+  PartitionedIndexBuilder* const p_index_builder_;
+  // The desired number of key bytes per partition
+  uint32_t partition_size_;
+  // The current number of keys and key bytes in the last partition
+  uint32_t keys_in_partition_;
+  uint64_t bytes_in_partition_;
+  // Number of keys added
+  size_t num_added_;
+  BlockHandle last_encoded_handle_;
+};
+
 class PartitionedFilterBlockReader : public FilterBlockReaderCommon<Block> {
  public:
   PartitionedFilterBlockReader(const BlockBasedTable* t,
@@ -92,14 +143,19 @@ class PartitionedFilterBlockReader : public FilterBlockReaderCommon<Block> {
 
   size_t ApproximateMemoryUsage() const override;
 
- private:
+ protected:
   BlockHandle GetFilterPartitionHandle(const CachableEntry<Block>& filter_block,
                                        const Slice& entry) const;
+  const InternalKeyComparator* internal_comparator() const;
+  bool index_key_includes_seq() const;
+  bool index_value_is_full() const;
+
+ private:
   Status GetFilterPartitionBlock(
       FilePrefetchBuffer* prefetch_buffer, const BlockHandle& handle,
       bool no_io, GetContext* get_context,
       BlockCacheLookupContext* lookup_context,
-      CachableEntry<BlockContents>* filter_block) const;
+      CachableEntry<ParsedFullFilterBlock>* filter_block) const;
 
   using FilterFunction = bool (FullFilterBlockReader::*)(
       const Slice& slice, const SliceTransform* prefix_extractor,
@@ -113,12 +169,58 @@ class PartitionedFilterBlockReader : public FilterBlockReaderCommon<Block> {
                 FilterFunction filter_function) const;
   void CacheDependencies(bool pin) override;
 
-  const InternalKeyComparator* internal_comparator() const;
-  bool index_key_includes_seq() const;
-  bool index_value_is_full() const;
+ protected:
+  std::unordered_map<uint64_t, CachableEntry<ParsedFullFilterBlock>>
+      filter_map_;
+};
+
+// Reads the filters written by PartitionedOtLexPdtFilterBlockBuilder. The
+// partitions are parsed into ParsedFullFilterBlock, so each trie is mapped
+// once per block cache entry and then shared by all lookups.
+class PartitionedOtLexPdtFilterBlockReader
+    : public PartitionedFilterBlockReader {
+ public:
+  PartitionedOtLexPdtFilterBlockReader(const BlockBasedTable* t,
+                                       CachableEntry<Block>&& filter_block);
+
+  static std::unique_ptr<FilterBlockReader> Create(
+      const BlockBasedTable* table, FilePrefetchBuffer* prefetch_buffer,
+      bool use_cache, bool prefetch, bool pin,
+      BlockCacheLookupContext* lookup_context);
+
+  bool KeyMayMatch(const Slice& key, const SliceTransform* prefix_extractor,
+                   uint64_t block_offset, const bool no_io,
+                   const Slice* const const_ikey_ptr, GetContext* get_context,
+                   BlockCacheLookupContext* lookup_context) override;
+  bool PrefixMayMatch(const Slice& prefix,
+                      const SliceTransform* prefix_extractor,
+                      uint64_t block_offset, const bool no_io,
+                      const Slice* const const_ikey_ptr,
+                      GetContext* get_context,
+                      BlockCacheLookupContext* lookup_context) override;
+
+ private:
+  Status GetFilterPartitionBlock(
+      FilePrefetchBuffer* prefetch_buffer, const BlockHandle& handle,
+      bool no_io, GetContext* get_context,
+      BlockCacheLookupContext* lookup_context,
+      CachableEntry<ParsedFullFilterBlock>* filter_block) const;
+
+  using FilterFunction = bool (OtLexPdtFilterBlockReader::*)(
+      const Slice& slice, const SliceTransform* prefix_extractor,
+      uint64_t block_offset, const bool no_io,
+      const Slice* const const_ikey_ptr, GetContext* get_context,
+      BlockCacheLookupContext* lookup_context);
+  bool MayMatch(const Slice& slice, const SliceTransform* prefix_extractor,
+                uint64_t block_offset, bool no_io, const Slice* const_ikey_ptr,
+                GetContext* get_context,
+                BlockCacheLookupContext* lookup_context,
+                FilterFunction filter_function) const;
+  void CacheDependencies(bool pin) override;
 
  protected:
-  std::unordered_map<uint64_t, CachableEntry<BlockContents>> filter_map_;
+  std::unordered_map<uint64_t, CachableEntry<ParsedFullFilterBlock>>
+      pdt_filter_map_;
 };
 
 }  // namespace rocksdb
@@ -41,14 +41,35 @@ class MyPartitionedFilterBlockReader : public PartitionedFilterBlockReader {
       const uint64_t offset = pair.first;
       const Slice& slice = pair.second;
 
-      CachableEntry<BlockContents> block(
-          new BlockContents(slice), nullptr /* cache */,
-          nullptr /* cache_handle */, true /* own_value */);
+      CachableEntry<ParsedFullFilterBlock> block(
+          new ParsedFullFilterBlock(t->get_rep()->filter_policy,
+                                    BlockContents(slice), false /* is_pdt */),
+          nullptr /* cache */, nullptr /* cache_handle */,
+          true /* own_value */);
       filter_map_[offset] = std::move(block);
     }
   }
 };
 
+class MyPartitionedOtLexPdtFilterBlockReader
+    : public PartitionedOtLexPdtFilterBlockReader {
+ public:
+  MyPartitionedOtLexPdtFilterBlockReader(
+      BlockBasedTable* t, CachableEntry<Block>&& filter_block,
+      const std::vector<std::pair<uint64_t, Slice>>& partitions)
+      : PartitionedOtLexPdtFilterBlockReader(t, std::move(filter_block)) {
+    for (const auto& partition : partitions) {
+      CachableEntry<ParsedFullFilterBlock> block(
+          new ParsedFullFilterBlock(t->get_rep()->filter_policy,
+                                    BlockContents(partition.second),
+                                    true /* is_pdt */),
+          nullptr /* cache */, nullptr /* cache_handle */,
+          true /* own_value */);
+      pdt_filter_map_[partition.first] = std::move(block);
+    }
+  }
+};
+
 class PartitionedFilterBlockTest
     : public testing::Test,
       virtual public ::testing::WithParamInterface<uint32_t> {
@@ -157,6 +178,92 @@ class PartitionedFilterBlockTest
     return reader;
   }
 
+  PartitionedOtLexPdtFilterBlockBuilder* NewOtLexPdtBuilder(
+      PartitionedIndexBuilder* const p_index_builder) {
+    const bool kValueDeltaEncoded = true;
+    return new PartitionedOtLexPdtFilterBlockBuilder(
+        table_options_.filter_policy->GetFilterBitsBuilder(true),
+        table_options_.index_block_restart_interval, !kValueDeltaEncoded,
+        p_index_builder,
+        static_cast<uint32_t>(table_options_.metadata_block_size));
+  }
+
+  // Returns the reader and the number of trie partitions written
+  std::pair<PartitionedFilterBlockReader*, size_t> NewOtLexPdtReader(
+      PartitionedOtLexPdtFilterBlockBuilder* builder,
+      PartitionedIndexBuilder* pib) {
+    BlockHandle bh;
+    Status status;
+    Slice slice;
+    std::vector<std::pair<uint64_t, Slice>> partitions;
+    do {
+      slice = builder->Finish(bh, &status);
+      bh = Write(slice);
+      if (status.IsIncomplete()) {
+        partitions.emplace_back(bh.offset(), slice);
+      }
+    } while (status.IsIncomplete());
+
+    constexpr bool skip_filters = false;
+    constexpr int level = 2;
+    constexpr bool immortal_table = false;
+    table_.reset(new MockedBlockBasedTable(
+        new BlockBasedTable::Rep(ioptions_, env_options_, table_options_,
+                                 icomp_, skip_filters, level, immortal_table),
+        pib));
+    BlockContents contents(slice);
+    CachableEntry<Block> block(
+        new Block(std::move(contents), kDisableGlobalSequenceNumber,
+                  0 /* read_amp_bytes_per_bit */, nullptr),
+        nullptr /* cache */, nullptr /* cache_handle */, true /* own_value */);
+    return std::make_pair(
+        new MyPartitionedOtLexPdtFilterBlockReader(table_.get(),
+                                                   std::move(block), partitions),
+        partitions.size());
+  }
+
+  // Adds one key per data block and checks the tries of all partitions
+  size_t TestOtLexPdtBlockPerKey() {
+    std::unique_ptr<PartitionedIndexBuilder> pib(NewIndexBuilder());
+    std::unique_ptr<PartitionedOtLexPdtFilterBlockBuilder> builder(
+        NewOtLexPdtBuilder(pib.get()));
+    int i = 0;
+    builder->Add(keys[i]);
+    CutABlock(pib.get(), keys[i], keys[i + 1]);
+    i++;
+    builder->Add(keys[i]);
+    CutABlock(pib.get(), keys[i], keys[i + 1]);
+    i++;
+    builder->Add(keys[i]);
+    builder->Add(keys[i]);
+    CutABlock(pib.get(), keys[i], keys[i + 1]);
+    i++;
+    builder->Add(keys[i]);
+    CutABlock(pib.get(), keys[i]);
+
+    auto reader_and_partitions = NewOtLexPdtReader(builder.get(), pib.get());
+    std::unique_ptr<PartitionedFilterBlockReader> reader(
+        reader_and_partitions.first);
+    for (auto key : keys) {
+      auto ikey = InternalKey(key, 0, ValueType::kTypeValue);
+      const Slice ikey_slice = Slice(*ikey.rep());
+      EXPECT_TRUE(reader->KeyMayMatch(key, nullptr, kNotValid,
+                                      /*no_io=*/false, &ikey_slice,
+                                      /*get_context=*/nullptr,
+                                      /*lookup_context=*/nullptr));
+    }
+    // tries have no false positives
+    for (auto key : missing_keys) {
+      auto ikey = InternalKey(key, 0, ValueType::kTypeValue);
+      const Slice ikey_slice = Slice(*ikey.rep());
+      EXPECT_FALSE(reader->KeyMayMatch(key, nullptr, kNotValid,
+                                       /*no_io=*/false, &ikey_slice,
+                                       /*get_context=*/nullptr,
+                                       /*lookup_context=*/nullptr));
+    }
+    return reader_and_partitions.second;
+  }
+
   void VerifyReader(PartitionedFilterBlockBuilder* builder,
                     PartitionedIndexBuilder* pib, bool empty = false,
                     const SliceTransform* prefix_extractor = nullptr) {
@@ -376,6 +483,17 @@ TEST_P(PartitionedFilterBlockTest, PartitionCount) {
   ASSERT_EQ(partitions, num_keys - 1 /* last two keys make one flush */);
 }
 
+TEST_P(PartitionedFilterBlockTest, OtLexPdtPartitions) {
+  // A large partition size keeps all keys in a single trie
+  table_options_.metadata_block_size = 1 << 20;
+  ASSERT_EQ(1U, TestOtLexPdtBlockPerKey());
+  // A low number ensures cutting a trie after each key
+  table_options_.metadata_block_size = 1;
+  int num_keys = sizeof(keys) / sizeof(*keys);
+  ASSERT_EQ(static_cast<size_t>(num_keys - 1 /* last two keys make one */),
+            TestOtLexPdtBlockPerKey());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
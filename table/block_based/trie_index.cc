@@ -0,0 +1,182 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/trie_index.h"
+
+#include <string.h>
+
+#include "db/dbformat.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+Status TrieIndex::Open(const Slice& contents,
+                       std::unique_ptr<TrieIndex>* index) {
+  if (contents.size() < kTrailerSize ||
+      DecodeFixed32(contents.data() + contents.size() - kTrailerSize) !=
+          kMagic) {
+    return Status::Corruption("bad trie index block");
+  }
+  std::unique_ptr<TrieIndex> result(new TrieIndex());
+  const char* base = contents.data();
+  const size_t frozen_size = contents.size() - kTrailerSize;
+  if (reinterpret_cast<uintptr_t>(base) % sizeof(uint64_t) != 0) {
+    size_t num_words = (frozen_size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    result->aligned_copy_.reset(new uint64_t[num_words]);
+    memcpy(result->aligned_copy_.get(), base, frozen_size);
+    base = reinterpret_cast<const char*>(result->aligned_copy_.get());
+  }
+  size_t mapped = rocksdb::succinct::mapper::map(*result, base);
+  if (mapped > frozen_size) {
+    return Status::Corruption("truncated trie index block");
+  }
+  *index = std::move(result);
+  return Status::OK();
+}
+
+uint64_t TrieIndex::Seek(const Slice& target) const {
+  if (num_blocks_ == 0) {
+    return 0;
+  }
+  std::string buf;
+  Slice key = EscapeKey(ExtractUserKey(target), &buf);
+  bool exact = false;
+  uint64_t rank =
+      trie_.lower_bound(reinterpret_cast<const uint8_t*>(key.data()),
+                        key.size(), &exact);
+  if (rank == trie_.size()) {
+    return num_blocks_;
+  }
+  uint64_t block = FirstBlock(rank);
+  if (exact && KeyIncludesSeq()) {
+    // among the blocks of this user key, the separators sort by descending
+    // sequence/type
+    uint64_t end = rank + 1 < trie_.size() ? FirstBlock(rank + 1) : num_blocks_;
+    uint64_t tag = ExtractInternalKeyFooter(target);
+    while (block < end && tags_[block] > tag) {
+      block++;
+    }
+  }
+  return block;
+}
+
+void TrieIndex::AppendSeparator(uint64_t rank, std::string* user_key) const {
+  std::string escaped = trie_[rank];
+  for (size_t i = 0; i < escaped.size(); i++) {
+    if (escaped[i] == 1 && i + 1 < escaped.size()) {
+      user_key->push_back(static_cast<char>(escaped[++i] - 1));
+    } else {
+      user_key->push_back(escaped[i]);
+    }
+  }
+}
+
+size_t TrieIndex::ApproximateMemoryUsage() const {
+  size_t usage = sizeof(*this);
+  if (aligned_copy_ != nullptr) {
+    usage += rocksdb::succinct::mapper::size_of(
+        const_cast<TrieIndex&>(*this));
+  }
+  return usage;
+}
+
+Slice TrieIndex::EscapeKey(const Slice& key, std::string* buf) {
+  const char* p = key.data();
+  const char* end = p + key.size();
+  while (p < end && static_cast<unsigned char>(*p) > 1) {
+    p++;
+  }
+  if (p == end) {
+    return key;
+  }
+  buf->assign(key.data(), p - key.data());
+  for (; p < end; p++) {
+    if (static_cast<unsigned char>(*p) <= 1) {
+      buf->push_back(1);
+      buf->push_back(static_cast<char>(*p + 1));
+    } else {
+      buf->push_back(*p);
+    }
+  }
+  return Slice(*buf);
+}
+
+TrieIndexBlock::TrieIndexBlock(BlockContents&& contents)
+    : contents_(std::move(contents)) {
+  status_ = TrieIndex::Open(contents_.data, &index_);
+}
+
+size_t TrieIndexBlock::ApproximateMemoryUsage() const {
+  size_t usage = contents_.ApproximateMemoryUsage();
+  if (index_ != nullptr) {
+    usage += index_->ApproximateMemoryUsage();
+  }
+  return usage;
+}
+
+TrieIndexIterator::TrieIndexIterator(const TrieIndex* index)
+    : index_(index), block_(index->NumBlocks()), user_key_rank_(-1) {}
+
+void TrieIndexIterator::SeekToLast() {
+  SeekToBlock(index_->NumBlocks() > 0 ? index_->NumBlocks() - 1 : 0);
+}
+
+void TrieIndexIterator::SeekForPrev(const Slice& /*target*/) {
+  assert(false);
+  block_ = index_->NumBlocks();
+  status_ = Status::InvalidArgument(
+      "RocksDB internal error: should never call SeekForPrev() on index "
+      "block");
+}
+
+void TrieIndexIterator::Next() {
+  assert(Valid());
+  SeekToBlock(block_ + 1);
+}
+
+void TrieIndexIterator::Prev() {
+  assert(Valid());
+  SeekToBlock(block_ > 0 ? block_ - 1 : index_->NumBlocks());
+}
+
+void TrieIndexIterator::SeekToBlock(uint64_t block) {
+  block_ = block;
+  if (Valid()) {
+    handle_ = index_->GetBlockHandle(block_);
+  }
+}
+
+void TrieIndexIterator::DecodeUserKey() const {
+  uint64_t rank = index_->SeparatorRank(block_);
+  if (rank != user_key_rank_) {
+    user_key_.clear();
+    index_->AppendSeparator(rank, &user_key_);
+    user_key_rank_ = rank;
+  }
+}
+
+Slice TrieIndexIterator::key() const {
+  assert(Valid());
+  DecodeUserKey();
+  if (!index_->KeyIncludesSeq()) {
+    return user_key_;
+  }
+  key_.assign(user_key_);
+  PutFixed64(&key_, index_->SeparatorTag(block_));
+  return key_;
+}
+
+Slice TrieIndexIterator::user_key() const {
+  assert(Valid());
+  DecodeUserKey();
+  return user_key_;
+}
+
+IndexValue TrieIndexIterator::value() const {
+  assert(Valid());
+  return IndexValue(handle_, Slice());
+}
+
+}  // namespace rocksdb
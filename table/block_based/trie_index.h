@@ -0,0 +1,182 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+#include "succinct/elias_fano.hpp"
+#include "succinct/mappable_vector.hpp"
+#include "succinct/mapper.hpp"
+#include "tries/path_decomposed_trie.hpp"
+#include "tries/vbyte_string_pool.hpp"
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+#include "table/internal_iterator.h"
+
+namespace rocksdb {
+
+// The index block of a BlockBasedTableOptions::kTrieSearch table. The
+// separator user keys are stored once each in a lexicographic path
+// decomposed trie, so the prefixes they share are not repeated, and the
+// block handles are kept apart in an Elias-Fano sequence:
+// +------------------------------------------------------------------+
+// | TrieIndex frozen with mapper::freeze_flags::aligned              |
+// +------------------------------------------------------------------+
+// | magic (4 bytes) | 0 (4 bytes)                                    |
+// +------------------------------------------------------------------+
+// The trailing zero reads as a block without restart points, so the
+// contents can go through the block cache like any other index block.
+//
+// The ranks of the trie are the distinct separator user keys. When a user
+// key spans several data blocks their separators only differ in the
+// sequence number and type, and the blocks share the rank. Such tables
+// also carry the packed sequence/type of every separator, and the index
+// keys include it; otherwise ranks and blocks are the same and the index
+// keys are user keys.
+class TrieIndex {
+ public:
+  typedef rocksdb::succinct::tries::path_decomposed_trie<
+      rocksdb::succinct::tries::vbyte_string_pool, true>
+      trie_type;
+
+  static const uint32_t kMagic = 0x54726965;  // "Trie"
+  static const size_t kTrailerSize = 2 * sizeof(uint32_t);
+
+  TrieIndex() : num_blocks_(0) {}
+
+  // No copying allowed
+  TrieIndex(const TrieIndex&) = delete;
+  void operator=(const TrieIndex&) = delete;
+
+  // Maps the contents of an index block written by TrieIndexBuilder. The
+  // index points into contents, which must outlive it, unless contents
+  // are not 8-byte aligned, in which case they are copied.
+  static Status Open(const Slice& contents, std::unique_ptr<TrieIndex>* index);
+
+  uint64_t NumBlocks() const { return num_blocks_; }
+
+  // Whether the index keys include the sequence number and type
+  bool KeyIncludesSeq() const { return tags_.size() > 0; }
+
+  // Index of the first block whose separator is not less than the internal
+  // key target, or NumBlocks() if there is none
+  uint64_t Seek(const Slice& target) const;
+
+  // Rank of the separator user key of block
+  uint64_t SeparatorRank(uint64_t block) const {
+    assert(block < num_blocks_);
+    return KeyIncludesSeq() ? first_blocks_.rank(block + 1) - 1 : block;
+  }
+
+  // Appends the separator user key of rank to user_key
+  void AppendSeparator(uint64_t rank, std::string* user_key) const;
+
+  // Packed sequence number and type of the separator of block.
+  // REQUIRES: KeyIncludesSeq()
+  uint64_t SeparatorTag(uint64_t block) const {
+    assert(KeyIncludesSeq());
+    return tags_[block];
+  }
+
+  BlockHandle GetBlockHandle(uint64_t block) const {
+    assert(block < num_blocks_);
+    uint64_t offset = extents_.select(2 * block);
+    return BlockHandle(offset, extents_.select(2 * block + 1) - offset);
+  }
+
+  size_t ApproximateMemoryUsage() const;
+
+  // The trie keeps 0 as the string terminator, so 0 and 1 bytes of the user
+  // keys are escaped as 1 1 and 1 2, which keeps the order of the keys.
+  // Returns key itself when there is nothing to escape, otherwise the
+  // escaped key stored in buf.
+  static Slice EscapeKey(const Slice& key, std::string* buf);
+
+  template <typename Visitor>
+  void map(Visitor& visit) {
+    visit(num_blocks_, "num_blocks_")(trie_, "trie_")(
+        first_blocks_, "first_blocks_")(tags_, "tags_")(extents_, "extents_");
+  }
+
+ private:
+  friend class TrieIndexBuilder;
+
+  uint64_t FirstBlock(uint64_t rank) const {
+    return KeyIncludesSeq() ? first_blocks_.select(rank) : rank;
+  }
+
+  uint64_t num_blocks_;
+  trie_type trie_;
+  // positions of the blocks that start a new separator user key, only
+  // with KeyIncludesSeq()
+  rocksdb::succinct::elias_fano first_blocks_;
+  // packed sequence/type by block, only with KeyIncludesSeq()
+  rocksdb::succinct::mapper::mappable_vector<uint64_t> tags_;
+  // start and end offset of every block
+  rocksdb::succinct::elias_fano extents_;
+  // contents copied to be mapped at an aligned address
+  std::unique_ptr<uint64_t[]> aligned_copy_;
+};
+
+// The cachable part of a trie index: the index block and the TrieIndex
+// mapped from it when the block is read, shared by every iterator holding
+// the block.
+class TrieIndexBlock {
+ public:
+  explicit TrieIndexBlock(BlockContents&& contents);
+
+  // nullptr if the block could not be mapped, see status()
+  const TrieIndex* index() const { return index_.get(); }
+  const Status& status() const { return status_; }
+
+  size_t ApproximateMemoryUsage() const;
+
+  bool own_bytes() const { return contents_.own_bytes(); }
+
+ private:
+  BlockContents contents_;
+  std::unique_ptr<TrieIndex> index_;
+  Status status_;
+};
+
+// Iterates the blocks of a TrieIndex, yielding the separator of each block
+// as the key and its handle as the value.
+class TrieIndexIterator : public InternalIteratorBase<IndexValue> {
+ public:
+  // index must outlive the iterator
+  explicit TrieIndexIterator(const TrieIndex* index);
+
+  bool Valid() const override { return block_ < index_->NumBlocks(); }
+  void SeekToFirst() override { SeekToBlock(0); }
+  void SeekToLast() override;
+  void Seek(const Slice& target) override { SeekToBlock(index_->Seek(target)); }
+  void SeekForPrev(const Slice& target) override;
+  void Next() override;
+  void Prev() override;
+  Slice key() const override;
+  Slice user_key() const override;
+  IndexValue value() const override;
+  Status status() const override { return status_; }
+
+ private:
+  void SeekToBlock(uint64_t block);
+  void DecodeUserKey() const;
+
+  const TrieIndex* index_;
+  uint64_t block_;
+  BlockHandle handle_;
+  Status status_;
+  // separator of block_, decoded on demand
+  mutable uint64_t user_key_rank_;
+  mutable std::string user_key_;
+  mutable std::string key_;
+};
+
+}  // namespace rocksdb
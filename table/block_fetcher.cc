@@ -174,6 +174,10 @@ inline void BlockFetcher::InsertUncompressedBlockToPersistentCacheIfNeeded(int l
   {
     return;
   }
+  if (cache_options_.demote_on_evict && block_type_ == BlockType::kData) {
+    // the block reaches the persistent cache when the block cache evicts it
+    return;
+  }
   if (status_.ok() && !got_from_prefetch_buffer_ && read_options_.fill_cache &&
       cache_options_.persistent_cache &&
       !cache_options_.persistent_cache->IsCompressed()) {
@@ -217,6 +221,7 @@ Status BlockFetcher::ReadBlockContents(int level,bool is_meta_block) {
   block_size_ = static_cast<size_t>(handle_.size());
 
   if (TryGetUncompressBlockFromPersistentCache(level)) {
+    got_from_persistent_cache_ = true;
     compression_type_ = kNoCompression;
 #ifndef NDEBUG
     contents_->is_raw_block = true;
@@ -64,6 +64,8 @@ class BlockFetcher {
 
   Status ReadBlockContents(int level=2,bool is_meta_block=false);
   CompressionType get_compression_type() const { return compression_type_; }
+  // Whether the block was found in the uncompressed persistent cache
+  bool got_from_persistent_cache() const { return got_from_persistent_cache_; }
 
  private:
   static const uint32_t kDefaultStackBufferSize = 5000;
@@ -90,6 +92,7 @@ class BlockFetcher {
   CacheAllocationPtr compressed_buf_;
   char stack_buf_[kDefaultStackBufferSize];
   bool got_from_prefetch_buffer_ = false;
+  bool got_from_persistent_cache_ = false;
   rocksdb::CompressionType compression_type_;
   bool for_compaction_ = false;
 
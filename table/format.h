@@ -301,15 +301,19 @@ struct BlockContents {
 };
 
 //wp
-// The sharable/cachable part of the full filter.
+// The sharable/cachable part of the full filter: the filter bits reader is
+// decoded once, when the block is read, and shared by every lookup holding
+// the block. is_pdt tells whether the table recorded an ot lex pdt filter in
+// its meta-index, as opposed to a Bloom full filter.
 class ParsedFullFilterBlock {
  public:
   ParsedFullFilterBlock(const FilterPolicy* filter_policy,
-                        BlockContents&& contents)
+                        BlockContents&& contents, bool is_pdt)
     : block_contents_(std::move(contents)),
       filter_bits_reader_(
           !block_contents_.data.empty()
-              ? filter_policy->GetFilterBitsReader(block_contents_.data,true)
+              ? filter_policy->GetFilterBitsReader(block_contents_.data,
+                                                   is_pdt)
               : nullptr) {}
   ~ParsedFullFilterBlock() = default;;
 
@@ -317,9 +321,12 @@ class ParsedFullFilterBlock {
     return filter_bits_reader_.get();
   }
 
-  // TODO: consider memory usage of the FilterBitsReader
   size_t ApproximateMemoryUsage() const {
-    return block_contents_.ApproximateMemoryUsage();
+    size_t usage = block_contents_.ApproximateMemoryUsage();
+    if (filter_bits_reader_) {
+      usage += filter_bits_reader_->ApproximateMemoryUsage();
+    }
+    return usage;
   }
 
   bool own_bytes() const { return block_contents_.own_bytes(); }
@@ -8,25 +8,350 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <deque>
+#include "succinct/elias_fano.hpp"
+#include "succinct/mapper.hpp"
 #include "tries/path_decomposed_trie.hpp"
 #include "tries/vbyte_string_pool.hpp"
+#include <string.h>
 #include <time.h>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
+#include "port/port.h"
+#include "rocksdb/env.h"
 #include "rocksdb/filter_policy.h"
+#include "table/block_based/trie_index.h"
+#include "test_util/sync_point.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
 
 namespace rocksdb {
 
 class Slice;
 // xp
+// Every OtLexPdt filter block ends with a trailer laid out like the metadata
+// of the newer full filter implementations:
+// +-----------------------------------------------------------------+
+// | -1 marker | sub-implementation | num_probes placeholder | 2 pad |
+// +-----------------------------------------------------------------+
+// The sub-implementation byte tells the reader how the trie is encoded:
+// kOtLexPdtLegacySubImpl blocks store the raw builder vectors, and the
+// reader has to rebuild the trie from them; kOtLexPdtMappedSubImpl blocks
+// store the fully built trie frozen with mapper::freeze_flags::aligned, so
+// the reader maps it in place without copying. kOtLexPdtApproxSubImpl blocks
+// are mapped the same way, but hold an approximate trie followed by
+// OtLexPdtFingerprints, see OtLexPdtBloomBitsBuilder.
+// The first padding byte holds flags; kOtLexPdtHasBlockIndex means a frozen
+// OtLexPdtBlockIndex follows the trie, kOtLexPdtEscapedKeys that some keys
+// held 0 or 1 bytes, stored escaped by TrieIndex::EscapeKey() as the trie
+// strings are null-terminated, so lookups have to escape theirs too.
+const size_t kOtLexPdtMetadataLen = 5;
+const char kOtLexPdtLegacySubImpl = 'P';
+const char kOtLexPdtMappedSubImpl = 'M';
+const char kOtLexPdtApproxSubImpl = 'A';
+const char kOtLexPdtHasBlockIndex = 0x1;
+const char kOtLexPdtEscapedKeys = 0x2;
+// Name() of the built-in filter policy, the only one whose pdt bits builders
+// and readers are OtLexPdtBloomBitsBuilder and OtLexPdtBloomBitsReader
+const char kBuiltinBloomFilterPolicyName[] = "rocksdb.BuiltinBloomFilter";
+// returned by trie lookups for keys not in the trie
+const size_t kOtLexPdtNotFound = static_cast<size_t>(-1);
+
+// Maps the rank of a key in the ot lex pdt to the data block holding it, so
+// that a point lookup which already walked the trie does not need to search
+// the index block as well. Only valid when the table keys are ordered
+// bytewise, so that the trie ranks follow the table order.
+// first_ranks holds, for every data block, the number of distinct keys that
+// appear in earlier blocks; the key of rank r first shows up in the last
+// block b with first_ranks[b] <= r (its older versions may spill into the
+// following blocks). extents holds offset and offset + size of every data
+// block. Both sequences are non-decreasing, so they are Elias-Fano coded.
+class OtLexPdtBlockIndex {
+ public:
+  OtLexPdtBlockIndex() {}
+
+  // first_ranks and extents as described above, num_keys is the number of
+  // distinct keys in the table
+  OtLexPdtBlockIndex(const std::vector<uint64_t>& first_ranks,
+                     const std::vector<uint64_t>& extents, uint64_t num_keys) {
+    assert(first_ranks.size() * 2 == extents.size());
+    assert(!first_ranks.empty());
+    rocksdb::succinct::elias_fano::elias_fano_builder ranks_builder(
+        num_keys, first_ranks.size());
+    for (uint64_t rank : first_ranks) {
+      ranks_builder.push_back(rank);
+    }
+    rocksdb::succinct::elias_fano(&ranks_builder).swap(first_ranks_);
+    rocksdb::succinct::elias_fano::elias_fano_builder extents_builder(
+        extents.back(), extents.size());
+    for (uint64_t pos : extents) {
+      extents_builder.push_back(pos);
+    }
+    rocksdb::succinct::elias_fano(&extents_builder, false).swap(extents_);
+  }
+
+  uint64_t NumBlocks() const { return first_ranks_.num_ones(); }
+
+  // Index of the first data block that may hold the key of rank key_rank
+  uint64_t BlockOf(uint64_t key_rank) const {
+    assert(key_rank < first_ranks_.size());
+    return first_ranks_.rank(key_rank + 1) - 1;
+  }
+
+  void GetBlock(uint64_t block, uint64_t* offset, uint64_t* size) const {
+    assert(block < NumBlocks());
+    *offset = extents_.select(2 * block);
+    *size = extents_.select(2 * block + 1) - *offset;
+  }
+
+  void swap(OtLexPdtBlockIndex& other) {
+    first_ranks_.swap(other.first_ranks_);
+    extents_.swap(other.extents_);
+  }
+
+  template <typename Visitor>
+  void map(Visitor& visit) {
+    visit(first_ranks_, "first_ranks_")(extents_, "extents_");
+  }
+
+ private:
+  rocksdb::succinct::elias_fano first_ranks_;
+  rocksdb::succinct::elias_fano extents_;
+};
+
+// Fingerprints of the keys of an approximate ot lex pdt, by trie rank. Each
+// one is the low bits_per_key bits of a hash of the whole key, so that a
+// missing key which starts with the stored prefix of a table key only
+// matches with probability 2^-bits_per_key.
+class OtLexPdtFingerprints {
+ public:
+  static const int kMaxBitsPerKey = 32;
+
+  OtLexPdtFingerprints() : bits_per_key_(0) {}
+
+  // fingerprints holds the Fingerprint() of every key, in trie rank order
+  OtLexPdtFingerprints(
+      uint64_t bits_per_key,
+      rocksdb::succinct::bit_vector_builder* fingerprints)
+      : bits_per_key_(bits_per_key), fingerprints_(fingerprints) {}
+
+  static uint64_t Fingerprint(const Slice& key, uint64_t bits_per_key) {
+    assert(bits_per_key > 0 && bits_per_key <= kMaxBitsPerKey);
+    const uint64_t mask = (uint64_t(1) << bits_per_key) - 1;
+    return Hash(key.data(), key.size(), 0xf1e2d3c4) & mask;
+  }
+
+  bool Matches(uint64_t rank, const Slice& key) const {
+    return fingerprints_.get_bits(rank * bits_per_key_, bits_per_key_) ==
+           Fingerprint(key, bits_per_key_);
+  }
+
+  void swap(OtLexPdtFingerprints& other) {
+    std::swap(bits_per_key_, other.bits_per_key_);
+    fingerprints_.swap(other.fingerprints_);
+  }
+
+  template <typename Visitor>
+  void map(Visitor& visit) {
+    visit(bits_per_key_, "bits_per_key_")(fingerprints_, "fingerprints_");
+  }
+
+ private:
+  uint64_t bits_per_key_;
+  rocksdb::succinct::bit_vector fingerprints_;
+};
+
+// Feeds the keys of an ot lex pdt to its incremental builder. Without an
+// Env the keys are appended inline. With one they are handed over in
+// batches to a task on the BOTTOM priority pool of the Env, which appends
+// the batches queued so far and exits; the next batch that finds no task
+// around schedules a new one. The appender mostly runs in a compaction,
+// which already holds a LOW thread, so the task stays off the LOW pool.
+// Finish() unschedules the task if it did not get a thread yet, waits for
+// the batch being appended, if any, and appends the ones still queued
+// itself, so a pool without threads just means an inline build.
+class OtLexPdtTrieAppender {
+ public:
+  typedef rocksdb::succinct::tries::path_decomposed_trie<
+      rocksdb::succinct::tries::vbyte_string_pool, true>
+      trie_type;
+
+  explicit OtLexPdtTrieAppender(Env* env)
+      : env_(env), state_(std::make_shared<State>()) {}
+
+  // No Copy allowed
+  OtLexPdtTrieAppender(const OtLexPdtTrieAppender&) = delete;
+  void operator=(const OtLexPdtTrieAppender&) = delete;
+
+  ~OtLexPdtTrieAppender() {
+    if (env_ != nullptr) {
+      env_->UnSchedule(this, kPriority);
+    }
+    // a task already running holds on to the state, but has nothing to do
+    MutexLock l(&state_->mu);
+    state_->pending.clear();
+  }
+
+  // Keys must come in the order of the trie
+  void Append(const std::string& key) {
+    if (env_ == nullptr) {
+      state_->trie_builder.append(
+          key, rocksdb::succinct::util::stl_string_adaptor());
+      return;
+    }
+    if (batch_ == nullptr) {
+      batch_.reset(new Batch());
+    }
+    // keep the null terminator the trie expects
+    batch_->data.append(key.c_str(), key.size() + 1);
+    batch_->ends.push_back(batch_->data.size());
+    if (batch_->data.size() >= kBatchBytes) {
+      Submit();
+    }
+  }
+
+  // Moves the keys appended so far into trie
+  void Finish(trie_type* trie) {
+    if (env_ != nullptr) {
+      TEST_SYNC_POINT("OtLexPdtTrieAppender::Finish");
+      env_->UnSchedule(this, kPriority);
+      std::deque<std::unique_ptr<Batch>> pending;
+      {
+        MutexLock l(&state_->mu);
+        while (state_->appending) {
+          state_->cv.Wait();
+        }
+        pending.swap(state_->pending);
+      }
+      for (auto& batch : pending) {
+        state_->AppendBatch(*batch);
+      }
+      if (batch_ != nullptr) {
+        state_->AppendBatch(*batch_);
+        batch_.reset();
+      }
+    }
+    state_->trie_builder.finish(*trie);
+  }
+
+ private:
+  static const size_t kBatchBytes = 64 << 10;
+  static const Env::Priority kPriority = Env::Priority::BOTTOM;
+
+  // null-terminated keys stored back to back
+  struct Batch {
+    std::string data;
+    std::vector<size_t> ends;
+  };
+
+  struct State {
+    State() : cv(&mu), scheduled(false), appending(false) {}
+
+    void AppendBatch(const Batch& batch) {
+      const uint8_t* data = reinterpret_cast<const uint8_t*>(batch.data.data());
+      size_t begin = 0;
+      for (size_t end : batch.ends) {
+        trie_builder.append(
+            rocksdb::succinct::util::char_range(data + begin, data + end),
+            rocksdb::succinct::util::identity_adaptor());
+        begin = end;
+      }
+    }
+
+    port::Mutex mu;
+    port::CondVar cv;
+    // batches not picked up yet, in key order
+    std::deque<std::unique_ptr<Batch>> pending;
+    // whether a task is scheduled or running, and whether it is appending
+    // a batch it took from pending
+    bool scheduled;
+    bool appending;
+    // only touched by the task while appending, and by Finish() otherwise
+    trie_type::incremental_builder trie_builder;
+  };
+
+  static void BGWork(void* arg) {
+    std::unique_ptr<std::shared_ptr<State>> state_ptr(
+        static_cast<std::shared_ptr<State>*>(arg));
+    State* state = state_ptr->get();
+    MutexLock l(&state->mu);
+    while (!state->pending.empty()) {
+      std::unique_ptr<Batch> batch(std::move(state->pending.front()));
+      state->pending.pop_front();
+      state->appending = true;
+      state->mu.Unlock();
+      state->AppendBatch(*batch);
+      TEST_SYNC_POINT("OtLexPdtTrieAppender::BGWork:AppendBatch");
+      state->mu.Lock();
+      state->appending = false;
+      state->cv.SignalAll();
+    }
+    state->scheduled = false;
+  }
+
+  static void UnscheduleBGWork(void* arg) {
+    std::unique_ptr<std::shared_ptr<State>> state_ptr(
+        static_cast<std::shared_ptr<State>*>(arg));
+    MutexLock l(&(*state_ptr)->mu);
+    (*state_ptr)->scheduled = false;
+  }
+
+  void Submit() {
+    bool schedule = false;
+    {
+      MutexLock l(&state_->mu);
+      state_->pending.push_back(std::move(batch_));
+      if (!state_->scheduled) {
+        state_->scheduled = true;
+        schedule = true;
+      }
+    }
+    if (schedule) {
+      // tagged with this, to be unscheduled by Finish() or the destructor
+      env_->Schedule(&OtLexPdtTrieAppender::BGWork,
+                     new std::shared_ptr<State>(state_), kPriority, this,
+                     &OtLexPdtTrieAppender::UnscheduleBGWork);
+    }
+  }
+
+  Env* const env_;
+  std::shared_ptr<State> state_;
+  // keys not handed over yet
+  std::unique_ptr<Batch> batch_;
+};
+
 class OtLexPdtBloomBitsBuilder : public FilterBitsBuilder {
  public:
-  explicit OtLexPdtBloomBitsBuilder()
-      :ot_pdt() {
-//    fprintf(stderr, "constructing OtLexPdtBloomBitsBuilder()\n");
+  typedef rocksdb::succinct::tries::path_decomposed_trie<
+      rocksdb::succinct::tries::vbyte_string_pool, true>
+      trie_type;
+
+  // With fingerprint_bits > 0 the trie is approximate: every key is cut
+  // right past the first byte that tells it apart from both its neighbors,
+  // and only that distinguishing prefix goes into the trie, along with a
+  // fingerprint_bits hash of the whole key (see OtLexPdtFingerprints). The
+  // trie then grows with the number of keys rather than with their length,
+  // and lookups get a false positive rate of about 2^-fingerprint_bits.
+  // Ranks still follow the key order, so range and prefix queries keep
+  // working, with false positives at the range bounds.
+  //
+  // With a build_env the trie is built by a background task of build_env
+  // while keys are added, see OtLexPdtTrieAppender.
+  explicit OtLexPdtBloomBitsBuilder(int fingerprint_bits = 0,
+                                    Env* build_env = nullptr)
+      : fingerprint_bits_(
+            std::min(std::max(fingerprint_bits, 0),
+                     static_cast<int>(OtLexPdtFingerprints::kMaxBitsPerKey))),
+        trie_appender_(build_env),
+        num_keys_(0),
+        escaped_keys_(false),
+        last_key_lcp_(0),
+        ot_pdt() {
   }
 
   // No Copy allowed
@@ -35,246 +360,460 @@ class OtLexPdtBloomBitsBuilder : public FilterBitsBuilder {
 
   ~OtLexPdtBloomBitsBuilder() override {}
 
-  virtual void AddKey(const Slice& key) override {
-//    fprintf(stderr, "in OtLexPdtBloomBitsBuilder::AddKey() idpaeq\n");
-    std::string key_string(key.data(), key.data()+key.size());
-    key_strings_.push_back(key_string);
+  // Keys must be added in bytewise order. They are not buffered: each one
+  // extends the compacted trie right away (or as soon as the background
+  // task gets to it), and only the last key is kept to drop duplicates. An approximate trie holds the last key back until the
+  // next one tells how much of it to keep.
+  virtual void AddKey(const Slice& user_key) override {
+    const Slice key = TrieIndex::EscapeKey(user_key, &escape_buf_);
+    if (key.data() != user_key.data()) {
+      escaped_keys_ = true;
+    }
+    if (num_keys_ > 0 && Slice(last_key_) == key) {
+      return;
+    }
+    if (fingerprint_bits_ > 0) {
+      size_t lcp = 0;
+      if (num_keys_ > 0) {
+        const size_t min_len = std::min(last_key_.size(), key.size());
+        while (lcp < min_len && last_key_[lcp] == key[lcp]) {
+          lcp++;
+        }
+        AddDistinguishingPrefix(lcp);
+      }
+      last_key_lcp_ = lcp;
+      last_key_.assign(key.data(), key.size());
+    } else {
+      last_key_.assign(key.data(), key.size());
+      trie_appender_.Append(last_key_);
+    }
+    num_keys_++;
   }
 
-  uint32_t CalculateSpace(const int num_entry) {
-    return static_cast<uint32_t>(CalculateByteSpace());
+  // Number of distinct keys added since the last Finish()
+  uint64_t NumKeys() const { return num_keys_; }
+
+  // Records a data block of the table for the block index. first_rank is
+  // the number of distinct keys added before the block. Blocks must be
+  // added in file order, and either all or none of them.
+  void AddDataBlock(uint64_t first_rank, uint64_t offset, uint64_t size) {
+    block_first_ranks_.push_back(first_rank);
+    block_extents_.push_back(offset);
+    block_extents_.push_back(offset + size);
   }
 
+  // The block generated by Finish() is
+  // +----------------------------------------------------------------+
+  // | freeze flags (8 bytes)                                         |
+  // +----------------------------------------------------------------+
+  // | frozen ot lex pdt, every section padded to 8 bytes             |
+  // +----------------------------------------------------------------+
+  // | frozen OtLexPdtBlockIndex, only if data blocks were added      |
+  // +----------------------------------------------------------------+
+  // | trailer: kOtLexPdtMetadataLen bytes                            |
+  // +----------------------------------------------------------------+
   virtual Slice Finish(std::unique_ptr<const char[]>* buf) override {
-//    fprintf(stderr, "in OtLexPdtBloomBitsBuilder::Finish() 8qpeye\n");
-    // generate a compacted trie and get essential data
-    assert(key_strings_.size() > 0);
-    key_strings_.erase(unique(key_strings_.begin(),
-                              key_strings_.end()),
-                       key_strings_.end()); //xp, for now simply dedup keys
-
-//    fprintf(stdout, "DEBUG w7zvbg key_strings_.size: %lu\n", key_strings_.size());
-
-    //auto chrono_start = std::chrono::system_clock::now();
-    ot_pdt.construct_compacted_trie(key_strings_, false); // ot_pdt.pub_ are inited
-    // auto chrono_end = std::chrono::system_clock::now();
-    // std::chrono::microseconds elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(chrono_end-chrono_start);
-    // std::cout << "DEBUG 3yb6fo Finis() ot_pdt use " << key_strings_.size() << " keys build raw trie takes(us) " <<
-    //           elapsed_us.count() << std::endl;
-
-    // get the byte size of key_strings_
-    uint64_t ot_lex_pdt_byte_size = CalculateByteSpace();
-    assert(ot_lex_pdt_byte_size > 0);
-    uint64_t buf_byte_size = ot_lex_pdt_byte_size + 5;
-//    fprintf(stderr, "DEBUG 10dk3 compacted trie byte size: %lu\n", buf_byte_size);
-
-    char* contents = new char[buf_byte_size];
-    memset(contents, 0, buf_byte_size);
-    assert(contents);
-
-    //xp, be compatible with new bloom filter (full filter)
-    // See BloomFilterPolicy::GetBloomBitsReader re: metadata
+    assert(num_keys_ > 0);
+    if (fingerprint_bits_ > 0) {
+      AddDistinguishingPrefix(0);
+    }
+    // complete the trie, including its rank/select and excess indexes, so
+    // that opening the block on the read side costs O(1)
+    trie_appender_.Finish(&ot_pdt);
+    const uint64_t num_keys = num_keys_;
+    num_keys_ = 0;
+    last_key_.clear();
+
+    std::ostringstream frozen;
+    rocksdb::succinct::mapper::freeze(
+        ot_pdt, frozen, rocksdb::succinct::mapper::freeze_flags::aligned);
+    if (fingerprint_bits_ > 0) {
+      OtLexPdtFingerprints fingerprints(fingerprint_bits_, &fingerprints_);
+      rocksdb::succinct::mapper::freeze(
+          fingerprints, frozen,
+          rocksdb::succinct::mapper::freeze_flags::aligned);
+      rocksdb::succinct::bit_vector_builder().swap(fingerprints_);
+    }
+    char flags = 0;
+    if (!block_first_ranks_.empty() &&
+        block_first_ranks_.back() <= num_keys) {
+      OtLexPdtBlockIndex block_index(block_first_ranks_, block_extents_,
+                                     num_keys);
+      rocksdb::succinct::mapper::freeze(
+          block_index, frozen,
+          rocksdb::succinct::mapper::freeze_flags::aligned);
+      flags |= kOtLexPdtHasBlockIndex;
+    }
+    block_first_ranks_.clear();
+    block_extents_.clear();
+    if (escaped_keys_) {
+      flags |= kOtLexPdtEscapedKeys;
+      escaped_keys_ = false;
+    }
+    const std::string& frozen_trie = frozen.str();
+
+    size_t len_with_metadata = frozen_trie.size() + kOtLexPdtMetadataLen;
+    char* contents = new char[len_with_metadata];
+    memcpy(contents, frozen_trie.data(), frozen_trie.size());
+
+    char* metadata = contents + frozen_trie.size();
     // -1 = Marker for newer Bloom implementations
-    char new_impl = static_cast<char>(-1);
-//    contents[byte_size] = static_cast<char>(-1);
-    // 0 = Marker for this sub-implementation, ot lex pdt
-    char sub_impl = static_cast<char>(80); // 'P'
-//    contents[byte_size+1] = static_cast<char>(5);
-    // just for padding
+    metadata[0] = static_cast<char>(-1);
+    metadata[1] =
+        fingerprint_bits_ > 0 ? kOtLexPdtApproxSubImpl : kOtLexPdtMappedSubImpl;
     // when full filter: num_probes (and 0 in upper bits for 64-byte block size)
-    char fake_num_probes = static_cast<char>(7);
-//    contents[byte_size+2] = static_cast<char>(7);
-    // rest of metadata (2 chars) are paddings
-
-    // format essential data with format
-    // vec<uint16_t>,
-    // vec<uint16_t>,
-    // vec<uint8_t>,
-    // vec<uint8_t>,
-    // vec<uint64_t>,
-    // uint64_t
-    // char
-    // char
-    // char
-    // & ot lex pdt byte size
-    // target buffer
-//    fprintf(stdout, "DEBUG a3gcn6 in otFinish sizes for string,label,branch,char,bit,size:%ld,%ld,%ld,%ld,%ld,%ld\n",
-//            ot_pdt.pub_m_centroid_path_string.size(),
-//            ot_pdt.pub_m_labels.size(),
-//            ot_pdt.pub_m_centroid_path_branches.size(),
-//            ot_pdt.pub_m_branching_chars.size(),
-//            ot_pdt.pub_m_bp_m_bits.size(),
-//            ot_pdt.pub_m_bp_m_size);
-    PutIntoCharArray(ot_pdt.pub_m_centroid_path_string,
-                     ot_pdt.pub_m_labels,
-                     ot_pdt.pub_m_centroid_path_branches,
-                     ot_pdt.pub_m_branching_chars,
-                     ot_pdt.pub_m_bp_m_bits,
-                     ot_pdt.pub_m_bp_m_size,
-                     new_impl,
-                     sub_impl,
-                     fake_num_probes,
-                     buf_byte_size,
-                     contents);
-
-//    for (size_t i = 0; i < ot_pdt.pub_m_centroid_path_string.size(); i++) {
-//      fprintf(stdout, "Pstring:%ld,%d\n", i, ot_pdt.pub_m_centroid_path_string[i]);
-//    }
-//    for (size_t i = 0; i < ot_pdt.pub_m_labels.size(); i++) {
-//      fprintf(stdout, "Plabel:%ld,%d\n", i, ot_pdt.pub_m_labels[i]);
-//    }
-//    for (size_t i = 0; i < ot_pdt.pub_m_centroid_path_branches.size(); i++) {
-//      fprintf(stdout, "Pbranch:%ld,%d\n", i, ot_pdt.pub_m_centroid_path_branches[i]);
-//    }
-//    for (size_t i = 0; i < ot_pdt.pub_m_branching_chars.size(); i++) {
-//      fprintf(stdout, "Pchar:%ld,%d\n", i, ot_pdt.pub_m_branching_chars[i]);
-//    }
-//    for (size_t i = 0; i < ot_pdt.pub_m_bp_m_bits.size(); i++) {
-//      fprintf(stdout, "Pbit:%ld,%ld\n", i, ot_pdt.pub_m_bp_m_bits[i]);
-//    }
-
-    assert(sizeof(ot_pdt.pub_m_bp_m_size) != 0);
-
-    // return a Slice with data and its byte length
+    metadata[2] = static_cast<char>(7);
+    // flags, then padding
+    metadata[3] = flags;
+    metadata[4] = 0;
+
     const char* const_data = contents;
     buf->reset(const_data);
-    key_strings_.clear();
-    return Slice(contents, buf_byte_size);
-//=============
-//    uint32_t len_with_metadata =
-//        CalculateSpace(static_cast<uint32_t>(hash_entries_.size()));
-//    char* data = new char[len_with_metadata];
-//    memset(data, 0, len_with_metadata);
-//
-//    assert(data);
-//    assert(len_with_metadata >= 5);
-//
-//    uint32_t len = len_with_metadata - 5;
-//    if (len > 0) {
-//      AddAllEntries(data, len);
-//    }
-
-    // See BloomFilterPolicy::GetBloomBitsReader re: metadata
-    // -1 = Marker for newer Bloom implementations
-//    data[len] = static_cast<char>(-1);
-    // 0 = Marker for this sub-implementation
-//    data[len + 1] = static_cast<char>(0);
-    // num_probes (and 0 in upper bits for 64-byte block size)
-//    data[len + 2] = static_cast<char>(num_probes_);
-    // rest of metadata stays zero
-
-//    const char* const_data = data;
-//    buf->reset(const_data);
-//    hash_entries_.clear();
-//    return Slice(data, len_with_metadata);
-  }
-
-  // ot lex pdt used byte size
-  uint64_t CalculateByteSpace() {
-    // calculate the byte size of format buf
-    return (ot_pdt.pub_m_centroid_path_string.size()+ot_pdt.pub_m_labels.size())*2 +
-        ot_pdt.pub_m_centroid_path_branches.size()+ ot_pdt.pub_m_branching_chars.size() +
-        ot_pdt.pub_m_bp_m_bits.size() * 8 + 8 +
-        5 * 4; // sizes of above vectors
-  }
-
-  // put essential data into char[], and this char[] will be stored in the Slice
-  // of a particular Table.
-  //  NOTE: total used byte == byte_size (ot lex pdt byte size) + 5
-  char* PutIntoCharArray(std::vector<uint16_t>& v1, std::vector<uint16_t>& v2,
-                         std::vector<uint8_t>& v3, std::vector<uint8_t>& v4,
-                         std::vector<uint64_t>& v5, uint64_t num,
-                         char new_impl, char sub_impl, char fake_num_probes,
-                         uint64_t& byte_size, char*& buf) {
-//    byte_size =
-//        (v1.size() + v2.size()) * 2 + v3.size() + v4.size() + v5.size() * 8 + 8;
-//    byte_size += 5 * 4 + 5;  //指明4个vector的size + 5 padding chars
-//
-    buf = new char[byte_size];
-    memset(buf, 0, byte_size);
-
-    uint32_t* p = (uint32_t*)buf;
-    *p = v1.size();
-    uint16_t* p1 = (uint16_t*)(buf + 4);
-    for (uint32_t i = 0; i < v1.size(); i++) {
-      *p1 = v1[i];
-      p1++;
+    return Slice(contents, len_with_metadata);
+  }
+
+  // Adds the key held back by an approximate trie, next_lcp being the
+  // length of the prefix it shares with the key after it
+  void AddDistinguishingPrefix(size_t next_lcp) {
+    const size_t prefix_len = std::min(
+        last_key_.size(), std::max(last_key_lcp_, next_lcp) + 1);
+    key_prefix_.assign(last_key_, 0, prefix_len);
+    trie_appender_.Append(key_prefix_);
+    fingerprints_.append_bits(
+        OtLexPdtFingerprints::Fingerprint(last_key_, fingerprint_bits_),
+        fingerprint_bits_);
+  }
+
+  // 0 for an exact trie
+  const int fingerprint_bits_;
+
+  // the trie of the keys added since the last Finish(), and the last of them
+  OtLexPdtTrieAppender trie_appender_;
+  std::string last_key_;
+  uint64_t num_keys_;
+  // whether any key was escaped, see kOtLexPdtEscapedKeys
+  bool escaped_keys_;
+  std::string escape_buf_;
+  // approximate trie only: the length of the prefix last_key_ shares with
+  // the key before it, the fingerprints of the keys added so far, and the
+  // distinguishing prefix being added
+  size_t last_key_lcp_;
+  rocksdb::succinct::bit_vector_builder fingerprints_;
+  std::string key_prefix_;
+  // data blocks recorded by AddDataBlock(), see OtLexPdtBlockIndex
+  std::vector<uint64_t> block_first_ranks_;
+  std::vector<uint64_t> block_extents_;
+
+  // the ot lex pdt completed by trie_appender_ in Finish()
+  trie_type ot_pdt;
+};
+
+//wp
+class OtLexPdtBloomBitsReader : public FilterBitsReader {
+ public:
+  typedef rocksdb::succinct::tries::path_decomposed_trie<
+      rocksdb::succinct::tries::vbyte_string_pool, true>
+      trie_type;
+
+  // contents is a block generated by OtLexPdtBloomBitsBuilder::Finish(). It
+  // must outlive this reader, as the trie may point into it.
+  explicit OtLexPdtBloomBitsReader(const Slice& contents)
+      : empty_(true),
+        approximate_(false),
+        has_block_index_(false),
+        escaped_keys_(false),
+        memory_usage_(0) {
+    if (contents.size() <= kOtLexPdtMetadataLen) {
+      return;
     }
+    empty_ = false;
+    const char sub_impl = contents.data()[contents.size() - 4];
+    if (sub_impl == kOtLexPdtMappedSubImpl ||
+        sub_impl == kOtLexPdtApproxSubImpl) {
+      approximate_ = sub_impl == kOtLexPdtApproxSubImpl;
+      MapTrie(contents);
+    } else {
+      RebuildTrie(contents.data());
+    }
+  }
 
-    p = (uint32_t*)(buf + 4 + v1.size() * 2);
-    *p = v2.size();
-    p1 = (uint16_t*)(buf + 4 + v1.size() * 2 + 4);
-    for (uint32_t i = 0; i < v2.size(); i++) {
-      *p1 = v2[i];
-      p1++;
+  // No Copy allowed
+  OtLexPdtBloomBitsReader(const OtLexPdtBloomBitsReader&) = delete;
+  void operator=(const OtLexPdtBloomBitsReader&) = delete;
+
+  ~OtLexPdtBloomBitsReader() override {}
+
+  bool MayMatch(const Slice& key) override {
+    return KeyRank(key) != kOtLexPdtNotFound;
+  }
+
+  // The keys of an exact trie are looked up together, see
+  // trie_type::index_batch()
+  virtual void MayMatch(int num_keys, Slice** keys, bool* may_match) override {
+    if (empty_ || approximate_) {
+      for (int i = 0; i < num_keys; ++i) {
+        may_match[i] = KeyRank(*keys[i]) != kOtLexPdtNotFound;
+      }
+      return;
     }
+    const uint8_t* key_data[trie_type::kMaxBatch];
+    size_t key_lens[trie_type::kMaxBatch];
+    size_t ranks[trie_type::kMaxBatch];
+    // escaped keys, only used by filters with kOtLexPdtEscapedKeys
+    std::string bufs[trie_type::kMaxBatch];
+    for (int base = 0; base < num_keys;
+         base += static_cast<int>(trie_type::kMaxBatch)) {
+      size_t cnt = std::min(static_cast<size_t>(num_keys - base),
+                            static_cast<size_t>(trie_type::kMaxBatch));
+      for (size_t i = 0; i < cnt; ++i) {
+        const Slice key = TrieKey(*keys[base + i], &bufs[i]);
+        key_data[i] = reinterpret_cast<const uint8_t*>(key.data());
+        key_lens[i] = key.size();
+      }
+      ot_pdt.index_batch(key_data, key_lens, cnt, ranks);
+      for (size_t i = 0; i < cnt; ++i) {
+        may_match[base + i] = ranks[i] != kOtLexPdtNotFound;
+      }
+    }
+  }
 
-    p = (uint32_t*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2);
-    *p = v3.size();
-    uint8_t* p2 = (uint8_t*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4);
-    for (uint32_t i = 0; i < v3.size(); i++) {
-      *p2 = v3[i];
-      p2++;
+  // The reader itself plus whatever it decoded on top of the filter block,
+  // so a cached ParsedFullFilterBlock is charged with its real size
+  size_t ApproximateMemoryUsage() const override {
+    return sizeof(*this) + memory_usage_;
+  }
+
+  // Rank of key among the distinct keys of the table, or kOtLexPdtNotFound.
+  // An approximate trie may return the rank of another key for a missing
+  // one, see OtLexPdtFingerprints.
+  size_t KeyRank(const Slice& user_key) const {
+    if (empty_) {
+      return kOtLexPdtNotFound;
+    }
+    std::string buf;
+    const Slice key = TrieKey(user_key, &buf);
+    if (!approximate_) {
+      return ot_pdt.index(reinterpret_cast<const uint8_t*>(key.data()),
+                          key.size());
+    }
+    // a table key is found through the longest of the stored prefixes of
+    // it, which is its own
+    size_t rank = ot_pdt.longest_prefix(
+        reinterpret_cast<const uint8_t*>(key.data()), key.size());
+    if (rank == kOtLexPdtNotFound || !fingerprints_.Matches(rank, key)) {
+      return kOtLexPdtNotFound;
     }
+    return rank;
+  }
 
-    p = (uint32_t*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                    v3.size());
-    *p = v4.size();
-    p2 = (uint8_t*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                    v3.size() + 4);
-    for (uint32_t i = 0; i < v4.size(); i++) {
-      *p2 = v4[i];
-      p2++;
+  // Whether any key of the table lies in [lower, *upper), or is not less
+  // than lower if upper is nullptr. Exact, as the trie holds every key,
+  // unless it is approximate: the key of a stored prefix of lower may then
+  // not be less than lower, so that prefix is counted in.
+  bool RangeMayExist(const Slice& user_lower, const Slice* upper) const {
+    if (empty_) {
+      return false;
     }
+    // escaping keeps the order of the keys, so the bounds still hold
+    std::string lower_buf, upper_buf;
+    const Slice lower = TrieKey(user_lower, &lower_buf);
+    Slice trie_upper;
+    if (upper != nullptr) {
+      trie_upper = TrieKey(*upper, &upper_buf);
+    }
+    size_t first = ot_pdt.lower_bound(
+        reinterpret_cast<const uint8_t*>(lower.data()), lower.size());
+    if (approximate_ && first > 0 &&
+        ot_pdt.longest_prefix(reinterpret_cast<const uint8_t*>(lower.data()),
+                              lower.size()) == first - 1) {
+      first--;
+    }
+    size_t last =
+        upper == nullptr
+            ? ot_pdt.size()
+            : ot_pdt.lower_bound(
+                  reinterpret_cast<const uint8_t*>(trie_upper.data()),
+                  trie_upper.size());
+    return first < last;
+  }
 
-    p = (uint32_t*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                    v3.size() + 4 + v4.size());
-    *p = v5.size();
-    // fprintf(stderr, "DEBUG h8qd8z PutIntoCharArray m_bits.size(): %u\n", *p);
-    uint64_t* p4 = (uint64_t*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                               v3.size() + 4 + v4.size() + 4);
-    for (uint32_t i = 0; i < v5.size(); i++) {
-      *p4 = v5[i];
-      p4++;
+  // Whether any key of the table starts with prefix
+  bool PrefixMayExist(const Slice& prefix) const {
+    // the keys with the prefix are the ones in [prefix, successor), where the
+    // successor drops the trailing 0xff bytes and increments the last one
+    size_t n = prefix.size();
+    while (n > 0 && static_cast<unsigned char>(prefix[n - 1]) == 0xff) {
+      n--;
     }
+    if (n == 0) {
+      return RangeMayExist(prefix, nullptr);
+    }
+    std::string successor(prefix.data(), n);
+    successor[n - 1]++;
+    Slice upper(successor);
+    return RangeMayExist(prefix, &upper);
+  }
+
+  // True if the block also maps key ranks to data blocks, see
+  // OtLexPdtBlockIndex
+  bool HasBlockIndex() const { return has_block_index_; }
+  const OtLexPdtBlockIndex& block_index() const {
+    assert(has_block_index_);
+    return block_index_;
+  }
 
-    uint64_t* p3 = (uint64_t*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                               v3.size() + 4 + v4.size() + 4 + v5.size() * 8);
-    *p3 = num;
-//    fprintf(stderr, "DEBUG yz92dt PutIntoCharArray num: %lu, *p3:%lu\n", num, *p3);
+ private:
+  // key as stored in the trie, see kOtLexPdtEscapedKeys
+  Slice TrieKey(const Slice& key, std::string* buf) const {
+    return escaped_keys_ ? TrieIndex::EscapeKey(key, buf) : key;
+  }
 
-    // new bloom filter implementation indicators for GetBloomBitsReader
-    char* pc1 = (char*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                        v3.size() + 4 + v4.size() + 4 + v5.size() * 8 + 8);
-    *pc1 = new_impl;
-    char* pc2 = (char*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                        v3.size() + 4 + v4.size() + 4 + v5.size() * 8 + 8 + 1);
-    *pc2 = sub_impl;
-    char* pc3 = (char*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-                        v3.size() + 4 + v4.size() + 4 + v5.size() * 8 + 8 + 1 + 1);
-    *pc3 = fake_num_probes;
-//    char* pc4 = (char*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-//                        v3.size() + 4 + v4.size() + 4 + v5.size() * 8 + 8 + 1 + 1 + 1);
-//    *pc4 = static_cast<char>(0);
-//    char* pc5 = (char*)(buf + 4 + v1.size() * 2 + 4 + v2.size() * 2 + 4 +
-//                        v3.size() + 4 + v4.size() + 4 + v5.size() * 8 + 8 + 1 + 1 + 1 + 1);
-//    *pc5 = static_cast<char>(0);
+  // The block holds a trie frozen with mapper::freeze_flags::aligned, so the
+  // trie is used in place. Only when the block itself is not 8-byte aligned
+  // (e.g. it lives at an arbitrary offset of an mmap'd file) do we take a
+  // single aligned copy of it.
+  void MapTrie(const Slice& contents) {
+    const char* base = contents.data();
+    const size_t frozen_size = contents.size() - kOtLexPdtMetadataLen;
+    if (reinterpret_cast<uintptr_t>(base) % sizeof(uint64_t) != 0) {
+      size_t num_words = (frozen_size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+      aligned_copy_.reset(new uint64_t[num_words]);
+      memcpy(aligned_copy_.get(), base, frozen_size);
+      base = reinterpret_cast<const char*>(aligned_copy_.get());
+      memory_usage_ += num_words * sizeof(uint64_t);
+    }
+    size_t mapped = rocksdb::succinct::mapper::map(ot_pdt, base);
+    assert(mapped <= frozen_size);
+    if (approximate_) {
+      mapped += rocksdb::succinct::mapper::map(fingerprints_, base + mapped);
+      assert(mapped <= frozen_size);
+    }
+    escaped_keys_ =
+        (contents.data()[contents.size() - 2] & kOtLexPdtEscapedKeys) != 0;
+    if ((contents.data()[contents.size() - 2] & kOtLexPdtHasBlockIndex) &&
+        mapped < frozen_size) {
+      mapped += rocksdb::succinct::mapper::map(block_index_, base + mapped);
+      assert(mapped <= frozen_size);
+      has_block_index_ = true;
+    }
+    (void)mapped;
+  }
 
-    return buf;
+  // Blocks written before the mapped format only carry the raw builder
+  // vectors, so the trie and its indexes have to be rebuilt in memory.
+  void RebuildTrie(const char* buf) {
+    ot_pdt.pub_m_centroid_path_string.clear();
+    ot_pdt.pub_m_labels.clear();
+    ot_pdt.pub_m_centroid_path_branches.clear();
+    ot_pdt.pub_m_branching_chars.clear();
+    ot_pdt.pub_m_bp_m_bits.clear();
+    char new_impl, sub_impl, fake_num_probes;
+    RecoverFromCharArray(ot_pdt.pub_m_centroid_path_string,
+                         ot_pdt.pub_m_labels,
+                         ot_pdt.pub_m_centroid_path_branches,
+                         ot_pdt.pub_m_branching_chars,
+                         ot_pdt.pub_m_bp_m_bits,
+                         ot_pdt.pub_m_bp_m_size,
+                         new_impl,
+                         sub_impl,
+                         fake_num_probes,
+                         buf);
+    ot_pdt.instance();
+    // instance() copied everything into the trie, drop the staging vectors
+    // so we do not hold two copies of it
+    std::vector<uint16_t>().swap(ot_pdt.pub_m_centroid_path_string);
+    std::vector<uint16_t>().swap(ot_pdt.pub_m_labels);
+    std::vector<uint8_t>().swap(ot_pdt.pub_m_centroid_path_branches);
+    std::vector<uint8_t>().swap(ot_pdt.pub_m_branching_chars);
+    std::vector<uint64_t>().swap(ot_pdt.pub_m_bp_m_bits);
+    memory_usage_ += rocksdb::succinct::mapper::size_of(ot_pdt);
   }
 
+  //wp
+  void RecoverFromCharArray(std::vector<uint16_t>& v1,
+                            std::vector<uint16_t>& v2,
+                            std::vector<uint8_t>& v3,
+                            std::vector<uint8_t>& v4,
+                            std::vector<uint64_t>& v5,
+                            uint64_t& num,
+                            char& tmp_new_impl,
+                            char& tmp_sub_impl,
+                            char& tmp_fake_num_probes,
+                            const char* & buf) {
+    uint32_t size1 = 0, size2 = 0, size3 = 0, size4 = 0, size5 = 0;
+
+    uint32_t *p = (uint32_t *) buf;
+    size1 = *p;
+    uint16_t *p1 = (uint16_t *) (buf + 4);
+    v1.resize(size1);
+    for (uint64_t i = 0; i < size1; i++) {
+      v1[i] = *p1;
+      p1++;
+    }
 
-  std::vector<std::string> key_strings_;  // vector for Slice.data
+    p = (uint32_t *) (buf + 4 + size1 * 2);
+    size2 = *p;
+    p1 = (uint16_t *) (buf + 4 + size1 * 2 + 4);
+    v2.resize(size2);
+    for (uint64_t i = 0; i < size2; i++) {
+      v2[i] = *p1;
+      p1++;
+    }
 
-  // a compacted trie, NO need for a ot lex pdt yet
-  rocksdb::succinct::tries::path_decomposed_trie<
-      rocksdb::succinct::tries::vbyte_string_pool, true>
-      ot_pdt;
-};
+    p = (uint32_t *) (buf + 4 + size1 * 2 + 4 + size2 * 2);
+    size3 = *p;
+    uint8_t *p2 = (uint8_t *) (buf + 4 + size1 * 2 + 4 + size2 * 2 + 4);
+    v3.resize(size3);
+    for (uint64_t i = 0; i < size3; i++) {
+      v3[i] = *p2;
+      p2++;
+    }
+
+    p = (uint32_t *) (buf + 4 + size1 * 2 + 4 + size2 * 2 + 4 + size3);
+    size4 = *p;
+    p2 = (uint8_t *) (buf + 4 + size1 * 2 + 4 + size2 * 2 + 4 + size3 + 4);
+    v4.resize(size4);
+    for (uint64_t i = 0; i < size4; i++) {
+      v4[i] = *p2;
+      p2++;
+    }
 
+    p = (uint32_t *) (buf + 4 + size1 * 2 + 4 + size2 * 2 + 4 + size3 + 4 + size4);
+    size5 = *p;
+    uint64_t *p4 = (uint64_t *) (buf + 4 + size1 * 2 + 4 + size2 * 2 + 4 + size3 + 4 + size4 + 4);
+    v5.resize(size5);
+    for (uint64_t i = 0; i < size5; i++) {
+      v5[i] = *p4;
+      p4++;
+    }
 
+    uint64_t *p3 = (uint64_t *) (buf + 4 + size1 * 2 + 4 + size2 * 2 + 4 + size3 + 4 + size4 + 4 + size5 * 8);
+    num = *p3;
 
+    //xp, be compatible with full filter
+    const char* trailer = buf + 4 + size1 * 2 + 4 + size2 * 2 + 4 + size3 + 4 + size4 + 4 + size5 * 8 + 8;
+    tmp_new_impl = trailer[0];
+    tmp_sub_impl = trailer[1];
+    tmp_fake_num_probes = trailer[2];
+  }
 
+  bool empty_;
+  // the trie only holds distinguishing prefixes, see OtLexPdtBloomBitsBuilder
+  bool approximate_;
+  bool has_block_index_;
+  // see kOtLexPdtEscapedKeys
+  bool escaped_keys_;
+  // bytes held by this reader on top of the filter block itself
+  size_t memory_usage_;
+  // aligned copy of the filter block, only used when the block is unaligned
+  std::unique_ptr<uint64_t[]> aligned_copy_;
+  // a ot lex pdt, either mapped onto the filter block or rebuilt from it
+  trie_type ot_pdt;
+  // fingerprints of the keys, only valid if approximate_
+  OtLexPdtFingerprints fingerprints_;
+  // maps key ranks to data blocks, only valid if has_block_index_
+  OtLexPdtBlockIndex block_index_;
+};
 
 class FullFilterBitsBuilder : public FilterBitsBuilder {
  public:
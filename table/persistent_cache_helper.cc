@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include "table/persistent_cache_helper.h"
+#include "monitoring/perf_context_imp.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/format.h"
 
@@ -59,10 +60,15 @@ Status PersistentCacheHelper::LookupRawPage(
                                           handle, cache_key);
   // Lookup page
   size_t size;
-  Status s = cache_options.persistent_cache->Lookup(key, raw_data, &size,fname);
+  Status s;
+  {
+    PERF_TIMER_GUARD(persistent_cache_read_time);
+    s = cache_options.persistent_cache->Lookup(key, raw_data, &size, fname);
+  }
   if (!s.ok()) {
     // cache miss
     RecordTick(cache_options.statistics, PERSISTENT_CACHE_MISS);
+    PERF_COUNTER_ADD(persistent_cache_miss_count, 1);
     return s;
   }
 
@@ -70,6 +76,7 @@ Status PersistentCacheHelper::LookupRawPage(
   assert(raw_data_size == handle.size() + kBlockTrailerSize);
   assert(size == raw_data_size);
   RecordTick(cache_options.statistics, PERSISTENT_CACHE_HIT);
+  PERF_COUNTER_ADD(persistent_cache_hit_count, 1);
   return Status::OK();
 }
 
@@ -92,10 +99,15 @@ Status PersistentCacheHelper::LookupUncompressedPage(
   // Lookup page
   std::unique_ptr<char[]> data;
   size_t size;
-  Status s = cache_options.persistent_cache->Lookup(key, &data, &size,fname);
+  Status s;
+  {
+    PERF_TIMER_GUARD(persistent_cache_read_time);
+    s = cache_options.persistent_cache->Lookup(key, &data, &size, fname);
+  }
   if (!s.ok()) {
     // cache miss
     RecordTick(cache_options.statistics, PERSISTENT_CACHE_MISS);
+    PERF_COUNTER_ADD(persistent_cache_miss_count, 1);
     return s;
   }
 
@@ -105,6 +117,7 @@ Status PersistentCacheHelper::LookupUncompressedPage(
 
   // update stats
   RecordTick(cache_options.statistics, PERSISTENT_CACHE_HIT);
+  PERF_COUNTER_ADD(persistent_cache_hit_count, 1);
   // construct result and return
   *contents = BlockContents(std::move(data), size);
   return Status::OK();
@@ -29,6 +29,9 @@ struct PersistentCacheOptions {
   std::shared_ptr<PersistentCache> persistent_cache;
   std::string key_prefix;
   Statistics* statistics = nullptr;
+  // the pages are inserted when they leave the block cache, not when they
+  // are read from the file
+  bool demote_on_evict = false;
 };
 
 }  // namespace rocksdb
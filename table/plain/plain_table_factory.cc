@@ -11,6 +11,7 @@
 #include "db/dbformat.h"
 #include "options/options_helper.h"
 #include "port/port.h"
+#include "rocksdb/comparator.h"
 #include "rocksdb/convenience.h"
 #include "table/plain/plain_table_builder.h"
 #include "table/plain/plain_table_reader.h"
@@ -29,7 +30,7 @@ Status PlainTableFactory::NewTableReader(
       table, table_options_.bloom_bits_per_key, table_options_.hash_table_ratio,
       table_options_.index_sparseness, table_options_.huge_page_tlb_size,
       table_options_.full_scan_mode, table_reader_options.immortal,
-      table_reader_options.prefix_extractor);
+      table_reader_options.prefix_extractor, table_options_.prefix_trie_index);
 }
 
 TableBuilder* PlainTableFactory::NewTableBuilder(
@@ -49,6 +50,17 @@ TableBuilder* PlainTableFactory::NewTableBuilder(
       table_options_.store_index_in_file);
 }
 
+Status PlainTableFactory::SanitizeOptions(
+    const DBOptions& /*db_opts*/, const ColumnFamilyOptions& cf_opts) const {
+  if (table_options_.prefix_trie_index &&
+      cf_opts.comparator != BytewiseComparator()) {
+    return Status::InvalidArgument(
+        "Prefix trie index is specified for plain table, but the comparator "
+        "is not bytewise");
+  }
+  return Status::OK();
+}
+
 std::string PlainTableFactory::GetPrintableTableOptions() const {
   std::string ret;
   ret.reserve(20000);
@@ -79,6 +91,9 @@ std::string PlainTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  store_index_in_file: %d\n",
            table_options_.store_index_in_file);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  prefix_trie_index: %d\n",
+           table_options_.prefix_trie_index);
+  ret.append(buffer);
   return ret;
 }
 
@@ -176,11 +176,8 @@ class PlainTableFactory : public TableFactory {
   static const char kValueTypeSeqId0 = char(~0);
 
   // Sanitizes the specified DB Options.
-  Status SanitizeOptions(
-      const DBOptions& /*db_opts*/,
-      const ColumnFamilyOptions& /*cf_opts*/) const override {
-    return Status::OK();
-  }
+  Status SanitizeOptions(const DBOptions& db_opts,
+                         const ColumnFamilyOptions& cf_opts) const override;
 
   void* GetOptions() override { return &table_options_; }
 
@@ -217,6 +214,9 @@ static std::unordered_map<std::string, OptionTypeInfo> plain_table_type_info = {
       OptionVerificationType::kNormal, false, 0}},
     {"store_index_in_file",
      {offsetof(struct PlainTableOptions, store_index_in_file),
+      OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+    {"prefix_trie_index",
+     {offsetof(struct PlainTableOptions, prefix_trie_index),
       OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}}};
 
 }  // namespace rocksdb
@@ -0,0 +1,96 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef ROCKSDB_LITE
+
+#include "table/plain/plain_table_prefix_trie.h"
+
+namespace rocksdb {
+
+uint64_t PlainTablePrefixTrie::LowerBound(const Slice& prefix,
+                                          bool* exact) const {
+  *exact = false;
+  if (NumPrefixes() == 0) {
+    return 0;
+  }
+  std::string buf;
+  Slice key = TrieIndex::EscapeKey(prefix, &buf);
+  return trie_.lower_bound(reinterpret_cast<const uint8_t*>(key.data()),
+                           key.size(), exact);
+}
+
+size_t PlainTablePrefixTrie::ApproximateMemoryUsage() const {
+  return sizeof(*this) + rocksdb::succinct::mapper::size_of(
+                             const_cast<PlainTablePrefixTrie&>(*this).trie_) +
+         rocksdb::succinct::mapper::size_of(
+             const_cast<PlainTablePrefixTrie&>(*this).first_samples_) +
+         rocksdb::succinct::mapper::size_of(
+             const_cast<PlainTablePrefixTrie&>(*this).sample_offsets_);
+}
+
+Status PlainTablePrefixTrieBuilder::AddKeyPrefix(Slice key_prefix_slice,
+                                                 uint32_t key_offset) {
+  bool is_first_record = trie_builder_.size() == 0;
+  int cmp = is_first_record ? 1 : key_prefix_slice.compare(prev_key_prefix_);
+  if (cmp < 0) {
+    return Status::NotSupported(
+        "PlainTable prefix trie requires the prefix extractor to keep the "
+        "order of the keys");
+  }
+  if (cmp > 0) {
+    Slice escaped = TrieIndex::EscapeKey(key_prefix_slice, &escape_buf_);
+    // keep the null terminator the trie expects
+    trie_key_.assign(escaped.data(), escaped.size());
+    trie_key_.push_back('\0');
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(trie_key_.data());
+    trie_builder_.append(
+        rocksdb::succinct::util::char_range(begin, begin + trie_key_.size()),
+        rocksdb::succinct::util::identity_adaptor());
+    prev_key_prefix_.assign(key_prefix_slice.data(), key_prefix_slice.size());
+    first_samples_.push_back(sample_offsets_.size());
+    num_keys_per_prefix_ = 0;
+    due_index_ = true;
+  }
+
+  if (due_index_) {
+    sample_offsets_.push_back(key_offset);
+    due_index_ = false;
+  }
+
+  num_keys_per_prefix_++;
+  if (index_sparseness_ == 0 || num_keys_per_prefix_ % index_sparseness_ == 0) {
+    due_index_ = true;
+  }
+  return Status::OK();
+}
+
+void PlainTablePrefixTrieBuilder::Finish(PlainTablePrefixTrie* trie) {
+  trie_builder_.finish(trie->trie_);
+  trie->num_samples_ = sample_offsets_.size();
+  if (!first_samples_.empty()) {
+    rocksdb::succinct::elias_fano::elias_fano_builder first_samples_builder(
+        sample_offsets_.size(), first_samples_.size());
+    for (uint64_t sample : first_samples_) {
+      first_samples_builder.push_back(sample);
+    }
+    rocksdb::succinct::elias_fano(&first_samples_builder, false)
+        .swap(trie->first_samples_);
+
+    rocksdb::succinct::elias_fano::elias_fano_builder sample_offsets_builder(
+        sample_offsets_.back() + 1, sample_offsets_.size());
+    for (uint64_t offset : sample_offsets_) {
+      sample_offsets_builder.push_back(offset);
+    }
+    rocksdb::succinct::elias_fano(&sample_offsets_builder, false)
+        .swap(trie->sample_offsets_);
+  }
+  first_samples_.clear();
+  sample_offsets_.clear();
+  prev_key_prefix_.clear();
+}
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
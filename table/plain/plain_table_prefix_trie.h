@@ -0,0 +1,109 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "succinct/elias_fano.hpp"
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/block_based/trie_index.h"
+
+namespace rocksdb {
+
+// The file contains two classes PlainTablePrefixTrie and
+// PlainTablePrefixTrieBuilder, an alternative to the hash index of
+// PlainTableIndex selected by PlainTableOptions::prefix_trie_index.
+//
+// The distinct key prefixes of the file are stored once each in a
+// lexicographic path decomposed trie, so a prefix is either found, or known
+// not to be in the file, without probing a bloom filter or decoding a row.
+// The ranks of the trie follow the order of the prefixes, which makes the
+// index usable for total order seeks as well.
+//
+// Like the sub-index of PlainTableIndex, one row in every index_sparseness
+// rows of a prefix, starting from its first one, is sampled. The file
+// offsets of all the samples, and for every prefix the position of its
+// first sample among them, are kept in Elias-Fano sequences. The samples
+// of prefix rank r are then [FirstSample(r), FirstSample(r + 1)), to be
+// binary searched by the reader.
+class PlainTablePrefixTrie {
+ public:
+  PlainTablePrefixTrie() : num_samples_(0) {}
+
+  // No copying allowed
+  PlainTablePrefixTrie(const PlainTablePrefixTrie&) = delete;
+  void operator=(const PlainTablePrefixTrie&) = delete;
+
+  uint64_t NumPrefixes() const { return trie_.size(); }
+
+  // Rank of the first prefix not less than prefix, or NumPrefixes() if there
+  // is none. *exact tells whether that prefix is prefix itself.
+  uint64_t LowerBound(const Slice& prefix, bool* exact) const;
+
+  // Position of the first sample of prefix rank, or the number of samples
+  // for rank NumPrefixes()
+  uint64_t FirstSample(uint64_t rank) const {
+    assert(rank <= NumPrefixes());
+    return rank < NumPrefixes() ? first_samples_.select(rank) : num_samples_;
+  }
+
+  uint32_t SampleOffset(uint64_t sample) const {
+    assert(sample < num_samples_);
+    return static_cast<uint32_t>(sample_offsets_.select(sample));
+  }
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  friend class PlainTablePrefixTrieBuilder;
+
+  TrieIndex::trie_type trie_;
+  uint64_t num_samples_;
+  // position of the first sample of every prefix
+  rocksdb::succinct::elias_fano first_samples_;
+  // file offset of every sample
+  rocksdb::succinct::elias_fano sample_offsets_;
+};
+
+// PlainTablePrefixTrieBuilder collects the prefixes of the rows of a
+// PlainTable, in file order, and builds a PlainTablePrefixTrie of them.
+// The class is used by PlainTableReader class.
+class PlainTablePrefixTrieBuilder {
+ public:
+  explicit PlainTablePrefixTrieBuilder(size_t index_sparseness)
+      : index_sparseness_(index_sparseness),
+        due_index_(false),
+        num_keys_per_prefix_(0) {}
+
+  // Same as PlainTableIndexBuilder::AddKeyPrefix(). Fails if the prefixes
+  // do not come in ascending order, that is if the prefix extractor does not
+  // keep the order of the keys.
+  Status AddKeyPrefix(Slice key_prefix_slice, uint32_t key_offset);
+
+  // Moves the prefixes added so far into *trie
+  void Finish(PlainTablePrefixTrie* trie);
+
+ private:
+  size_t index_sparseness_;
+  bool due_index_;
+  size_t num_keys_per_prefix_;
+  TrieIndex::trie_type::incremental_builder trie_builder_;
+  std::string prev_key_prefix_;
+  std::string escape_buf_;
+  std::string trie_key_;
+  std::vector<uint64_t> first_samples_;
+  std::vector<uint64_t> sample_offsets_;
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -122,7 +122,7 @@ Status PlainTableReader::Open(
     std::unique_ptr<TableReader>* table_reader, const int bloom_bits_per_key,
     double hash_table_ratio, size_t index_sparseness, size_t huge_page_tlb_size,
     bool full_scan_mode, const bool immortal_table,
-    const SliceTransform* prefix_extractor) {
+    const SliceTransform* prefix_extractor, bool prefix_trie_index) {
   if (file_size > PlainTableIndex::kMaxFileSize) {
     return Status::NotSupported("File is too large for PlainTableReader!");
   }
@@ -173,7 +173,8 @@ Status PlainTableReader::Open(
 
   if (!full_scan_mode) {
     s = new_reader->PopulateIndex(props, bloom_bits_per_key, hash_table_ratio,
-                                  index_sparseness, huge_page_tlb_size);
+                                  index_sparseness, huge_page_tlb_size,
+                                  prefix_trie_index);
     if (!s.ok()) {
       return s;
     }
@@ -259,6 +260,36 @@ Status PlainTableReader::PopulateIndexRecordList(
   return s;
 }
 
+Status PlainTableReader::PopulatePrefixTrie(size_t index_sparseness) {
+  uint32_t pos = data_start_offset_;
+  bool is_first_record = true;
+  PlainTableKeyDecoder decoder(&file_info_, encoding_type_, user_key_len_,
+                               prefix_extractor_);
+  PlainTablePrefixTrieBuilder trie_builder(index_sparseness);
+  while (pos < file_info_.data_end_offset) {
+    uint32_t key_offset = pos;
+    ParsedInternalKey key;
+    Slice value_slice;
+    bool seekable = false;
+    Status s = Next(&decoder, &pos, &key, nullptr, &value_slice, &seekable);
+    if (!s.ok()) {
+      return s;
+    }
+    if (!seekable && is_first_record) {
+      return Status::Corruption("Key for a prefix is not seekable");
+    }
+    s = trie_builder.AddKeyPrefix(GetPrefix(key), key_offset);
+    if (!s.ok()) {
+      return s;
+    }
+    is_first_record = false;
+  }
+
+  prefix_trie_.reset(new PlainTablePrefixTrie());
+  trie_builder.Finish(prefix_trie_.get());
+  return Status::OK();
+}
+
 void PlainTableReader::AllocateAndFillBloom(
     int bloom_bits_per_key, int num_prefixes, size_t huge_page_tlb_size,
     std::vector<uint32_t>* prefix_hashes) {
@@ -292,7 +323,8 @@ Status PlainTableReader::PopulateIndex(TableProperties* props,
                                        int bloom_bits_per_key,
                                        double hash_table_ratio,
                                        size_t index_sparseness,
-                                       size_t huge_page_tlb_size) {
+                                       size_t huge_page_tlb_size,
+                                       bool prefix_trie_index) {
   assert(props != nullptr);
   table_properties_.reset(props);
 
@@ -345,6 +377,22 @@ Status PlainTableReader::PopulateIndex(TableProperties* props,
         "PlainTable requires a prefix extractor enable prefix hash mode.");
   }
 
+  if (prefix_trie_index && !index_in_file && !IsTotalOrderMode()) {
+    // The trie answers whether a prefix is in the file by itself, so no
+    // bloom filter is built.
+    s = PopulatePrefixTrie(index_sparseness);
+    if (!s.ok()) {
+      return s;
+    }
+    props->user_collected_properties["plain_table_hash_table_size"] =
+        ToString(0);
+    props->user_collected_properties["plain_table_sub_index_size"] =
+        ToString(0);
+    props->user_collected_properties["plain_table_prefix_trie_size"] =
+        ToString(prefix_trie_->ApproximateMemoryUsage());
+    return Status::OK();
+  }
+
   // First, read the whole file, for every kIndexIntervalForSamePrefixKeys rows
   // for a prefix (starting from the first one), generate a record of (hash,
   // offset) and append it to IndexRecordList, which is a data structure created
@@ -429,6 +477,11 @@ Status PlainTableReader::GetOffset(PlainTableKeyDecoder* decoder,
                                    const Slice& target, const Slice& prefix,
                                    uint32_t prefix_hash, bool& prefix_matched,
                                    uint32_t* offset) const {
+  if (prefix_trie_ != nullptr) {
+    prefix_matched = true;
+    return GetOffsetFromPrefixTrie(decoder, target, prefix,
+                                   false /* total_order_seek */, offset);
+  }
   prefix_matched = false;
   uint32_t prefix_index_offset;
   auto res = index_.GetOffset(prefix_hash, &prefix_index_offset);
@@ -502,6 +555,52 @@ Status PlainTableReader::GetOffset(PlainTableKeyDecoder* decoder,
   return Status::OK();
 }
 
+Status PlainTableReader::GetOffsetFromPrefixTrie(PlainTableKeyDecoder* decoder,
+                                                 const Slice& target,
+                                                 const Slice& prefix,
+                                                 bool total_order_seek,
+                                                 uint32_t* offset) const {
+  bool exact;
+  uint64_t rank = prefix_trie_->LowerBound(prefix, &exact);
+  if (!exact) {
+    // Every key of the prefixes from rank on is larger than target.
+    *offset = total_order_seek && rank < prefix_trie_->NumPrefixes()
+                  ? prefix_trie_->SampleOffset(prefix_trie_->FirstSample(rank))
+                  : file_info_.data_end_offset;
+    return Status::OK();
+  }
+
+  // Binary search the samples of the prefix for the last one whose key is
+  // less than target, or the first one if there is none.
+  uint64_t low = prefix_trie_->FirstSample(rank);
+  uint64_t high = prefix_trie_->FirstSample(rank + 1);
+  ParsedInternalKey mid_key;
+  ParsedInternalKey parsed_target;
+  if (!ParseInternalKey(target, &parsed_target)) {
+    return Status::Corruption(Slice());
+  }
+  while (high - low > 1) {
+    uint64_t mid = (high + low) / 2;
+    uint32_t file_offset = prefix_trie_->SampleOffset(mid);
+    uint32_t tmp;
+    Status s = decoder->NextKeyNoValue(file_offset, &mid_key, nullptr, &tmp);
+    if (!s.ok()) {
+      return s;
+    }
+    int cmp_result = internal_comparator_.Compare(mid_key, parsed_target);
+    if (cmp_result < 0) {
+      low = mid;
+    } else if (cmp_result == 0) {
+      *offset = file_offset;
+      return Status::OK();
+    } else {
+      high = mid;
+    }
+  }
+  *offset = prefix_trie_->SampleOffset(low);
+  return Status::OK();
+}
+
 bool PlainTableReader::MatchBloom(uint32_t hash) const {
   if (!enable_bloom_) {
     return true;
@@ -654,6 +753,27 @@ void PlainTableIterator::SeekToLast() {
 }
 
 void PlainTableIterator::Seek(const Slice& target) {
+  if (!use_prefix_seek_ && table_->prefix_trie_ != nullptr) {
+    // The prefix trie keeps the prefixes in order, so the first key not less
+    // than target is found from the first prefix not less than its own.
+    Slice user_key = table_->GetUserKey(target);
+    Slice prefix = table_->prefix_extractor_->InDomain(user_key)
+                       ? table_->prefix_extractor_->Transform(user_key)
+                       : user_key;
+    status_ = table_->GetOffsetFromPrefixTrie(
+        &decoder_, target, prefix, true /* total_order_seek */, &next_offset_);
+    if (!status_.ok()) {
+      offset_ = next_offset_ = table_->file_info_.data_end_offset;
+      return;
+    }
+    for (Next(); status_.ok() && Valid(); Next()) {
+      if (table_->internal_comparator_.Compare(key(), target) >= 0) {
+        break;
+      }
+    }
+    return;
+  }
+
   if (use_prefix_seek_ != !table_->IsTotalOrderMode()) {
     // This check is done here instead of NewIterator() to permit creating an
     // iterator with total_order_seek = true even if we won't be able to Seek()
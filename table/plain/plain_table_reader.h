@@ -21,6 +21,7 @@
 #include "rocksdb/table_properties.h"
 #include "table/plain/plain_table_factory.h"
 #include "table/plain/plain_table_index.h"
+#include "table/plain/plain_table_prefix_trie.h"
 #include "table/table_reader.h"
 #include "util/dynamic_bloom.h"
 #include "util/file_reader_writer.h"
@@ -75,7 +76,8 @@ class PlainTableReader: public TableReader {
                      const int bloom_bits_per_key, double hash_table_ratio,
                      size_t index_sparseness, size_t huge_page_tlb_size,
                      bool full_scan_mode, const bool immortal_table = false,
-                     const SliceTransform* prefix_extractor = nullptr);
+                     const SliceTransform* prefix_extractor = nullptr,
+                     bool prefix_trie_index = false);
 
   // Returns new iterator over table contents
   // compaction_readahead_size: its value will only be used if for_compaction =
@@ -102,7 +104,11 @@ class PlainTableReader: public TableReader {
   }
 
   virtual size_t ApproximateMemoryUsage() const override {
-    return arena_.MemoryAllocatedBytes();
+    size_t usage = arena_.MemoryAllocatedBytes();
+    if (prefix_trie_ != nullptr) {
+      usage += prefix_trie_->ApproximateMemoryUsage();
+    }
+    return usage;
   }
 
   PlainTableReader(const ImmutableCFOptions& ioptions,
@@ -127,9 +133,11 @@ class PlainTableReader: public TableReader {
   //        the object will be passed.
   //
 
+  // prefix_trie_index: see PlainTableOptions::prefix_trie_index
   Status PopulateIndex(TableProperties* props, int bloom_bits_per_key,
                        double hash_table_ratio, size_t index_sparseness,
-                       size_t huge_page_tlb_size);
+                       size_t huge_page_tlb_size,
+                       bool prefix_trie_index = false);
 
   Status MmapDataIfNeeded();
 
@@ -140,6 +148,8 @@ class PlainTableReader: public TableReader {
   Status status_;
 
   PlainTableIndex index_;
+  // Used instead of index_ if set
+  std::unique_ptr<PlainTablePrefixTrie> prefix_trie_;
   bool full_scan_mode_;
 
   // data_start_offset_ and data_end_offset_ defines the range of the
@@ -206,6 +216,9 @@ class PlainTableReader: public TableReader {
   Status PopulateIndexRecordList(PlainTableIndexBuilder* index_builder,
                                  std::vector<uint32_t>* prefix_hashes);
 
+  // Internal helper function to build prefix_trie_ from all the rows.
+  Status PopulatePrefixTrie(size_t index_sparseness);
+
   // Internal helper function to allocate memory for bloom filter and fill it
   void AllocateAndFillBloom(int bloom_bits_per_key, int num_prefixes,
                             size_t huge_page_tlb_size,
@@ -230,6 +243,15 @@ class PlainTableReader: public TableReader {
   Status GetOffset(PlainTableKeyDecoder* decoder, const Slice& target,
                    const Slice& prefix, uint32_t prefix_hash,
                    bool& prefix_matched, uint32_t* offset) const;
+  // Get file offset for key target from prefix_trie_, where prefix is the
+  // prefix of target. Scanning from there, the first key not less than
+  // target is the one looked for. If no key has prefix, the offset is
+  // data_end_offset, unless total_order_seek is set, in which case it is
+  // the offset of the first key of the next prefix.
+  Status GetOffsetFromPrefixTrie(PlainTableKeyDecoder* decoder,
+                                 const Slice& target, const Slice& prefix,
+                                 bool total_order_seek,
+                                 uint32_t* offset) const;
 
   bool IsTotalOrderMode() const { return (prefix_extractor_ == nullptr); }
 
@@ -1910,6 +1910,141 @@ TEST_P(BlockBasedTableTest, PartitionIndexTest) {
   }
 }
 
+TEST_P(BlockBasedTableTest, PartitionIndexEliasFanoHandlesTest) {
+  const int max_index_keys = 5;
+  const int est_max_index_key_value_size = 32;
+  const int est_max_index_size = max_index_keys * est_max_index_key_value_size;
+  for (int i = 1; i <= est_max_index_size + 1; i++) {
+    BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+    table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+    table_options.elias_fano_partition_handles = true;
+    table_options.index_block_restart_interval = 2;
+    table_options.metadata_block_size = i;
+    IndexTest(table_options);
+  }
+}
+
+TEST_P(BlockBasedTableTest, TrieIndexTest) {
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.index_type = BlockBasedTableOptions::kTrieSearch;
+  IndexTest(table_options);
+}
+
+// Keys with a long shared prefix and 0/1 bytes, plus a user key whose
+// versions span many blocks, read through a trie index and a binary search
+// index over the same data
+TEST_P(BlockBasedTableTest, TrieIndexSeekNextPrev) {
+  InternalKeyComparator icomp(BytewiseComparator());
+  Random rnd(301);
+  const std::string prefix(100, 'p');
+  std::vector<std::pair<std::string, std::string>> entries;
+  for (int i = 0; i < 500; i++) {
+    std::string user_key = prefix + RandomString(&rnd, 8);
+    if (i % 7 == 0) {
+      user_key[prefix.size() + rnd.Uniform(8)] = static_cast<char>(i % 2);
+    }
+    entries.emplace_back(
+        InternalKey(user_key, i, kTypeValue).Encode().ToString(),
+        RandomString(&rnd, 20));
+  }
+  const std::string span_key = prefix + "span";
+  for (int seq = 1; seq <= 300; seq++) {
+    entries.emplace_back(
+        InternalKey(span_key, seq, kTypeValue).Encode().ToString(),
+        RandomString(&rnd, 100));
+  }
+
+  uint64_t index_size[2] = {0, 0};
+  for (int trie = 0; trie < 2; trie++) {
+    for (int cache_index = 0; cache_index < 2; cache_index++) {
+      SCOPED_TRACE("trie = " + ToString(trie) +
+                   ", cache_index = " + ToString(cache_index));
+      BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+      table_options.index_type = trie ? BlockBasedTableOptions::kTrieSearch
+                                      : BlockBasedTableOptions::kBinarySearch;
+      table_options.block_size = 1024;
+      table_options.cache_index_and_filter_blocks = cache_index;
+      table_options.block_cache = NewLRUCache(1 << 20);
+      Options options;
+      options.compression = kNoCompression;
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+      const ImmutableCFOptions ioptions(options);
+      const MutableCFOptions moptions(options);
+
+      TableConstructor c(&icomp);
+      for (const auto& entry : entries) {
+        c.Add(entry.first, entry.second);
+      }
+      std::vector<std::string> keys;
+      stl_wrappers::KVMap kvmap;
+      c.Finish(options, ioptions, moptions, table_options, icomp, &keys,
+               &kvmap);
+      auto props = c.GetTableReader()->GetTableProperties();
+      ASSERT_GT(props->num_data_blocks, 30u);
+      index_size[trie] = props->index_size;
+
+      std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+          ReadOptions(), /*prefix_extractor=*/nullptr, /*arena=*/nullptr,
+          /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+      size_t i = 0;
+      for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+        ASSERT_LT(i, keys.size());
+        ASSERT_EQ(keys[i], iter->key().ToString());
+        ASSERT_EQ(kvmap[keys[i]], iter->value().ToString());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(keys.size(), i);
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        ASSERT_GT(i, 0u);
+        ASSERT_EQ(keys[--i], iter->key().ToString());
+      }
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(0u, i);
+
+      for (int q = 0; q < 2000; q++) {
+        std::string user_key =
+            q % 2 == 0 ? ExtractUserKey(keys[rnd.Uniform(
+                                            static_cast<int>(keys.size()))])
+                             .ToString()
+                       : prefix + RandomString(&rnd, rnd.Uniform(9));
+        std::string target =
+            InternalKey(user_key, rnd.Uniform(310), kTypeValue)
+                .Encode()
+                .ToString();
+        auto expected = std::lower_bound(
+            keys.begin(), keys.end(), target,
+            [&](const std::string& a, const std::string& b) {
+              return icomp.Compare(a, b) < 0;
+            });
+        iter->Seek(target);
+        ASSERT_OK(iter->status());
+        if (expected == keys.end()) {
+          ASSERT_FALSE(iter->Valid());
+          continue;
+        }
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(*expected, iter->key().ToString());
+        if (expected != keys.begin()) {
+          iter->Prev();
+          ASSERT_TRUE(iter->Valid());
+          ASSERT_EQ(*(expected - 1), iter->key().ToString());
+          iter->Next();
+        }
+        iter->Next();
+        if (expected + 1 == keys.end()) {
+          ASSERT_FALSE(iter->Valid());
+        } else {
+          ASSERT_TRUE(iter->Valid());
+          ASSERT_EQ(*(expected + 1), iter->key().ToString());
+        }
+      }
+      iter.reset();
+      c.ResetTableReader();
+    }
+  }
+  ASSERT_LT(index_size[1] * 4, index_size[0]);
+}
+
 TEST_P(BlockBasedTableTest, IndexSeekOptimizationIncomplete) {
   std::unique_ptr<InternalKeyComparator> comparator(
       new InternalKeyComparator(BytewiseComparator()));
@@ -2300,6 +2435,212 @@ TEST_P(BlockBasedTableTest, NumBlockStat) {
   c.ResetTableReader();
 }
 
+// Tables below level 1 get an ot lex pdt filter, which can also point Get()
+// at the data block holding the key so that the index block is skipped.
+TEST_P(BlockBasedTableTest, OtLexPdtBlockIndexGet) {
+  for (bool pdt_data_block_index : {false, true}) {
+    TableConstructor c(BytewiseComparator(),
+                       true /* convert_to_internal_key */, 2 /* level */);
+    Options options;
+    options.statistics = CreateDBStatistics();
+    BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+    table_options.block_size = 64;
+    table_options.block_cache = NewLRUCache(1024 * 1024, 0);
+    table_options.cache_index_and_filter_blocks = true;
+    table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+    table_options.pdt_data_block_index = pdt_data_block_index;
+    options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+    // only even keys are present
+    for (int i = 0; i < 200; i += 2) {
+      char key[16];
+      snprintf(key, sizeof(key), "key%05d", i);
+      c.Add(key, std::string(20, static_cast<char>('a' + i % 26)));
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    ImmutableCFOptions ioptions(options);
+    MutableCFOptions moptions(options);
+    c.Finish(options, ioptions, moptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+    ASSERT_GT(c.GetTableReader()->GetTableProperties()->num_data_blocks, 1U);
+
+    // index block lookups, which Get() reports through the GetContext
+    uint64_t index_reads = 0;
+    for (int i = 0; i < 200; i++) {
+      char key[16];
+      snprintf(key, sizeof(key), "key%05d", i);
+      // the plain comparator of the test compares the whole internal key
+      InternalKey internal_key(key, kMaxSequenceNumber, kTypeValue);
+      PinnableSlice value;
+      GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                             GetContext::kNotFound, key, &value, nullptr,
+                             nullptr, nullptr, nullptr, nullptr);
+      ASSERT_OK(c.GetTableReader()->Get(ReadOptions(), internal_key.Encode(),
+                                        &get_context,
+                                        moptions.prefix_extractor.get()));
+      if (i % 2 == 0) {
+        ASSERT_EQ(GetContext::kFound, get_context.State());
+        ASSERT_EQ(kvmap[key], value.ToString());
+      } else {
+        ASSERT_EQ(GetContext::kNotFound, get_context.State());
+      }
+      index_reads += get_context.get_context_stats_.num_cache_index_hit +
+                     get_context.get_context_stats_.num_cache_index_miss;
+    }
+    if (pdt_data_block_index) {
+      ASSERT_EQ(0U, index_reads);
+    } else {
+      ASSERT_LT(0U, index_reads);
+    }
+    c.ResetTableReader();
+  }
+}
+
+TEST_P(BlockBasedTableTest, OtLexPdtRangeSeek) {
+  TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key */,
+                     2 /* level */);
+  Options options;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+  // only even keys are present
+  for (int i = 0; i < 100; i += 2) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%05d", i);
+    c.Add(key, "v");
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  ImmutableCFOptions ioptions(options);
+  MutableCFOptions moptions(options);
+  c.Finish(options, ioptions, moptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+
+  for (int i = 0; i < 100; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%05d", i);
+    char upper[16];
+    snprintf(upper, sizeof(upper), "key%05d", i + 1);
+    Slice upper_bound(upper);
+    ReadOptions ro;
+    ro.iterate_upper_bound = &upper_bound;
+    uint64_t useful =
+        options.statistics->getTickerCount(BLOOM_FILTER_RANGE_USEFUL);
+    std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+        ro, moptions.prefix_extractor.get(), /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    InternalKey ikey(key, kMaxSequenceNumber, kTypeValue);
+    iter->Seek(ikey.Encode());
+    if (i % 2 == 0) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(key, ExtractUserKey(iter->key()).ToString());
+      ASSERT_EQ(useful,
+                options.statistics->getTickerCount(BLOOM_FILTER_RANGE_USEFUL));
+    } else {
+      // no key in [key, upper), the data blocks are not even looked at
+      ASSERT_FALSE(iter->Valid());
+      ASSERT_OK(iter->status());
+      ASSERT_EQ(useful + 1,
+                options.statistics->getTickerCount(BLOOM_FILTER_RANGE_USEFUL));
+    }
+  }
+  // every seek consulted the range filter, and none counts as a prefix check
+  ASSERT_EQ(100,
+            options.statistics->getTickerCount(BLOOM_FILTER_RANGE_CHECKED));
+  ASSERT_EQ(0, options.statistics->getTickerCount(BLOOM_FILTER_PREFIX_CHECKED));
+  ASSERT_EQ(0, options.statistics->getTickerCount(BLOOM_FILTER_PREFIX_USEFUL));
+
+  // without an upper bound the filter is not consulted
+  ReadOptions ro;
+  std::unique_ptr<InternalIterator> iter(c.GetTableReader()->NewIterator(
+      ro, moptions.prefix_extractor.get(), /*arena=*/nullptr,
+      /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+  InternalKey ikey("key00001", kMaxSequenceNumber, kTypeValue);
+  iter->Seek(ikey.Encode());
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(100,
+            options.statistics->getTickerCount(BLOOM_FILTER_RANGE_CHECKED));
+  iter.reset();
+  c.ResetTableReader();
+}
+
+TEST_P(BlockBasedTableTest, FilterKindPerLevel) {
+  Options options;
+  BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  options.filter_kind_per_level = {kFilterKindOtLexPdt, kFilterKindNone,
+                                   kFilterKindBloom, kFilterKindAdaptive};
+  options.bloom_bits_per_key_per_level = {0, 0, 20, 10};
+
+  typedef BlockBasedTable::Rep::FilterType FilterType;
+  struct {
+    int level;
+    double adaptive_ratio;
+    FilterType filter_type;
+  } cases[] = {
+      // unknown levels use the first entry
+      {-1, 2.0, FilterType::kOtLexPdtFilter},
+      {0, 2.0, FilterType::kOtLexPdtFilter},
+      {1, 2.0, FilterType::kNoFilter},
+      {2, 2.0, FilterType::kFullFilter},
+      // levels past the end use the last entry, the sequential keys share
+      // most of their bytes so the trie is a few times the bloom filter
+      {3, 0, FilterType::kFullFilter},
+      {3, 1.0, FilterType::kFullFilter},
+      {5, 16.0, FilterType::kOtLexPdtFilter},
+  };
+  for (const auto& test_case : cases) {
+    options.adaptive_filter_max_size_ratio = test_case.adaptive_ratio;
+    TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key */,
+                       test_case.level);
+    for (int i = 0; i < 1000; i += 2) {
+      char key[16];
+      snprintf(key, sizeof(key), "key%05d", i);
+      c.Add(key, "v");
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap kvmap;
+    ImmutableCFOptions ioptions(options);
+    MutableCFOptions moptions(options);
+    c.Finish(options, ioptions, moptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+
+    auto* reader = static_cast<BlockBasedTable*>(c.GetTableReader());
+    ASSERT_EQ(test_case.filter_type, reader->get_rep()->filter_type);
+    const uint64_t filter_size = reader->GetTableProperties()->filter_size;
+    if (test_case.filter_type == FilterType::kNoFilter) {
+      ASSERT_EQ(0U, filter_size);
+    } else if (test_case.level == 2) {
+      // 20 bits per key instead of the policy's 10
+      ASSERT_GE(filter_size, 500U * 20 / 8);
+    }
+
+    // every filter kind keeps the keys readable
+    for (int i = 0; i < 1000; i++) {
+      char key[16];
+      snprintf(key, sizeof(key), "key%05d", i);
+      InternalKey ikey(key, kMaxSequenceNumber, kTypeValue);
+      PinnableSlice value;
+      GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                             GetContext::kNotFound, Slice(key), &value, nullptr,
+                             nullptr, nullptr, nullptr, nullptr);
+      ASSERT_OK(reader->Get(ReadOptions(), ikey.Encode(), &get_context,
+                            moptions.prefix_extractor.get()));
+      if (i % 2 == 0) {
+        ASSERT_EQ(GetContext::kFound, get_context.State());
+        ASSERT_EQ("v", value.ToString());
+      } else {
+        ASSERT_EQ(GetContext::kNotFound, get_context.State());
+      }
+    }
+    c.ResetTableReader();
+  }
+}
+
 TEST_P(BlockBasedTableTest, TracingGetTest) {
   TableConstructor c(BytewiseComparator());
   Options options;
@@ -278,8 +278,9 @@ Status WritableFileWriter::Append(const Slice& data) {
 
   // We never write directly to disk with direct I/O on.
   // or we simply use it for its original purpose to accumulate many small
-  // chunks
-  if (use_direct_io() || (buf_.Capacity() >= left)) {
+  // chunks. A file appending in place would copy the data anyway, better
+  // into our buffer than into one it allocates.
+  if (use_direct_io() || append_in_place_ || (buf_.Capacity() >= left)) {
     while (left > 0) {
       size_t appended = buf_.Append(src, left);
       left -= appended;
@@ -484,6 +485,11 @@ Status WritableFileWriter::WriteBuffered(const char* data, size_t size) {
   assert(!use_direct_io());
   const char* src = data;
   size_t left = size;
+  // Our buffer is dropped once written, the file may then overwrite it
+  // instead of copying the data, to encrypt it for instance.
+  char* const own_buf =
+      (append_in_place_ && data == buf_.BufferStart()) ? buf_.BufferStart()
+                                                       : nullptr;
 
   while (left > 0) {
     size_t allowed;
@@ -510,7 +516,11 @@ Status WritableFileWriter::WriteBuffered(const char* data, size_t size) {
       {
         auto prev_perf_level = GetPerfLevel();
         IOSTATS_CPU_TIMER_GUARD(cpu_write_nanos, env_);
-        s = writable_file_->Append(Slice(src, allowed));
+        if (own_buf != nullptr) {
+          s = writable_file_->AppendInPlace(own_buf + (src - data), allowed);
+        } else {
+          s = writable_file_->Append(Slice(src, allowed));
+        }
         SetPerfLevel(prev_perf_level);
       }
 #ifndef ROCKSDB_LITE
@@ -520,6 +530,10 @@ Status WritableFileWriter::WriteBuffered(const char* data, size_t size) {
       }
 #endif
       if (!s.ok()) {
+        if (own_buf != nullptr) {
+          // The part already written was overwritten, keep only the rest
+          buf_.RefitTail(src - data, left);
+        }
         return s;
       }
     }
@@ -213,6 +213,8 @@ class WritableFileWriter {
   Env* env_;
   AlignedBuffer           buf_;
   size_t                  max_buffer_size_;
+  // Whether buf_ is written with AppendInPlace()
+  bool                    append_in_place_;
   // Actually written data size can be used for truncate
   // not counting padding data
   uint64_t                filesize_;
@@ -240,6 +242,7 @@ class WritableFileWriter {
         env_(env),
         buf_(),
         max_buffer_size_(options.writable_file_max_buffer_size),
+        append_in_place_(writable_file_->SupportsAppendInPlace()),
         filesize_(0),
 #ifndef ROCKSDB_LITE
         next_write_offset_(0),
@@ -219,6 +219,69 @@ TEST_F(WritableFileWriterTest, AppendStatusReturn) {
 }
 #endif
 
+TEST_F(WritableFileWriterTest, AppendInPlace) {
+  // Writes its data to a string, then scrambles the writer's buffer
+  class FakeWF : public WritableFile {
+   public:
+    FakeWF(std::string* content, int* copy_appends)
+        : content_(content), copy_appends_(copy_appends), io_error_(false) {}
+
+    Status Append(const Slice& data) override {
+      (*copy_appends_)++;
+      content_->append(data.data(), data.size());
+      return Status::OK();
+    }
+    Status AppendInPlace(char* data, size_t size) override {
+      if (io_error_) {
+        return Status::IOError("Fake IO error");
+      }
+      content_->append(data, size);
+      memset(data, 'x', size);
+      return Status::OK();
+    }
+    bool SupportsAppendInPlace() const override { return true; }
+    Status Close() override { return Status::OK(); }
+    Status Flush() override { return Status::OK(); }
+    Status Sync() override { return Status::OK(); }
+    void SetIOError(bool val) { io_error_ = val; }
+
+   private:
+    std::string* content_;
+    int* copy_appends_;
+    bool io_error_;
+  };
+
+  std::string content;
+  int copy_appends = 0;
+  std::string expected;
+  std::unique_ptr<WritableFileWriter> writer(new WritableFileWriter(
+      std::unique_ptr<FakeWF>(new FakeWF(&content, &copy_appends)),
+      "" /* don't care */, EnvOptions()));
+  FakeWF* wf = static_cast<FakeWF*>(writer->writable_file());
+  Random r(301);
+  for (int i = 0; i < 100; i++) {
+    // small appends, then ones larger than the buffer
+    std::string data;
+    test::RandomString(&r, i < 90 ? 1000 : 3 * kMb, &data);
+    ASSERT_OK(writer->Append(data));
+    expected.append(data);
+  }
+  ASSERT_OK(writer->Flush());
+  ASSERT_EQ(expected, content);
+
+  // A failed write is retried with the original data
+  std::string data;
+  test::RandomString(&r, 1000, &data);
+  ASSERT_OK(writer->Append(data));
+  expected.append(data);
+  wf->SetIOError(true);
+  ASSERT_NOK(writer->Flush());
+  wf->SetIOError(false);
+  ASSERT_OK(writer->Close());
+  ASSERT_EQ(expected, content);
+  ASSERT_EQ(0, copy_appends);
+}
+
 class ReadaheadRandomAccessFileTest
     : public testing::Test,
       public testing::WithParamInterface<size_t> {
@@ -0,0 +1,444 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <cinttypes>
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/slice.h"
+#include "table/full_filter_bits_builder.h"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+#include "util/string_util.h"
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+DEFINE_string(filters, "block_bloom,full_bloom,pdt,pdt_approx",
+              "Comma-separated list of filters to benchmark, among "
+              "block_bloom, full_bloom, pdt and pdt_approx");
+DEFINE_string(key_type, "random",
+              "Key set to build the filters on: random, sequential, "
+              "prefix (keys sharing a few long prefixes) or file");
+DEFINE_string(key_file, "",
+              "With -key_type=file, a file holding one key per line. Every "
+              "-holdout'th line is kept out of the filters and queried as a "
+              "missing key");
+DEFINE_int32(holdout, 10, "See -key_file");
+DEFINE_int64(num_keys, 100000, "Number of keys to add to each filter");
+DEFINE_int32(key_size, 24, "Size of the generated keys");
+DEFINE_int32(prefix_len, 16, "Size of the shared prefix, for -key_type=prefix");
+DEFINE_int32(num_prefixes, 16,
+             "Number of distinct prefixes, for -key_type=prefix");
+DEFINE_int64(num_queries, 100000,
+             "Number of present and of missing keys to query");
+DEFINE_int32(batch_size, 32, "Number of keys per batched MayMatch() call");
+DEFINE_int32(bits_per_key, 10, "Bits per key of the bloom filters");
+DEFINE_int32(fingerprint_bits, 8,
+             "Fingerprint bits per key of the approximate pdt");
+DEFINE_int32(reader_reps, 100,
+             "Number of times the filter readers are constructed to time it");
+DEFINE_int64(seed, 301, "Seed of the generated keys and queries");
+DEFINE_bool(json, false,
+            "Print one JSON object per filter instead of a table");
+
+namespace rocksdb {
+
+namespace {
+
+struct FilterBenchResult {
+  std::string filter;
+  size_t filter_bytes = 0;
+  double build_ns_per_key = 0;
+  double reader_ns = 0;
+  double positive_ns = 0;
+  double negative_ns = 0;
+  double batched_ns = 0;
+  uint64_t false_negatives = 0;
+  uint64_t false_positives = 0;
+};
+
+// Filter under test, built once on the key set and then queried through a
+// common interface
+class BenchFilter {
+ public:
+  virtual ~BenchFilter() {}
+
+  virtual Slice Build(const std::vector<std::string>& keys) = 0;
+
+  // Constructs and drops a reader of the filter, for timing
+  virtual void NewReader() {}
+
+  virtual bool MayMatch(const Slice& key) = 0;
+
+  virtual void MayMatch(int num_keys, Slice** keys, bool* may_match) {
+    for (int i = 0; i < num_keys; ++i) {
+      may_match[i] = MayMatch(*keys[i]);
+    }
+  }
+};
+
+// Filter built with the legacy FilterPolicy::CreateFilter(), one per block
+class BlockBasedBenchFilter : public BenchFilter {
+ public:
+  BlockBasedBenchFilter() : policy_(NewBloomFilterPolicy(FLAGS_bits_per_key,
+                                                         true)) {}
+
+  Slice Build(const std::vector<std::string>& keys) override {
+    std::vector<Slice> slices(keys.begin(), keys.end());
+    filter_.clear();
+    policy_->CreateFilter(slices.data(), static_cast<int>(slices.size()),
+                          &filter_);
+    return filter_;
+  }
+
+  using BenchFilter::MayMatch;
+
+  bool MayMatch(const Slice& key) override {
+    return policy_->KeyMayMatch(key, filter_);
+  }
+
+ private:
+  std::unique_ptr<const FilterPolicy> policy_;
+  std::string filter_;
+};
+
+// Filter built by a FilterBitsBuilder and queried through a FilterBitsReader
+class FullBenchFilter : public BenchFilter {
+ public:
+  // A null builder stands for the full bloom filter of the policy
+  FullBenchFilter(FilterBitsBuilder* builder, bool is_pdt)
+      : policy_(NewBloomFilterPolicy(FLAGS_bits_per_key, false)),
+        builder_(builder != nullptr ? builder
+                                    : policy_->GetFilterBitsBuilder(is_pdt)),
+        is_pdt_(is_pdt) {}
+
+  Slice Build(const std::vector<std::string>& keys) override {
+    for (const auto& key : keys) {
+      builder_->AddKey(key);
+    }
+    filter_ = builder_->Finish(&buf_);
+    reader_.reset(policy_->GetFilterBitsReader(filter_, is_pdt_));
+    return filter_;
+  }
+
+  void NewReader() override {
+    std::unique_ptr<FilterBitsReader> reader(
+        policy_->GetFilterBitsReader(filter_, is_pdt_));
+  }
+
+  bool MayMatch(const Slice& key) override { return reader_->MayMatch(key); }
+
+  void MayMatch(int num_keys, Slice** keys, bool* may_match) override {
+    reader_->MayMatch(num_keys, keys, may_match);
+  }
+
+ private:
+  std::unique_ptr<const FilterPolicy> policy_;
+  std::unique_ptr<FilterBitsBuilder> builder_;
+  const bool is_pdt_;
+  std::unique_ptr<const char[]> buf_;
+  Slice filter_;
+  std::unique_ptr<FilterBitsReader> reader_;
+};
+
+class FilterBench {
+ public:
+  FilterBench() : rnd_(FLAGS_seed) {}
+
+  bool GenerateKeys() {
+    std::set<std::string> keys;
+    std::vector<std::string> missing;
+    if (FLAGS_key_type == "file") {
+      if (!ReadKeyFile(&keys, &missing)) {
+        return false;
+      }
+    } else if (FLAGS_key_type == "random" || FLAGS_key_type == "sequential" ||
+               FLAGS_key_type == "prefix") {
+      if (FLAGS_key_type == "prefix") {
+        for (int i = 0; i < FLAGS_num_prefixes; ++i) {
+          prefixes_.push_back(RandomBytes(FLAGS_prefix_len));
+        }
+      }
+      // random keys are drawn until enough distinct ones come up, which
+      // never ends when there are too few possible keys, and slows down to a
+      // crawl as the keys fill up the key space. Half of it is plenty.
+      if (FLAGS_key_type != "sequential" &&
+          NumPossibleKeys() < 2.0 * static_cast<double>(FLAGS_num_keys)) {
+        fprintf(stderr,
+                "Too few possible keys for -num_keys, raise -key_size%s\n",
+                FLAGS_key_type == "prefix" ? " or -num_prefixes" : "");
+        return false;
+      }
+      // sequential keys are even, missing ones odd
+      for (uint64_t i = 0; keys.size() < static_cast<size_t>(FLAGS_num_keys);
+           ++i) {
+        keys.insert(GenerateKey(i * 2));
+      }
+      for (uint64_t i = 0;
+           missing.size() < static_cast<size_t>(FLAGS_num_queries); ++i) {
+        std::string key = GenerateKey(i * 2 + 1);
+        if (keys.count(key) == 0) {
+          missing.push_back(std::move(key));
+        }
+      }
+    } else {
+      fprintf(stderr, "Unknown key_type %s\n", FLAGS_key_type.c_str());
+      return false;
+    }
+    if (keys.empty() || missing.empty()) {
+      fprintf(stderr, "Need both present and missing keys\n");
+      return false;
+    }
+
+    // the pdt filters want the keys sorted and distinct
+    keys_.assign(keys.begin(), keys.end());
+    for (auto& key : keys_) {
+      key_bytes_ += key.size();
+    }
+    for (int64_t i = 0; i < FLAGS_num_queries; ++i) {
+      present_.push_back(keys_[rnd_.Uniform(keys_.size())]);
+      absent_.push_back(missing[i % missing.size()]);
+    }
+    return true;
+  }
+
+  bool Run(const std::string& name) {
+    std::unique_ptr<BenchFilter> filter;
+    if (name == "block_bloom") {
+      filter.reset(new BlockBasedBenchFilter());
+    } else if (name == "full_bloom") {
+      filter.reset(new FullBenchFilter(nullptr, false));
+    } else if (name == "pdt") {
+      filter.reset(new FullBenchFilter(new OtLexPdtBloomBitsBuilder(), true));
+    } else if (name == "pdt_approx") {
+      filter.reset(new FullBenchFilter(
+          new OtLexPdtBloomBitsBuilder(FLAGS_fingerprint_bits), true));
+    } else {
+      fprintf(stderr, "Unknown filter %s\n", name.c_str());
+      return false;
+    }
+
+    FilterBenchResult result;
+    result.filter = name;
+    Env* env = Env::Default();
+    uint64_t start = env->NowNanos();
+    result.filter_bytes = filter->Build(keys_).size();
+    result.build_ns_per_key =
+        static_cast<double>(env->NowNanos() - start) / keys_.size();
+
+    start = env->NowNanos();
+    for (int i = 0; i < FLAGS_reader_reps; ++i) {
+      filter->NewReader();
+    }
+    result.reader_ns = static_cast<double>(env->NowNanos() - start) /
+                       std::max(FLAGS_reader_reps, 1);
+
+    start = env->NowNanos();
+    for (const auto& key : present_) {
+      result.false_negatives += filter->MayMatch(key) ? 0 : 1;
+    }
+    result.positive_ns =
+        static_cast<double>(env->NowNanos() - start) / present_.size();
+
+    start = env->NowNanos();
+    for (const auto& key : absent_) {
+      result.false_positives += filter->MayMatch(key) ? 1 : 0;
+    }
+    result.negative_ns =
+        static_cast<double>(env->NowNanos() - start) / absent_.size();
+
+    // half present, half missing keys in every batch
+    std::vector<Slice> queries;
+    for (size_t i = 0; i < present_.size(); ++i) {
+      queries.push_back(present_[i]);
+      queries.push_back(absent_[i]);
+    }
+    std::vector<Slice*> batch(FLAGS_batch_size);
+    std::unique_ptr<bool[]> may_match(new bool[FLAGS_batch_size]);
+    uint64_t batched_matches = 0;
+    start = env->NowNanos();
+    for (size_t i = 0; i < queries.size(); i += FLAGS_batch_size) {
+      int num_keys = static_cast<int>(
+          std::min(queries.size() - i, static_cast<size_t>(FLAGS_batch_size)));
+      for (int j = 0; j < num_keys; ++j) {
+        batch[j] = &queries[i + j];
+      }
+      filter->MayMatch(num_keys, batch.data(), may_match.get());
+      for (int j = 0; j < num_keys; ++j) {
+        batched_matches += may_match[j] ? 1 : 0;
+      }
+    }
+    result.batched_ns =
+        static_cast<double>(env->NowNanos() - start) / queries.size();
+    if (batched_matches !=
+        present_.size() - result.false_negatives + result.false_positives) {
+      fprintf(stderr, "%s: batched and single lookups disagree\n",
+              name.c_str());
+      return false;
+    }
+
+    Print(result);
+    return result.false_negatives == 0;
+  }
+
+  void PrintHeader() const {
+    if (FLAGS_json) {
+      return;
+    }
+    printf("Keys:       %" ROCKSDB_PRIszt " %s keys, %.1f bytes each\n",
+           keys_.size(), FLAGS_key_type.c_str(),
+           static_cast<double>(key_bytes_) / keys_.size());
+    printf("Queries:    %" ROCKSDB_PRIszt " present, %" ROCKSDB_PRIszt
+           " missing, batches of %d\n",
+           present_.size(), absent_.size(), FLAGS_batch_size);
+    printf("%-12s %12s %12s %12s %12s %12s %12s %10s %8s\n", "filter",
+           "bytes/key", "build ns/key", "reader ns", "present ns",
+           "missing ns", "batched ns", "fp rate", "fn");
+  }
+
+ private:
+  std::string RandomBytes(int len) {
+    std::string bytes(std::max(len, 0), '\0');
+    for (auto& c : bytes) {
+      c = static_cast<char>(rnd_.Uniform(256));
+    }
+    return bytes;
+  }
+
+  // Number of distinct keys GenerateKey() may return, for random and prefix
+  // keys
+  double NumPossibleKeys() const {
+    if (FLAGS_key_type == "prefix") {
+      std::set<std::string> prefixes(prefixes_.begin(), prefixes_.end());
+      return static_cast<double>(prefixes.size()) *
+             std::pow(256.0, FLAGS_key_size - FLAGS_prefix_len);
+    }
+    return std::pow(256.0, FLAGS_key_size);
+  }
+
+  std::string GenerateKey(uint64_t i) {
+    if (FLAGS_key_type == "sequential") {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%020" PRIu64, i);
+      std::string key(buf);
+      if (FLAGS_key_size > static_cast<int>(key.size())) {
+        key.insert(0, FLAGS_key_size - key.size(), '0');
+      }
+      return key;
+    } else if (FLAGS_key_type == "prefix") {
+      return prefixes_[rnd_.Uniform(static_cast<int>(prefixes_.size()))] +
+             RandomBytes(FLAGS_key_size - FLAGS_prefix_len);
+    }
+    return RandomBytes(FLAGS_key_size);
+  }
+
+  bool ReadKeyFile(std::set<std::string>* keys,
+                   std::vector<std::string>* missing) {
+    std::ifstream in(FLAGS_key_file);
+    if (!in) {
+      fprintf(stderr, "Cannot open key_file %s\n", FLAGS_key_file.c_str());
+      return false;
+    }
+    std::string line;
+    for (uint64_t i = 0; std::getline(in, line) &&
+                         keys->size() < static_cast<size_t>(FLAGS_num_keys);
+         ++i) {
+      if (line.empty()) {
+        continue;
+      }
+      if (FLAGS_holdout > 0 && i % FLAGS_holdout == 0) {
+        missing->push_back(line);
+      } else {
+        keys->insert(line);
+      }
+    }
+    missing->erase(std::remove_if(missing->begin(), missing->end(),
+                                  [&](const std::string& key) {
+                                    return keys->count(key) > 0;
+                                  }),
+                   missing->end());
+    return true;
+  }
+
+  void Print(const FilterBenchResult& r) const {
+    double bytes_per_key = static_cast<double>(r.filter_bytes) / keys_.size();
+    double fp_rate = static_cast<double>(r.false_positives) / absent_.size();
+    if (FLAGS_json) {
+      printf("{\"filter\": \"%s\", \"key_type\": \"%s\", \"num_keys\": "
+             "%" ROCKSDB_PRIszt ", \"key_bytes\": %" ROCKSDB_PRIszt
+             ", \"filter_bytes\": %" ROCKSDB_PRIszt
+             ", \"bytes_per_key\": %.3f, \"build_ns_per_key\": %.1f, "
+             "\"reader_ns\": %.1f, \"present_ns\": %.1f, \"missing_ns\": %.1f, "
+             "\"batched_ns\": %.1f, \"fp_rate\": %.6f, "
+             "\"false_negatives\": %" PRIu64 "}\n",
+             r.filter.c_str(), FLAGS_key_type.c_str(), keys_.size(),
+             key_bytes_, r.filter_bytes, bytes_per_key, r.build_ns_per_key,
+             r.reader_ns, r.positive_ns, r.negative_ns, r.batched_ns, fp_rate,
+             r.false_negatives);
+    } else {
+      printf("%-12s %12.3f %12.1f %12.1f %12.1f %12.1f %12.1f %10.6f %8" PRIu64
+             "\n",
+             r.filter.c_str(), bytes_per_key, r.build_ns_per_key, r.reader_ns,
+             r.positive_ns, r.negative_ns, r.batched_ns, fp_rate,
+             r.false_negatives);
+    }
+  }
+
+  Random64 rnd_;
+  std::vector<std::string> prefixes_;
+  std::vector<std::string> keys_;
+  size_t key_bytes_ = 0;
+  std::vector<std::string> present_;
+  std::vector<std::string> absent_;
+};
+
+}  // namespace
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+
+  if (FLAGS_num_keys <= 0 || FLAGS_num_queries <= 0 || FLAGS_batch_size <= 0 ||
+      FLAGS_key_size < 0 ||
+      (FLAGS_key_type == "prefix" &&
+       (FLAGS_key_size < FLAGS_prefix_len || FLAGS_num_prefixes <= 0))) {
+    fprintf(stderr, "Invalid key or query options\n");
+    return 1;
+  }
+
+  rocksdb::FilterBench bench;
+  if (!bench.GenerateKeys()) {
+    return 1;
+  }
+  bench.PrintHeader();
+  bool ok = true;
+  for (const auto& filter : rocksdb::StringSplit(FLAGS_filters, ',')) {
+    ok = bench.Run(filter) && ok;
+  }
+  return ok ? 0 : 1;
+}
+
+#endif  // GFLAGS
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 #include "succinct_config.hpp"
 
@@ -23,6 +24,23 @@
 #include <smmintrin.h>
 #endif
 
+// Without -mavx2 the AVX2 kernels below are still compiled, for the x86-64
+// CPUs that support them, and picked at runtime (GCC 5+ and clang declare
+// the AVX2 intrinsics for functions with the avx2 target attribute)
+#if !defined(__AVX2__) && defined(__x86_64__) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define SUCCINCT_DISPATCH_AVX2 1
+#define SUCCINCT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SUCCINCT_DISPATCH_AVX2 0
+#define SUCCINCT_TARGET_AVX2
+#endif
+
+#if defined(__AVX2__) || SUCCINCT_DISPATCH_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
 namespace rocksdb {
@@ -98,6 +116,125 @@ namespace intrinsics {
     }
 
 #endif /* SUCCINCT_USE_POPCNT */
+
+    namespace detail {
+#if SUCCINCT_DISPATCH_AVX2
+    // Checked once, the first time a kernel is picked
+    inline bool cpu_has_avx2()
+    {
+        static const bool has_avx2 = [] {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+        }();
+        return has_avx2;
+    }
+#endif
+
+    // The kernels below go on from i, 16 bytes at a time
+    inline size_t ascii_prefix_length_sse2(uint8_t const* a, uint8_t const* b,
+                                           size_t n, size_t i)
+    {
+#if defined(__SSE2__)
+        for (; i + 16 <= n; i += 16) {
+            __m128i va = _mm_loadu_si128((__m128i const*)(a + i));
+            __m128i vb = _mm_loadu_si128((__m128i const*)(b + i));
+            uint32_t eq = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+            uint32_t match = eq & ~(uint32_t)_mm_movemask_epi8(va);
+            if (match != 0xFFFFU) {
+                return i + __builtin_ctz(~match);
+            }
+        }
+#endif
+        while (i < n && a[i] < 0x80 && a[i] == b[i]) ++i;
+        return i;
+    }
+
+    inline size_t find_byte_sse2(uint8_t const* p, size_t n, uint8_t c,
+                                 size_t i)
+    {
+#if defined(__SSE2__)
+        __m128i vc16 = _mm_set1_epi8((char)c);
+        for (; i + 16 <= n; i += 16) {
+            __m128i vp = _mm_loadu_si128((__m128i const*)(p + i));
+            uint32_t eq = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(vp, vc16));
+            if (eq) {
+                return i + __builtin_ctz(eq);
+            }
+        }
+#endif
+        while (i < n && p[i] != c) ++i;
+        return i;
+    }
+
+#if defined(__AVX2__) || SUCCINCT_DISPATCH_AVX2
+    // 32 bytes at a time, then the SSE2 kernels for the rest
+    SUCCINCT_TARGET_AVX2 inline size_t ascii_prefix_length_avx2(
+        uint8_t const* a, uint8_t const* b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32) {
+            __m256i va = _mm256_loadu_si256((__m256i const*)(a + i));
+            __m256i vb = _mm256_loadu_si256((__m256i const*)(b + i));
+            uint32_t eq = (uint32_t)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(va, vb));
+            uint32_t match = eq & ~(uint32_t)_mm256_movemask_epi8(va);
+            if (match != 0xFFFFFFFFU) {
+                return i + __builtin_ctz(~match);
+            }
+        }
+        return ascii_prefix_length_sse2(a, b, n, i);
+    }
+
+    SUCCINCT_TARGET_AVX2 inline size_t find_byte_avx2(uint8_t const* p,
+                                                      size_t n, uint8_t c)
+    {
+        size_t i = 0;
+        __m256i vc32 = _mm256_set1_epi8((char)c);
+        for (; i + 32 <= n; i += 32) {
+            __m256i vp = _mm256_loadu_si256((__m256i const*)(p + i));
+            uint32_t eq = (uint32_t)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(vp, vc32));
+            if (eq) {
+                return i + __builtin_ctz(eq);
+            }
+        }
+        return find_byte_sse2(p, n, c, i);
+    }
+#endif
+    }
+
+    // Number of leading bytes of a that are below 0x80 and equal to the
+    // corresponding bytes of b, looking at the first n bytes only. The
+    // vector loops never read past a + n or b + n.
+    inline size_t ascii_prefix_length(uint8_t const* a, uint8_t const* b,
+                                      size_t n)
+    {
+#if defined(__AVX2__)
+        return detail::ascii_prefix_length_avx2(a, b, n);
+#else
+#if SUCCINCT_DISPATCH_AVX2
+        if (detail::cpu_has_avx2()) {
+            return detail::ascii_prefix_length_avx2(a, b, n);
+        }
+#endif
+        return detail::ascii_prefix_length_sse2(a, b, n, 0);
+#endif
+    }
+
+    // Position of the first c in p[0, n), or n if there is none
+    inline size_t find_byte(uint8_t const* p, size_t n, uint8_t c)
+    {
+#if defined(__AVX2__)
+        return detail::find_byte_avx2(p, n, c);
+#else
+#if SUCCINCT_DISPATCH_AVX2
+        if (detail::cpu_has_avx2()) {
+            return detail::find_byte_avx2(p, n, c);
+        }
+#endif
+        return detail::find_byte_sse2(p, n, c, 0);
+#endif
+    }
 }
 }
 
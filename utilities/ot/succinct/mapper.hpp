@@ -16,8 +16,10 @@ namespace succinct {
 namespace mapper {
 
 struct freeze_flags {
-  // enum {
-  // };
+  // Pad every field to an 8-byte boundary (relative to the start of the
+  // frozen stream), so that a stream living in an 8-byte aligned buffer can
+  // be mapped in place without unaligned reads of the underlying vectors.
+  enum { aligned = 1 };
 };
 
 struct map_flags {
@@ -43,9 +45,13 @@ struct size_node {
 };
 
 namespace detail {
+inline size_t aligned_padding(uint64_t written) {
+  return static_cast<size_t>((8 - (written % 8)) % 8);
+}
+
 class freeze_visitor : boost::noncopyable {
  public:
-  freeze_visitor(std::ofstream& fout, uint64_t flags)
+  freeze_visitor(std::ostream& fout, uint64_t flags)
       : m_fout(fout), m_flags(flags), m_written(0) {
     // Save freezing flags
     m_fout.write(reinterpret_cast<const char*>(&m_flags), sizeof(m_flags));
@@ -64,6 +70,7 @@ class freeze_visitor : boost::noncopyable {
       T& val, const char* friendly_name) {
     m_fout.write(reinterpret_cast<const char*>(&val), sizeof(T));
     m_written += sizeof(T);
+    pad();
     return *this;
   }
 
@@ -75,6 +82,7 @@ class freeze_visitor : boost::noncopyable {
     size_t n_bytes = static_cast<size_t>(vec.m_size * sizeof(T));
     m_fout.write(reinterpret_cast<const char*>(vec.m_data), n_bytes);
     m_written += n_bytes;
+    pad();
 
     return *this;
   }
@@ -82,7 +90,16 @@ class freeze_visitor : boost::noncopyable {
   size_t written() const { return m_written; }
 
  protected:
-  std::ofstream& m_fout;
+  void pad() {
+    if (m_flags & freeze_flags::aligned) {
+      static const char zeros[8] = {0};
+      size_t padding = aligned_padding(m_written);
+      m_fout.write(zeros, padding);
+      m_written += padding;
+    }
+  }
+
+  std::ostream& m_fout;
   const uint64_t m_flags;
   uint64_t m_written;
 };
@@ -107,6 +124,7 @@ class map_visitor : boost::noncopyable {
       T& val, const char* friendly_name) {
     val = *reinterpret_cast<const T*>(m_cur);
     m_cur += sizeof(T);
+    skip_padding();
     return *this;
   }
 
@@ -127,12 +145,19 @@ class map_visitor : boost::noncopyable {
     }
 
     m_cur += bytes;
+    skip_padding();
     return *this;
   }
 
   size_t bytes_read() const { return size_t(m_cur - m_base); }
 
  protected:
+  void skip_padding() {
+    if (m_freeze_flags & freeze_flags::aligned) {
+      m_cur += aligned_padding(bytes_read());
+    }
+  }
+
   const char* m_base;
   const char* m_cur;
   const uint64_t m_flags;
@@ -210,7 +235,7 @@ class sizeof_visitor : boost::noncopyable {
 }
 
     template <typename T>
-size_t freeze(T& val, std::ofstream& fout, uint64_t flags = 0,
+size_t freeze(T& val, std::ostream& fout, uint64_t flags = 0,
               const char* friendly_name = "<TOP>") {
   detail::freeze_visitor freezer(fout, flags);
   freezer(val, friendly_name);
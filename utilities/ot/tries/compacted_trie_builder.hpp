@@ -14,103 +14,117 @@ namespace tries {
 
 template <typename TreeBuilder>
 struct compacted_trie_builder {
+  compacted_trie_builder() : m_visitor(0), m_num_strings(0) {}
+
   template <typename Range, typename Adaptor>
   void build(TreeBuilder& visitor, Range const& strings, Adaptor adaptor) {
     if (boost::empty(strings)) return;
 
     typedef typename boost::range_const_iterator<Range>::type iterator_t;
-    iterator_t iter = boost::begin(strings);
-
-    std::vector<node> stack;
-    char_range first_string = adaptor(*iter);
-    std::vector<uint8_t> last_string(boost::begin(first_string),
-                                     boost::end(first_string));
-
-    stack.push_back(node(0, last_string.size()));
-
-    for (++iter; iter != boost::end(strings); ++iter) {
-      char_range cur_string = adaptor(*iter);
-
-      size_t min_len =
-          std::min(boost::size(last_string), boost::size(cur_string));
-      std::pair<const uint8_t*, std::vector<uint8_t>::const_iterator> mm =
-          std::mismatch(cur_string.first, cur_string.first + min_len,
-                        last_string.begin());
-
-      if (mm.first == cur_string.second || mm.second == last_string.end()) {
-        if (mm.first == cur_string.second && mm.second == last_string.end()) {
-          throw std::invalid_argument("Duplicate string found");
-        } else {
-          throw std::invalid_argument("Input range are not prefix-free");
-        }
-      }
+    start(visitor);
+    for (iterator_t iter = boost::begin(strings); iter != boost::end(strings);
+         ++iter) {
+      append(adaptor(*iter));
+    }
+    finish();
+  }
 
-      if (*mm.first < *mm.second) {
-        throw std::invalid_argument("Input range is not sorted");
-      }
+  // Incremental interface: start(), then append() the strings one at a
+  // time in sorted order, then finish(). Only the last string and the
+  // nodes on its path are kept open, everything to its left is handed to
+  // the visitor as soon as it is complete, so the strings themselves need
+  // not be kept around.
+  void start(TreeBuilder& visitor) {
+    m_visitor = &visitor;
+    m_stack.clear();
+    m_last_string.clear();
+    m_num_strings = 0;
+  }
 
-      size_t mismatch = mm.first - cur_string.first;
-      size_t cur_node_idx = 0;
+  // cur_string can be released once append() returns
+  void append(char_range cur_string) {
+    assert(m_visitor);
+    if (m_num_strings++ == 0) {
+      m_last_string.assign(cur_string.first, cur_string.second);
+      m_stack.push_back(node(0, m_last_string.size()));
+      return;
+    }
 
-      // find the node to split
-      while (mismatch >
-             stack[cur_node_idx].path_len + stack[cur_node_idx].skip) {
-        assert(cur_node_idx < stack.size());
-        ++cur_node_idx;
-      }
-      node& cur_node = stack[cur_node_idx];
-
-      assert(mismatch >= cur_node.path_len);
-      assert(mismatch <= cur_node.path_len + cur_node.skip);
-
-      // close all open nodes below the current branching point
-      for (size_t node_idx = stack.size() - 1; node_idx > cur_node_idx;
-           --node_idx) {
-        node& child = stack[node_idx];
-        typename TreeBuilder::representation_type subtrie = visitor.node(
-            child.children, &last_string[0], child.path_len, child.skip);
-        uint8_t branching_char = last_string[child.path_len - 1];
-        stack[node_idx - 1].children.push_back(
-            std::make_pair(branching_char, subtrie));
-      }
-      stack.resize(cur_node_idx + 1);
-
-      // if the current string splits the skip, split the current node
-      if (mismatch < cur_node.path_len + cur_node.skip) {
-        typename TreeBuilder::representation_type subtrie =
-            visitor.node(cur_node.children, &last_string[0], mismatch + 1,
-                         cur_node.path_len + cur_node.skip - mismatch - 1);
-        uint8_t branching_char = last_string[mismatch];
-        cur_node.children.clear();
-        cur_node.children.push_back(std::make_pair(branching_char, subtrie));
-        cur_node.skip = mismatch - cur_node.path_len;
+    size_t min_len =
+        std::min(boost::size(m_last_string), boost::size(cur_string));
+    std::pair<const uint8_t*, std::vector<uint8_t>::const_iterator> mm =
+        std::mismatch(cur_string.first, cur_string.first + min_len,
+                      m_last_string.begin());
+
+    if (mm.first == cur_string.second || mm.second == m_last_string.end()) {
+      if (mm.first == cur_string.second && mm.second == m_last_string.end()) {
+        throw std::invalid_argument("Duplicate string found");
+      } else {
+        throw std::invalid_argument("Input range are not prefix-free");
       }
+    }
 
-      assert(cur_node.path_len + cur_node.skip == mismatch);
-      // open a new leaf with the current suffix
-      stack.push_back(
-          node(mismatch + 1, boost::size(cur_string) - mismatch - 1));
-
-      // copy the current string (iter could be invalid in next iteration)
-      last_string.assign(cur_string.first, cur_string.second);
+    if (*mm.first < *mm.second) {
+      throw std::invalid_argument("Input range is not sorted");
     }
 
-    // close the remaining path
-    for (size_t node_idx = stack.size() - 1; node_idx > 0; --node_idx) {
-      node& child = stack[node_idx];
-      typename TreeBuilder::representation_type subtrie = visitor.node(
-          child.children, &last_string[0], child.path_len, child.skip);
-      uint8_t branching_char = last_string[child.path_len - 1];
-      stack[node_idx - 1].children.push_back(
-          std::make_pair(branching_char, subtrie));
+    size_t mismatch = mm.first - cur_string.first;
+    size_t cur_node_idx = 0;
+
+    // find the node to split
+    while (mismatch >
+           m_stack[cur_node_idx].path_len + m_stack[cur_node_idx].skip) {
+      assert(cur_node_idx < m_stack.size());
+      ++cur_node_idx;
+    }
+    node& cur_node = m_stack[cur_node_idx];
+
+    assert(mismatch >= cur_node.path_len);
+    assert(mismatch <= cur_node.path_len + cur_node.skip);
+
+    // close all open nodes below the current branching point
+    close_nodes(cur_node_idx);
+
+    // if the current string splits the skip, split the current node
+    if (mismatch < cur_node.path_len + cur_node.skip) {
+      typename TreeBuilder::representation_type subtrie =
+          m_visitor->node(cur_node.children, &m_last_string[0], mismatch + 1,
+                          cur_node.path_len + cur_node.skip - mismatch - 1);
+      uint8_t branching_char = m_last_string[mismatch];
+      cur_node.children.clear();
+      cur_node.children.push_back(std::make_pair(branching_char, subtrie));
+      cur_node.skip = mismatch - cur_node.path_len;
     }
 
-    typename TreeBuilder::representation_type root = visitor.node(
-        stack[0].children, &last_string[0], stack[0].path_len, stack[0].skip);
-    visitor.root(root);
-    stack.clear();
+    assert(cur_node.path_len + cur_node.skip == mismatch);
+    // open a new leaf with the current suffix
+    m_stack.push_back(
+        node(mismatch + 1, boost::size(cur_string) - mismatch - 1));
+
+    // copy the current string (it could be invalid in the next call)
+    m_last_string.assign(cur_string.first, cur_string.second);
+  }
+
+  // Closes the remaining path and hands the root to the visitor. Nothing is
+  // handed over if no string was appended.
+  void finish() {
+    assert(m_visitor);
+    if (m_num_strings > 0) {
+      close_nodes(0);
+      typename TreeBuilder::representation_type root =
+          m_visitor->node(m_stack[0].children, &m_last_string[0],
+                          m_stack[0].path_len, m_stack[0].skip);
+      m_visitor->root(root);
+    }
+    std::vector<node>().swap(m_stack);
+    std::vector<uint8_t>().swap(m_last_string);
+    m_num_strings = 0;
+    m_visitor = 0;
   }
 
+  // Number of strings appended since start()
+  size_t num_strings() const { return m_num_strings; }
+
  private:
   struct node {
     node() : skip(-1) {}
@@ -124,6 +138,25 @@ struct compacted_trie_builder {
         subtrie;
     std::vector<subtrie> children;
   };
+
+  // hands the open nodes above parent_idx to the visitor, leaf first
+  void close_nodes(size_t parent_idx) {
+    for (size_t node_idx = m_stack.size() - 1; node_idx > parent_idx;
+         --node_idx) {
+      node& child = m_stack[node_idx];
+      typename TreeBuilder::representation_type subtrie = m_visitor->node(
+          child.children, &m_last_string[0], child.path_len, child.skip);
+      uint8_t branching_char = m_last_string[child.path_len - 1];
+      m_stack[node_idx - 1].children.push_back(
+          std::make_pair(branching_char, subtrie));
+    }
+    m_stack.resize(parent_idx + 1);
+  }
+
+  TreeBuilder* m_visitor;
+  std::vector<node> m_stack;
+  std::vector<uint8_t> m_last_string;
+  size_t m_num_strings;
 };
 }
 }
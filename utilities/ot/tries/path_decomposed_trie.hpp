@@ -191,6 +191,8 @@ struct path_decomposed_trie {
       while (true) {
         if (cur_pos == len) return -1;
 
+        cur_pos += label_enumerator.skip_prefix(s.first + cur_pos,
+                                                len - 1 - cur_pos);
         typename labels_pool_type::char_type label = label_enumerator.next();
         if (label >= branching_point) {
           branching_chars_begin += branching_chars;
@@ -212,26 +214,16 @@ struct path_decomposed_trie {
         }
       }
 
-      bool found_child = false;
+      size_t child = find_branching_char(first_child_rank, branching_chars_begin,
+                                         branching_chars, s.first[cur_pos]);
+      if (child == size_t(-1)) return -1;
 
-      for (size_t i = branching_chars_begin;
-           i < branching_chars_begin + branching_chars; ++i) {
-        uint8_t c = m_branching_chars[first_child_rank + i];
-        if (s.first[cur_pos] == c) {
-          cur_pos += 1;
-          found_child = true;
-
-          size_t child = i;
-          assert(child < m_bp.successor0(cur_node_pos) - cur_node_pos);
-          size_t child_open = cur_node_pos + child;
-          cur_node_pos = m_bp.find_close(child_open) + 1;
-          assert((cur_node_pos - child_open) % 2 == 0);
-          first_child_rank += child + (cur_node_pos - child_open) / 2;
-          break;
-        }
-      }
-
-      if (!found_child) return -1;
+      cur_pos += 1;
+      assert(child < m_bp.successor0(cur_node_pos) - cur_node_pos);
+      size_t child_open = cur_node_pos + child;
+      cur_node_pos = m_bp.find_close(child_open) + 1;
+      assert((cur_node_pos - child_open) % 2 == 0);
+      first_child_rank += child + (cur_node_pos - child_open) / 2;
     }
     assert(false);
     return 0;
@@ -242,6 +234,194 @@ struct path_decomposed_trie {
     return index(val, stl_string_adaptor());
   }
 
+  // Same as index(std::string(key, key + key_len)), without copying the key:
+  // the null terminator the trie expects is implied past key_len.
+  size_t index(const uint8_t* key, size_t key_len) const {
+    lookup_state st;
+    st.reset(key, key_len);
+    while (!st.done) {
+      enter_node(st);
+      if (st.done) break;
+      scan_node(st);
+      if (st.done) break;
+      descend(st);
+    }
+    return st.result;
+  }
+
+  // Looks up n keys, writing index() of each to results. Rather than
+  // walking the keys one after the other, all of them are advanced one trie
+  // node per round, and each phase of a round only prefetches what the next
+  // phase reads: the branching chars and labels of the node (enter_node) and
+  // the bp word of the chosen child (scan_node). The cache misses of the
+  // different keys thus overlap instead of forming one long chain.
+  void index_batch(const uint8_t* const* keys, const size_t* key_lens,
+                   size_t n, size_t* results) const {
+    lookup_state states[kMaxBatch];
+    for (size_t base = 0; base < n; base += kMaxBatch) {
+      size_t cnt = std::min(n - base, static_cast<size_t>(kMaxBatch));
+      size_t active = cnt;
+      for (size_t i = 0; i < cnt; ++i) {
+        states[i].reset(keys[base + i], key_lens[base + i]);
+      }
+      while (active > 0) {
+        for (size_t i = 0; i < cnt; ++i) {
+          if (!states[i].done) enter_node(states[i]);
+        }
+        for (size_t i = 0; i < cnt; ++i) {
+          if (!states[i].done) scan_node(states[i]);
+        }
+        active = 0;
+        for (size_t i = 0; i < cnt; ++i) {
+          if (!states[i].done) {
+            descend(states[i]);
+            ++active;
+          }
+        }
+      }
+      for (size_t i = 0; i < cnt; ++i) {
+        results[base + i] = states[i].result;
+      }
+    }
+  }
+
+  static const size_t kMaxBatch = 32;
+
+  // Rank of the first string not less than key, or size() if there is none.
+  // With Lexicographic the ranks follow the order of the strings, so the
+  // strings in [a, b) are the ranks in [lower_bound(a), lower_bound(b)).
+  // If exact is given, it tells whether that string is the key itself.
+  size_t lower_bound(const uint8_t* key, size_t key_len,
+                     bool* exact = 0) const {
+    BOOST_STATIC_ASSERT(Lexicographic);
+    lookup_state st;
+    st.reset(key, key_len);
+    if (exact) *exact = false;
+    // rank right past the subtree of the current node
+    size_t subtree_end = size();
+    while (true) {
+      enter_node(st);
+      if (st.done) {
+        if (exact) *exact = true;
+        return st.result;
+      }
+      size_t branching_chars_begin = 0;
+      size_t branching_chars = 0;
+      size_t last_branching_point = -1;
+      uint8_t c;
+      while (true) {
+        st.cur_pos += st.labels.skip_prefix(st.key + st.cur_pos,
+                                            st.len - 1 - st.cur_pos);
+        typename labels_pool_type::char_type label = st.labels.next();
+        if (label >= branching_point) {
+          branching_chars_begin += branching_chars;
+          branching_chars = label - branching_point + 1;
+          last_branching_point = st.cur_pos;
+          continue;
+        }
+        c = st.at(st.cur_pos);
+        if (c < label) {
+          // the key sorts before the whole subtree, whose smallest string is
+          // the one of this node
+          return st.rank0;
+        }
+        if (c > label || (!label && st.cur_pos + 1 < st.len)) {
+          break;
+        }
+        if (!label) {
+          if (exact) *exact = true;
+          return st.rank0;
+        }
+        st.cur_pos += 1;
+      }
+
+      // The key is past the string of this node and past the children that
+      // branch off deeper than cur_pos. A child of the node orders after the
+      // ones branching off deeper, and among those at the same depth by
+      // branching char, so look at the children branching off right here
+      // first, then at the deepest one branching off above.
+      size_t shallower_end = branching_chars_begin + branching_chars;
+      if (last_branching_point == st.cur_pos) {
+        shallower_end = branching_chars_begin;
+        size_t found = -1;
+        size_t next_rank = -1;
+        for (size_t i = branching_chars_begin;
+             i < branching_chars_begin + branching_chars; ++i) {
+          uint8_t bc = m_branching_chars[st.first_child_rank + i];
+          if (bc == c) {
+            found = i;
+            break;
+          } else if (bc > c) {
+            next_rank = std::min(next_rank, child_rank(st.cur_node_pos + i));
+          }
+        }
+        if (found != size_t(-1)) {
+          if (found > 0) {
+            subtree_end = child_rank(st.cur_node_pos + found - 1);
+          }
+          st.cur_pos += 1;
+          st.first_child_rank += found;
+          st.child_open = st.cur_node_pos + found;
+          descend(st);
+          continue;
+        }
+        if (next_rank != size_t(-1)) return next_rank;
+      }
+      return shallower_end == 0
+                 ? subtree_end
+                 : child_rank(st.cur_node_pos + shallower_end - 1);
+    }
+  }
+
+  // Rank of the longest string that is a prefix of key, key itself
+  // included, or -1 if there is none
+  size_t longest_prefix(const uint8_t* key, size_t key_len) const {
+    BOOST_STATIC_ASSERT(Lexicographic);
+    size_t result = -1;
+    size_t cur_pos = 0;
+    size_t cur_node_pos = 1;
+    size_t first_child_rank = 0;
+    while (true) {
+      size_t rank0 = cur_node_pos - first_child_rank - 1;
+      typename labels_pool_type::string_enumerator label_enumerator =
+          m_labels.get_string_enumerator(rank0);
+      size_t branching_chars_begin = 0;
+      size_t branching_chars = 0;
+      size_t last_branching_point = -1;
+      while (true) {
+        cur_pos +=
+            label_enumerator.skip_prefix(key + cur_pos, key_len - cur_pos);
+        typename labels_pool_type::char_type label = label_enumerator.next();
+        if (label >= branching_point) {
+          branching_chars_begin += branching_chars;
+          branching_chars = label - branching_point + 1;
+          last_branching_point = cur_pos;
+          continue;
+        }
+        if (!label) {
+          // the string of this node ends here. A string ending at a branching
+          // point is never a child, the smallest child is on the path.
+          result = rank0;
+          break;
+        }
+        if (cur_pos == key_len || label != key[cur_pos]) break;
+        cur_pos += 1;
+      }
+
+      // only the children branching off right here can match further
+      if (last_branching_point != cur_pos || cur_pos == key_len) {
+        return result;
+      }
+      size_t child = find_branching_char(first_child_rank, branching_chars_begin,
+                                         branching_chars, key[cur_pos]);
+      if (child == size_t(-1)) return result;
+      cur_pos += 1;
+      size_t child_open = cur_node_pos + child;
+      cur_node_pos = m_bp.find_close(child_open) + 1;
+      first_child_rank += child + (cur_node_pos - child_open) / 2;
+    }
+  }
+
   std::string operator[](size_t idx) const {
     std::string ret;
     ret.reserve(256);  // reasonable tradeoff
@@ -349,6 +529,122 @@ struct path_decomposed_trie {
   typedef uint16_t label_char_type;
   static const size_t branching_point = 256;
 
+  // One lookup of index(), split at the node boundaries so that several of
+  // them can be interleaved
+  struct lookup_state {
+    void reset(const uint8_t* k, size_t k_len) {
+      key = k;
+      len = k_len + 1;  // account for the implied null terminator
+      cur_pos = 0;
+      cur_node_pos = 1;
+      first_child_rank = 0;
+      result = -1;
+      done = false;
+    }
+
+    uint8_t at(size_t pos) const { return pos + 1 < len ? key[pos] : 0; }
+
+    const uint8_t* key;
+    size_t len;
+    size_t cur_pos;
+    size_t cur_node_pos;
+    size_t first_child_rank;
+    size_t rank0;
+    size_t child_open;
+    size_t result;
+    bool done;
+    typename labels_pool_type::string_enumerator labels;
+  };
+
+  // Starts visiting the node at st.cur_node_pos. Creating the label
+  // enumerator prefetches the labels of the node.
+  void enter_node(lookup_state& st) const {
+    st.rank0 = st.cur_node_pos - st.first_child_rank - 1;
+    if (st.cur_pos == st.len) {
+      st.result = st.rank0;
+      st.done = true;
+      return;
+    }
+    m_branching_chars.prefetch(st.first_child_rank);
+    st.labels = m_labels.get_string_enumerator(st.rank0);
+  }
+
+  // Matches the key against the labels of the node, then picks the child to
+  // descend to and prefetches its position in the bp vector
+  void scan_node(lookup_state& st) const {
+    size_t branching_chars_begin = 0;
+    size_t branching_chars = 0;
+    size_t last_branching_point = -1;
+    while (true) {
+      if (st.cur_pos == st.len) {
+        st.done = true;
+        return;
+      }
+
+      st.cur_pos += st.labels.skip_prefix(st.key + st.cur_pos,
+                                          st.len - 1 - st.cur_pos);
+      typename labels_pool_type::char_type label = st.labels.next();
+      if (label >= branching_point) {
+        branching_chars_begin += branching_chars;
+        branching_chars = label - branching_point + 1;
+        last_branching_point = st.cur_pos;
+      } else {
+        uint8_t c = st.at(st.cur_pos);
+        if (label != c) {
+          if (last_branching_point != st.cur_pos) {
+            st.done = true;
+            return;
+          }
+          break;
+        }
+        st.cur_pos += 1;
+        if (!label) {
+          if (st.cur_pos == st.len) st.result = st.rank0;
+          st.done = true;
+          return;
+        }
+      }
+    }
+
+    size_t child =
+        find_branching_char(st.first_child_rank, branching_chars_begin,
+                            branching_chars, st.at(st.cur_pos));
+    if (child == size_t(-1)) {
+      st.done = true;
+      return;
+    }
+    st.cur_pos += 1;
+    st.first_child_rank += child;
+    st.child_open = st.cur_node_pos + child;
+    m_bp.data().prefetch(st.child_open / 64);
+  }
+
+  // Index among the children of the node whose first child has rank
+  // first_child_rank of the child branching off with c, looking only at the
+  // branching_chars children from branching_chars_begin on, which branch off
+  // at the same position. -1 if there is none.
+  size_t find_branching_char(size_t first_child_rank,
+                             size_t branching_chars_begin,
+                             size_t branching_chars, uint8_t c) const {
+    size_t i = intrinsics::find_byte(
+        m_branching_chars.data() + first_child_rank + branching_chars_begin,
+        branching_chars, c);
+    return i < branching_chars ? branching_chars_begin + i : size_t(-1);
+  }
+
+  // Rank of the first string in the subtree of the child opened at
+  // child_open, that is the rank of the child itself
+  size_t child_rank(size_t child_open) const {
+    return m_bp.rank0(m_bp.find_close(child_open) + 1);
+  }
+
+  // Moves to the child picked by scan_node
+  void descend(lookup_state& st) const {
+    st.cur_node_pos = m_bp.find_close(st.child_open) + 1;
+    assert((st.cur_node_pos - st.child_open) % 2 == 0);
+    st.first_child_rank += (st.cur_node_pos - st.child_open) / 2;
+  }
+
   struct centroid_builder_visitor {
     centroid_builder_visitor() {}
 
@@ -479,9 +775,11 @@ struct path_decomposed_trie {
     centroid_builder_visitor visitor;
     succinct::tries::compacted_trie_builder<centroid_builder_visitor> builder;
     builder.build(visitor, strings, adaptor);
-    typename centroid_builder_visitor::representation_type root =
-        visitor.get_root();
+    build_from_root(visitor.get_root());
+  }
 
+  void build_from_root(
+      typename centroid_builder_visitor::representation_type const& root) {
 //    fprintf(stderr, "DEBUG t192nz strings.size():%lu\n", strings.size());
     bp_vector(&root->m_bp, false, true).swap(m_bp);
     branching_chars_type(root->m_branching_chars).swap(m_branching_chars);
@@ -491,6 +789,51 @@ struct path_decomposed_trie {
     assert(m_labels.size() == m_bp.size() / 2);
   }
 
+ public:
+  // Builds the trie from strings added one at a time, in sorted order and
+  // without duplicates, instead of from a range of all of them: only the
+  // path to the last string stays open, the subtries left of it are kept
+  // in their compacted form.
+  class incremental_builder {
+   public:
+    incremental_builder() : m_started(false) {}
+
+    template <typename T, typename Adaptor>
+    void append(T const& val, Adaptor adaptor) {
+      if (!m_started) {
+        m_builder.start(m_visitor);
+        m_started = true;
+      }
+      m_builder.append(adaptor(val));
+    }
+
+    // Number of strings appended since the last finish()
+    size_t size() const { return m_started ? m_builder.num_strings() : 0; }
+
+    // Moves the strings appended so far into trie, and starts over. trie is
+    // left empty if there were none.
+    void finish(path_decomposed_trie& trie) {
+      if (size() == 0) {
+        path_decomposed_trie().swap(trie);
+        return;
+      }
+      m_builder.finish();
+      m_started = false;
+      typename centroid_builder_visitor::representation_type root =
+          m_visitor.get_root();
+      m_visitor = centroid_builder_visitor();
+      trie.build_from_root(root);
+    }
+
+   private:
+    centroid_builder_visitor m_visitor;
+    succinct::tries::compacted_trie_builder<centroid_builder_visitor>
+        m_builder;
+    bool m_started;
+  };
+
+ private:
+
   //xp
   template <typename Range, typename Adaptor>
   void build_essential(Range const& strings, Adaptor adaptor) {
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <sstream>
 
 #include "succinct/elias_fano.hpp"
+#include "succinct/intrinsics.hpp"
 #include "succinct/vbyte.hpp"
 
 namespace rocksdb {
@@ -62,6 +64,19 @@ struct vbyte_string_pool {
       return val;
     }
 
+    // Skips the chars at the front of the string that match the first n
+    // bytes of key, as long as they are below 0x80 and thus encoded in one
+    // byte each, comparing many of them at a time. Returns how many were
+    // skipped; next() goes on with the first char that was not.
+    size_t skip_prefix(const uint8_t* key, size_t n) {
+      assert(m_sp);
+      size_t skipped = intrinsics::ascii_prefix_length(
+          m_sp->m_byte_streams.data() + m_begin, key,
+          std::min(n, m_end - m_begin));
+      m_begin += skipped;
+      return skipped;
+    }
+
     friend struct vbyte_string_pool;
 
    private:
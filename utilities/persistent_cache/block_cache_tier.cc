@@ -6,18 +6,79 @@
 
 #include "utilities/persistent_cache/block_cache_tier.h"
 
+#include <sys/uio.h>
+
+#include <algorithm>
+#include <climits>
+#include <iterator>
 #include <regex>
 #include <utility>
 #include <vector>
 
 #include "logging/logging.h"
+#include "monitoring/statistics.h"
 #include "port/port.h"
 #include "test_util/sync_point.h"
+#include "util/coding.h"
 #include "util/stop_watch.h"
 #include "utilities/persistent_cache/block_cache_tier_file.h"
 
 namespace rocksdb {
 
+namespace {
+// written to the unused end of the last extent of a block to coalesce it
+// with the next write
+const char kZeroPadding[SPACE_SIZE] = {0};
+
+// Writes all of iov at offset, going on after short writes. iov is
+// consumed in the process.
+bool PwritevFully(int fd, struct iovec* iov, int iovcnt, uint64_t offset) {
+  while (iovcnt > 0) {
+    int cnt = iovcnt;
+    TEST_SYNC_POINT_CALLBACK("SST_space::Put:Pwritev", &cnt);
+    ssize_t t = pwritev(fd, iov, cnt, offset);
+    if (t < 0 && errno == EINTR) {
+      continue;
+    }
+    if (t <= 0) {
+      return false;
+    }
+    offset += t;
+    size_t done = static_cast<size_t>(t);
+    while (iovcnt > 0 && done >= iov->iov_len) {
+      done -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + done;
+      iov->iov_len -= done;
+    }
+  }
+  return true;
+}
+
+// Reads len bytes at offset, going on after short reads. Fails if the file
+// ends before, e.g. when it was truncated.
+bool PreadFully(int fd, char* buf, size_t len, uint64_t offset) {
+  while (len > 0) {
+    size_t n = len;
+    TEST_SYNC_POINT_CALLBACK("SST_space::Get:Pread", &n);
+    ssize_t t = pread(fd, buf, n, offset);
+    if (t < 0 && errno == EINTR) {
+      continue;
+    }
+    if (t <= 0) {
+      return false;
+    }
+    buf += t;
+    len -= static_cast<size_t>(t);
+    offset += t;
+  }
+  return true;
+}
+}  // namespace
+
 //
 // BlockCacheImpl
 //
@@ -174,6 +235,10 @@ PersistentCache::StatsType BlockCacheTier::Stats() {
       stats_.bytes_read_.Average());
   Add(&stats, "persistentcache.blockcachetier.insert_dropped",
       stats_.insert_dropped_);
+  Add(&stats, "persistentcache.blockcachetier.insert_admitted",
+      stats_.insert_admitted_);
+  Add(&stats, "persistentcache.blockcachetier.insert_rejected",
+      stats_.insert_rejected_);
   Add(&stats, "persistentcache.blockcachetier.cache_hits", stats_.cache_hits_);
   Add(&stats, "persistentcache.blockcachetier.cache_misses",
       stats_.cache_misses_);
@@ -198,6 +263,14 @@ PersistentCache::StatsType BlockCacheTier::Stats() {
 Status BlockCacheTier::Insert(const Slice& key, const char* data,
                               const size_t size, bool is_meta_block,
                               std::string) {
+  if (opt_.admission_policy) {
+    if (!opt_.admission_policy->Admit(key)) {
+      stats_.insert_rejected_++;
+      return Status::OK();
+    }
+    stats_.insert_admitted_++;
+  }
+
   // update stats
   stats_.bytes_pipelined_.Add(size);
 
@@ -332,6 +405,10 @@ Status BlockCacheTier::Lookup(const Slice& key, std::unique_ptr<char[]>* val,
                               size_t* size, std::string) {
   StopWatchNano timer(opt_.env, /*auto_start=*/true);
 
+  if (opt_.admission_policy) {
+    opt_.admission_policy->RecordAccess(key);
+  }
+
   bool find_in_meta_block = false;
 
   LBA lba;
@@ -618,196 +695,504 @@ Status NewPersistentmyCache(Env* const env, const std::string& path,
 
 Status SST_space::Get(const std::string key, std::unique_ptr<char[]>* data,
                       size_t* size) {
-  MutexLock _(&lock);
-  if (!cache.count(key)) {
-    return Status::NotFound("Mycache not found");
+  DLinkedNode* node;
+  bool verify;
+  {
+    MutexLock _(&lock);
+    auto iter = cache.find(key);
+    if (iter == cache.end()) {
+      return Status::NotFound("Mycache not found");
+    }
+    node = iter->second;
+    moveToHead(node);
+    // the extents of a published node do not change, and the pin keeps them
+    // from being reused until the reads are done
+    node->refs++;
+    verify = node->value.unverified;
   }
-  DLinkedNode* node = cache[key];
-  moveToHead(node);
+
   data->reset(new char[node->value.size]);
   *size = node->value.size;
+  // one read per extent
+  Status s;
   size_t cur = 0;
-  for (uint32_t i = 0; i < (node->value.offset.size() - 1); i++) {
-    ssize_t t =
-        pread(fd, data->get() + cur, SPACE_SIZE, begin + node->value.offset[i]);
-    if (t < 0) {
-      return Status::IOError();
-    }
-    cur += SPACE_SIZE;
-  }
-  int left_size = node->value.size % SPACE_SIZE == 0
-                      ? SPACE_SIZE
-                      : node->value.size % SPACE_SIZE;
-  int index = node->value.offset.size() - 1;
-  ssize_t t = pread(fd, data->get() + cur, left_size,
-                    begin + node->value.offset[index]);
-  if (t < 0) {
-    return Status::IOError();
+  for (const Extent& extent : node->value.extents) {
+    size_t len = std::min(static_cast<size_t>(extent.num) * SPACE_SIZE,
+                          node->value.size - cur);
+    if (!PreadFully(fd, data->get() + cur, len,
+                    begin + static_cast<uint64_t>(extent.slot) * SPACE_SIZE)) {
+      s = Status::IOError("Mycache read failed");
+      break;
+    }
+    cur += len;
   }
-  return Status::OK();
-}
+  bool corrupted = s.ok() && verify &&
+                   crc32c::Value(data->get(), *size) != node->value.checksum;
 
-void SST_space::Put(const std::string& key, const std::string& value,
-                    uint64_t& out, bool is_meta) {
   MutexLock _(&lock);
-  if (value.size() == 0) {
-    return;
+  if (corrupted) {
+    // the space was reused after the metadata was saved
+    if (!node->dropped) {
+      removeNode(node);
+      dropNode(node);
+    }
+    s = Status::NotFound("Mycache checksum mismatch");
+  } else if (s.ok() && verify) {
+    node->value.unverified = false;
   }
-  uint32_t need_num = value.size() / SPACE_SIZE;
-  need_num += value.size() % SPACE_SIZE == 0 ? 0 : 1;
-  if (need_num > all_num)// || need_num > 1) {
-  {
-    return;
+  unpin(node);
+  if (!s.ok()) {
+    data->reset();
   }
-  DLinkedNode* node;
-  if (!cache.count(key))  // key不存在 创建新节点
+  return s;
+}
+
+bool SST_space::prepareNode(DLinkedNode* node, uint32_t need_num,
+                            uint64_t* out) {
+  auto iter = cache.find(node->key);
+  if (iter != cache.end()) {  // key存在 替换旧节点
+    DLinkedNode* old = iter->second;
+    removeNode(old);
+    dropNode(old);
+  }
+  while (need_num > empty_num && head->next != tail) {
+    DLinkedNode* tail_ = getTail();
+    if (tail_->out) {
+      tail_->out--;
+      moveToHead(tail_);
+      continue;
+    }
+    (*out)++;
+    DLinkedNode* removed = removeTail();
+    dropNode(removed);
+  }
+  if (need_num > empty_num) {
+    // the rest of the space is pinned by readers
+    return false;
+  }
+  allocate(need_num, &node->value.extents);
+  return true;
+}
+
+void SST_space::publishNode(DLinkedNode* node) {
+  auto iter = cache.find(node->key);
+  if (iter != cache.end()) {
+    // put again meanwhile
+    DLinkedNode* old = iter->second;
+    removeNode(old);
+    dropNode(old);
+  }
+  cache[node->key] = node;
+  addToFile(node);
+  addToHead(node);
+}
+
+SST_space::PutResult SST_space::Put(const PutRequest* reqs, size_t n) {
+  // nodes[i] is the node of reqs[i], null if it is not cached
+  std::vector<DLinkedNode*> nodes(n, nullptr);
+  for (size_t i = 0; i < n; i++) {
+    const Slice& value = reqs[i].value;
+    if (value.size() == 0 ||
+        (value.size() + SPACE_SIZE - 1) / SPACE_SIZE > all_num) {
+      continue;
+    }
+    DLinkedNode* node = new DLinkedNode();
+    node->key = reqs[i].key.ToString();
+    node->fname = reqs[i].fname.ToString();
+    node->out = reqs[i].is_meta ? 1 : 0;
+    node->value.size = value.size();
+    node->value.checksum = crc32c::Value(value.data(), value.size());
+    nodes[i] = node;
+  }
+
+  PutResult result;
+  // the blocks written one after the other
+  struct Piece {
+    uint32_t slot;
+    uint32_t num;
+    const char* data;
+    size_t len;
+    size_t req;
+  };
+  std::vector<Piece> pieces;
   {
-    node = new DLinkedNode();
-    node->key = key;
-    node->value.offset.clear();
-    node->out = is_meta ? 1 : 0;
-    cache[key] = node;
-    addToHead(node);
-    while (need_num > empty_num) {
-      DLinkedNode* tail_ = getTail();
-      if (tail_->out) {
-        tail_->out--;
-        moveToHead(tail_);
+    MutexLock _(&lock);
+    for (size_t i = 0; i < n; i++) {
+      DLinkedNode* node = nodes[i];
+      if (node == nullptr) {
         continue;
       }
-      //fprintf(stderr,"out\n");
-      out++;
-      DLinkedNode* removed = removeTail();
-      cache.erase(removed->key);
-      removeRecord(&(removed->value));
-      delete removed;
-    }
-  } else {
-    node = cache[key];
-    node->out = is_meta ? 1 : 0;
-    moveToHead(node);
-    removeRecord(&(node->value));
-    while (need_num > empty_num) {
-      DLinkedNode* tail_ = getTail();
-      if (tail_->out) {
-        tail_->out--;
-        moveToHead(tail_);
+      uint32_t need_num = static_cast<uint32_t>(
+          (node->value.size + SPACE_SIZE - 1) / SPACE_SIZE);
+      if (!prepareNode(node, need_num, &result.evicted)) {
+        delete node;
+        nodes[i] = nullptr;
         continue;
       }
-      //fprintf(stderr,"out\n");
-      out++;
-      DLinkedNode* removed = removeTail();
-      cache.erase(removed->key);
-      removeRecord(&(removed->value));
-      delete removed;
+      size_t cur = 0;
+      for (const Extent& extent : node->value.extents) {
+        size_t len = std::min(static_cast<size_t>(extent.num) * SPACE_SIZE,
+                              node->value.size - cur);
+        pieces.push_back(
+            Piece{extent.slot, extent.num, reqs[i].value.data() + cur, len, i});
+        cur += len;
+      }
     }
   }
-  empty_num -= need_num;
 
-  if (empty_nodes.size() >= need_num) {
-    for (uint32_t i = 0; i < empty_nodes.size() && i < need_num; i++) {
-      node->value.offset.push_back(empty_nodes[i] * SPACE_SIZE);
-      bit_map[empty_nodes[i]]=1;
+  //写块 the extents are reserved but not yet visible to readers. Runs of
+  // extents adjacent in the file are written at once, the gap after the
+  // last piece of a block padded with zeroes.
+  std::sort(pieces.begin(), pieces.end(),
+            [](const Piece& a, const Piece& b) { return a.slot < b.slot; });
+  std::vector<bool> failed(n, false);
+  std::vector<struct iovec> iov;
+  for (size_t first = 0; first < pieces.size();) {
+    size_t last = first;
+    iov.clear();
+    while (true) {
+      iov.push_back({const_cast<char*>(pieces[last].data), pieces[last].len});
+      if (last + 1 == pieces.size() ||
+          pieces[last].slot + pieces[last].num != pieces[last + 1].slot ||
+          iov.size() + 2 > IOV_MAX) {
+        break;
+      }
+      size_t pad = pieces[last].num * SPACE_SIZE - pieces[last].len;
+      if (pad > 0) {
+        iov.push_back({const_cast<char*>(kZeroPadding), pad});
+      }
+      last++;
     }
-    empty_nodes.clear();
-  } else {
-    uint32_t num = 0, j = (last + 1) % bit_map.size();
-    while (j != last) {
-      if (!bit_map[j]) {
-        bit_map[j] = 1;
-        node->value.offset.push_back(j * SPACE_SIZE);
-        num++;
-        if (num == need_num) {
-          last=j;
-          break;
-        }
+    if (!PwritevFully(
+            fd, iov.data(), static_cast<int>(iov.size()),
+            begin + static_cast<uint64_t>(pieces[first].slot) * SPACE_SIZE)) {
+      for (size_t j = first; j <= last; j++) {
+        failed[pieces[j].req] = true;
       }
-      j=(j+1)%bit_map.size();
-    }
-  }
-
-  // node->value.offset.push_back(0);
-  // //取块
-  // uint32_t num = 0, j = 0;
-  // while (j < bit_map.size()) {
-  //   if (!bit_map[j]) {
-  //     bit_map[j] = 1;
-  //     node->value.offset.push_back(j * SPACE_SIZE);
-  //     num++;
-  //     if (num == need_num) {
-  //       break;
-  //     }
-  //   }
-  //   j++;
-  // }
-
-  //写块
-  size_t cur = 0;
-  for (uint32_t i = 0; i < node->value.offset.size() - 1; i++) {
-    ssize_t t = pwrite(fd, value.c_str() + cur, SPACE_SIZE,
-                       begin + node->value.offset[i]);
-    if (t < 0) {
-      return;
     }
-    cur += SPACE_SIZE;
+    first = last + 1;
+  }
+
+  MutexLock _(&lock);
+  for (size_t i = 0; i < n; i++) {
+    DLinkedNode* node = nodes[i];
+    if (node == nullptr) {
+      continue;
+    }
+    if (failed[i]) {
+      removeRecord(&(node->value));
+      delete node;
+      continue;
+    }
+    result.added++;
+    result.bytes_written += node->value.size;
+    publishNode(node);
+  }
+  return result;
+}
+
+void SST_space::AddSpaceStats(SpaceStats* stats) {
+  MutexLock _(&lock);
+  stats->blocks += cache.size();
+  for (const auto& entry : cache) {
+    const Record& record = entry.second->value;
+    if (record.extents.size() > 1) {
+      stats->fragmented_blocks++;
+    }
+  }
+  stats->used_bytes += static_cast<uint64_t>(all_num - empty_num) * SPACE_SIZE;
+  stats->free_bytes += static_cast<uint64_t>(empty_num) * SPACE_SIZE;
+  stats->free_extents += free_extents.size();
+  if (!free_by_size.empty()) {
+    stats->largest_free_extent =
+        std::max(stats->largest_free_extent,
+                 static_cast<uint64_t>(free_by_size.rbegin()->first) *
+                     SPACE_SIZE);
+  }
+}
+
+void SST_space::allocate(uint32_t num, std::vector<Extent>* extents) {
+  assert(num <= empty_num);
+  while (num > 0) {
+    auto iter = free_by_size.lower_bound(std::make_pair(num, 0u));
+    if (iter == free_by_size.end()) {
+      // fragmented, no free extent is large enough
+      --iter;
+    }
+    Extent extent{iter->second, std::min(num, iter->first)};
+    bool reserved = reserveExtent(extent);
+    assert(reserved);
+    (void)reserved;
+    extents->push_back(extent);
+    num -= extent.num;
+  }
+}
+
+void SST_space::freeExtent(Extent extent) {
+  empty_num += extent.num;
+  auto next = free_extents.lower_bound(extent.slot);
+  if (next != free_extents.end() && extent.slot + extent.num == next->first) {
+    extent.num += next->second;
+    free_by_size.erase(std::make_pair(next->second, next->first));
+    next = free_extents.erase(next);
+  }
+  if (next != free_extents.begin()) {
+    auto prev = std::prev(next);
+    if (prev->first + prev->second == extent.slot) {
+      extent.slot = prev->first;
+      extent.num += prev->second;
+      free_by_size.erase(std::make_pair(prev->second, prev->first));
+      free_extents.erase(prev);
+    }
+  }
+  free_extents.emplace(extent.slot, extent.num);
+  free_by_size.emplace(extent.num, extent.slot);
+}
+
+bool SST_space::reserveExtent(Extent extent) {
+  // the free extent starting at or before extent
+  auto iter = free_extents.upper_bound(extent.slot);
+  if (iter == free_extents.begin()) {
+    return false;
+  }
+  --iter;
+  uint32_t free_slot = iter->first, free_num = iter->second;
+  if (extent.num == 0 ||
+      static_cast<uint64_t>(extent.slot) + extent.num >
+          static_cast<uint64_t>(free_slot) + free_num) {
+    return false;
+  }
+  free_by_size.erase(std::make_pair(free_num, free_slot));
+  free_extents.erase(iter);
+  if (free_slot < extent.slot) {
+    free_extents.emplace(free_slot, extent.slot - free_slot);
+    free_by_size.emplace(extent.slot - free_slot, free_slot);
+  }
+  uint32_t end = extent.slot + extent.num;
+  if (end < free_slot + free_num) {
+    free_extents.emplace(end, free_slot + free_num - end);
+    free_by_size.emplace(free_slot + free_num - end, end);
+  }
+  empty_num -= extent.num;
+  return true;
+}
+
+void SST_space::EncodeTo(std::string* dst) {
+  MutexLock _(&lock);
+  PutVarint64(dst, cache.size());
+  for (DLinkedNode* node = head->next; node != tail; node = node->next) {
+    PutLengthPrefixedSlice(dst, node->key);
+    PutLengthPrefixedSlice(dst, node->fname);
+    PutVarint64(dst, node->value.size);
+    PutFixed32(dst, node->value.checksum);
+    PutVarint32(dst, static_cast<uint32_t>(node->out));
+    PutVarint32(dst, static_cast<uint32_t>(node->value.extents.size()));
+    for (const Extent& extent : node->value.extents) {
+      PutVarint32(dst, extent.slot);
+      PutVarint32(dst, extent.num);
+    }
+  }
+}
+
+Status SST_space::DecodeFrom(
+    Slice* input, const std::function<bool(const std::string&)>& is_live) {
+  MutexLock _(&lock);
+  uint64_t num_entries;
+  if (!GetVarint64(input, &num_entries)) {
+    return Status::Corruption("bad myCache metadata");
+  }
+  std::vector<Extent> extents;
+  for (uint64_t i = 0; i < num_entries; i++) {
+    Slice key, fname;
+    uint64_t size;
+    uint32_t checksum, out, num_extents;
+    if (!GetLengthPrefixedSlice(input, &key) ||
+        !GetLengthPrefixedSlice(input, &fname) ||
+        !GetVarint64(input, &size) || !GetFixed32(input, &checksum) ||
+        !GetVarint32(input, &out) || !GetVarint32(input, &num_extents)) {
+      return Status::Corruption("bad myCache metadata");
+    }
+    extents.resize(num_extents);
+    uint64_t num_slots = 0;
+    for (Extent& extent : extents) {
+      if (!GetVarint32(input, &extent.slot) ||
+          !GetVarint32(input, &extent.num)) {
+        return Status::Corruption("bad myCache metadata");
+      }
+      num_slots += extent.num;
+    }
+    std::string skey = key.ToString();
+    if (size == 0 || num_slots != (size + SPACE_SIZE - 1) / SPACE_SIZE ||
+        cache.count(skey) || !is_live(fname.ToString())) {
+      continue;
+    }
+    size_t num_reserved = 0;
+    while (num_reserved < extents.size() &&
+           reserveExtent(extents[num_reserved])) {
+      num_reserved++;
+    }
+    if (num_reserved < extents.size()) {
+      // overlaps another entry
+      for (size_t j = 0; j < num_reserved; j++) {
+        freeExtent(extents[j]);
+      }
+      continue;
+    }
+    DLinkedNode* node = new DLinkedNode();
+    node->key = std::move(skey);
+    node->fname = fname.ToString();
+    node->out = static_cast<int>(out);
+    node->value.extents = extents;
+    node->value.size = static_cast<size_t>(size);
+    node->value.checksum = checksum;
+    node->value.unverified = true;
+    cache[node->key] = node;
+    addToFile(node);
+    // entries come most recently used first
+    addToTail(node);
+  }
+  return Status::OK();
+}
+
+size_t SST_space::EraseFile(const std::string& fname) {
+  MutexLock _(&lock);
+  auto iter = file_nodes.find(fname);
+  if (iter == file_nodes.end()) {
+    return 0;
   }
-  node->value.size = value.size();
-  size_t left_size =
-      value.size() % SPACE_SIZE == 0 ? SPACE_SIZE : value.size() % SPACE_SIZE;
-  int index = node->value.offset.size() - 1;
-  ssize_t t = pwrite(fd, value.c_str() + cur, left_size,
-                     begin + node->value.offset[index]);
-  if (t < 0) {
-    return;
+  std::vector<DLinkedNode*> nodes(iter->second.begin(), iter->second.end());
+  for (DLinkedNode* node : nodes) {
+    removeNode(node);
+    dropNode(node);
   }
+  return nodes.size();
 }
 
 Status myCache::Insert(const Slice& key, const char* data, const size_t size,
                        bool is_meta, std::string fname) {
-  // Insert2(std::string(key.data(), key.size()), std::string(data, size),
-  // fname); return Status::OK(); if(is_meta)
-  // {
-  //   fprintf(stderr,"insert size=%ld\n",size);
-  // }
+  // closed, the blocks demoted by the block cache may still come. The
+  // first check keeps the ops coming during Close() off the lock
+  if (closed_) {
+    return Status::NotSupported("myCache is closed");
+  }
+  ReadLock _(&lock_);
+  if (closed_) {
+    return Status::NotSupported("myCache is closed");
+  }
+  if (opt_.admission_policy) {
+    if (!opt_.admission_policy->Admit(key)) {
+      insert_rejected_++;
+      RecordTick(opt_.statistics.get(), PERSISTENT_CACHE_ADD_REJECTED);
+      return Status::OK();
+    }
+    insert_admitted_++;
+  }
   if (opt_.pipeline_writes) {
-    insert_ops_.Push(myInsertOp(key.ToString(),
-                                std::move(std::string(data, size)), is_meta,
-                                std::move(fname)));
+    int index = getIndex(fname, true);
+    auto& ops = insert_ops_[index % insert_ops_.size()];
+    if (!ops->Push(myInsertOp(key.ToString(), data, size, is_meta,
+                              std::move(fname), index))) {
+      // overloaded, the block is not worth delaying the reader
+      insert_dropped_++;
+      RecordTick(opt_.statistics.get(), PERSISTENT_CACHE_ADD_DROPPED);
+    }
     return Status::OK();
   }
-  InsertImpl(std::string(key.data(), key.size()), std::string(data, size),
-             is_meta, fname);
-  return Status::OK();
+  return InsertImpl(key, Slice(data, size), is_meta, fname);
 }
-void myCache::InsertMain() {
-  while (true) {
-    myInsertOp op(insert_ops_.Pop());
-
-    if (op.signal_) {
-      // that is a secret signal to exit
-      break;
+void myCache::InsertMain(size_t shard) {
+  std::vector<myInsertOp> ops;
+  std::vector<myInsertOp*> sorted;
+  std::vector<SST_space::PutRequest> reqs;
+  bool quit = false;
+  while (!quit) {
+    ops.clear();
+    insert_ops_[shard]->PopBatch(&ops, kMaxInsertBatch);
+
+    // put the inserts of every partition at once, in order
+    sorted.clear();
+    for (auto& op : ops) {
+      if (op.signal_) {
+        // that is a secret signal to exit
+        quit = true;
+        continue;
+      }
+      sorted.push_back(&op);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const myInsertOp* a, const myInsertOp* b) {
+                       return a->index_ < b->index_;
+                     });
+    for (size_t first = 0; first < sorted.size();) {
+      reqs.clear();
+      size_t last = first;
+      while (last < sorted.size() &&
+             sorted[last]->index_ == sorted[first]->index_) {
+        const myInsertOp* op = sorted[last++];
+        reqs.push_back(SST_space::PutRequest{
+            op->key_, Slice(op->data_.get(), op->size_), op->fname_,
+            op->is_meta});
+      }
+      PutBlocks(sorted[first]->index_, reqs.data(), reqs.size());
+      first = last;
     }
-    InsertImpl(op.key_, op.value_, op.is_meta, op.fname_);
   }
 }
 
 Status myCache::Lookup(const Slice& key, std::unique_ptr<char[]>* data,
                        size_t* size, std::string fname) {
-  // MutexLock _(&lock_);
+  if (closed_) {
+    return Status::NotFound("myCache is closed");
+  }
+  ReadLock _(&lock_);
+  if (closed_) {
+    return Status::NotFound("myCache is closed");
+  }
+  if (opt_.admission_policy) {
+    opt_.admission_policy->RecordAccess(key);
+  }
   std::string skey(key.data(), key.size());
   int index = getIndex(fname);
-  Status s = v[index].Get(skey, data, size);
+  Status s;
+  {
+    StopWatch sw(opt_.env, opt_.statistics.get(),
+                 PERSISTENT_CACHE_READ_MICROS);
+    s = v[index].Get(skey, data, size);
+  }
+  if (s.ok()) {
+    hits_++;
+    bytes_read_ += *size;
+    RecordTick(opt_.statistics.get(), PERSISTENT_CACHE_BYTES_READ, *size);
+  } else {
+    misses_++;
+  }
   return s;
 }
 
-Status myCache::InsertImpl(const std::string& key, const std::string& value,
-                           bool is_meta, std::string& fname) {
-  // MutexLock _(&lock_);
+Status myCache::InsertImpl(const Slice& key, const Slice& value,
+                           bool is_meta, const std::string& fname) {
   int index = getIndex(fname, true);
-  v[index].Put(key, value, outall, is_meta);
+  SST_space::PutRequest req{key, value, fname, is_meta};
+  PutBlocks(index, &req, 1);
   return Status::OK();
 }
 
+void myCache::PutBlocks(int index, const SST_space::PutRequest* reqs,
+                        size_t n) {
+  Statistics* statistics = opt_.statistics.get();
+  SST_space::PutResult result;
+  {
+    StopWatch sw(opt_.env, statistics, PERSISTENT_CACHE_WRITE_MICROS);
+    result = v[index].Put(reqs, n);
+  }
+  outall += result.evicted;
+  inserts_ += result.added;
+  bytes_written_ += result.bytes_written;
+  RecordTick(statistics, PERSISTENT_CACHE_ADD, result.added);
+  RecordTick(statistics, PERSISTENT_CACHE_BYTES_WRITE, result.bytes_written);
+  RecordTick(statistics, PERSISTENT_CACHE_EVICT, result.evicted);
+}
+
 int myCache::getIndex(std::string fname, bool) {
   if (fname.size() == 0) {
     return 0;
@@ -834,57 +1219,255 @@ int myCache::getIndex(std::string fname, bool) {
   return sum % NUM;
 }
 
+Status myCache::SaveMetadata() {
+  // the saved entries may only refer to data that reached the device; data
+  // written past this point is caught by the checksums
+  if (fdatasync(fd) != 0) {
+    return Status::IOError("While syncing " + GetDataPath(), strerror(errno));
+  }
+  std::string contents;
+  PutFixed64(&contents, kMetadataMagic);
+  PutFixed32(&contents, kMetadataVersion);
+  PutFixed64(&contents, opt_.cache_size);
+  PutFixed64(&contents, partition_size);
+  PutFixed32(&contents, SPACE_SIZE);
+  PutFixed64(&contents, NUM);
+  for (uint64_t i = 0; i < NUM; i++) {
+    v[i].EncodeTo(&contents);
+  }
+  PutFixed32(&contents,
+             crc32c::Mask(crc32c::Value(contents.data(), contents.size())));
+
+  const std::string tmp_path = GetMetadataPath() + ".tmp";
+  Status s = WriteStringToFile(opt_.env, contents, tmp_path,
+                               /*should_sync=*/true);
+  if (s.ok()) {
+    s = opt_.env->RenameFile(tmp_path, GetMetadataPath());
+  }
+  return s;
+}
+
+Status myCache::LoadMetadata() {
+  std::string contents;
+  Status s = ReadFileToString(opt_.env, GetMetadataPath(), &contents);
+  if (!s.ok()) {
+    return s;
+  }
+  if (contents.size() < sizeof(uint32_t) ||
+      crc32c::Unmask(DecodeFixed32(contents.data() + contents.size() -
+                                   sizeof(uint32_t))) !=
+          crc32c::Value(contents.data(), contents.size() - sizeof(uint32_t))) {
+    return Status::Corruption("myCache metadata checksum mismatch");
+  }
+  Slice input(contents.data(), contents.size() - sizeof(uint32_t));
+  uint64_t magic, cache_size, part_size, num;
+  uint32_t version, space_size;
+  if (!GetFixed64(&input, &magic) || !GetFixed32(&input, &version) ||
+      magic != kMetadataMagic || version != kMetadataVersion) {
+    return Status::Corruption("bad myCache metadata version");
+  }
+  if (!GetFixed64(&input, &cache_size) || !GetFixed64(&input, &part_size) ||
+      !GetFixed32(&input, &space_size) || !GetFixed64(&input, &num)) {
+    return Status::Corruption("bad myCache metadata");
+  }
+  if (cache_size != opt_.cache_size || part_size != partition_size ||
+      space_size != SPACE_SIZE || num != NUM) {
+    return Status::InvalidArgument("myCache layout changed");
+  }
+
+  // blocks of SST files deleted while the cache was closed are useless
+  std::unordered_map<std::string, bool> live_files;
+  auto is_live = [&](const std::string& fname) {
+    if (fname.empty()) {
+      return true;
+    }
+    auto iter = live_files.find(fname);
+    if (iter == live_files.end()) {
+      iter = live_files.emplace(fname, opt_.env->FileExists(fname).ok()).first;
+    }
+    return iter->second;
+  };
+  for (uint64_t i = 0; i < NUM && s.ok(); i++) {
+    s = v[i].DecodeFrom(&input, is_live);
+  }
+  return s;
+}
+
+void myCache::CheckpointMain() {
+  MutexLock _(&checkpoint_lock_);
+  while (!stop_checkpoint_) {
+    checkpoint_cv_.TimedWait(opt_.env->NowMicros() +
+                             opt_.metadata_checkpoint_interval_sec * 1000000);
+    if (stop_checkpoint_) {
+      break;
+    }
+    checkpoint_lock_.Unlock();
+    Status s = SaveMetadata();
+    if (!s.ok()) {
+      Warn(opt_.log, "Error saving myCache metadata. %s",
+           s.ToString().c_str());
+    }
+    checkpoint_lock_.Lock();
+  }
+}
+
 Status myCache::Open() {
-  // MutexLock _(&lock_);
-  std::string path = opt_.path;
-  path += "/pcache_file";
-  // std::string path2 = path + "Get_sst";
-  // std::string path3 = path + "Put_sst";
-
-  // fp = fopen(path2.c_str(), "w+");
-  // fp2 = fopen(path3.c_str(), "w+");
-  fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0777);
-  lseek(fd, opt_.cache_size, SEEK_SET);
+  Status s = opt_.env->CreateDirIfMissing(opt_.path);
+  if (!s.ok()) {
+    return s;
+  }
+  std::string path = GetDataPath();
+  NUM = opt_.num_partitions > 0 ? opt_.num_partitions
+                                 : opt_.cache_size / SST_SIZE;
+  partition_size =
+      NUM > 0 ? opt_.cache_size / NUM / SPACE_SIZE * SPACE_SIZE : 0;
+  if (partition_size == 0) {
+    return Status::InvalidArgument("myCache cache_size too small");
+  }
+  // the data file is kept across restarts, blocks are found again through
+  // the metadata. fd is only set once nothing can fail anymore, so that a
+  // failed Open() leaves nothing for Close() to save.
+  int file = open(path.c_str(), O_RDWR | O_CREAT, 0777);
+  if (file < 0) {
+    return Status::IOError("While opening " + path, strerror(errno));
+  }
   int t = -1;
-  ssize_t tt = write(fd, &t, sizeof(int));
-  if (tt < 0) {
-    return Status::IOError();
+  if (pwrite(file, &t, sizeof(t), opt_.cache_size) !=
+      static_cast<ssize_t>(sizeof(t))) {
+    s = Status::IOError("While extending " + path, strerror(errno));
+    close(file);
+    return s;
   }
-
-  NUM = opt_.cache_size / SST_SIZE;
-  // v.resize(NUM);
+  v.reset(new SST_space[NUM]);
   for (uint64_t i = 0; i < NUM; i++) {
-    v[i].Set_Par(fd, SST_SIZE / SPACE_SIZE, i * SST_SIZE);
+    v[i].Set_Par(file, static_cast<uint32_t>(partition_size / SPACE_SIZE),
+                 i * partition_size);
+  }
+  fd = file;
+  s = LoadMetadata();
+  if (!s.ok() && !s.IsNotFound()) {
+    Warn(opt_.log, "Discarding myCache metadata. %s", s.ToString().c_str());
   }
   if (opt_.pipeline_writes) {
-    insert_th_ = port::Thread(&myCache::InsertMain, this);
+    size_t num_threads = static_cast<size_t>(
+        std::min<uint64_t>(std::max(opt_.num_insert_threads, 1u), NUM));
+    for (size_t i = 0; i < num_threads; i++) {
+      insert_ops_.emplace_back(new BoundedQueue<myInsertOp>(static_cast<size_t>(
+          std::min<uint64_t>(opt_.max_write_pipeline_backlog_size / num_threads,
+                             std::numeric_limits<size_t>::max()))));
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+      insert_threads_.emplace_back(&myCache::InsertMain, this, i);
+    }
+  }
+  if (opt_.metadata_checkpoint_interval_sec > 0) {
+    checkpoint_th_ = port::Thread(&myCache::CheckpointMain, this);
   }
+  closed_ = false;
   return Status::OK();
 }
 Status myCache::Close() {
-  // MutexLock _(&lock_);
-  if (opt_.pipeline_writes && insert_th_.joinable()) {
+  if (closed_.exchange(true)) {
+    // already closed, or never opened
+    return Status::OK();
+  }
+  {
+    // wait for the ops in flight, the next ones see closed_; the insert
+    // queues and the data file are only torn down after that
+    WriteLock _(&lock_);
+  }
+  for (auto& ops : insert_ops_) {
     myInsertOp op(/*quit=*/true);
-    insert_ops_.Push(std::move(op));
-    insert_th_.join();
+    ops->Push(std::move(op));
+  }
+  for (auto& th : insert_threads_) {
+    th.join();
+  }
+  insert_threads_.clear();
+  insert_ops_.clear();
+  if (checkpoint_th_.joinable()) {
+    {
+      MutexLock _(&checkpoint_lock_);
+      stop_checkpoint_ = true;
+      checkpoint_cv_.SignalAll();
+    }
+    checkpoint_th_.join();
+  }
+  Status s = SaveMetadata();
+  if (!s.ok()) {
+    Error(opt_.log, "Error saving myCache metadata. %s", s.ToString().c_str());
   }
   close(fd);
-  // fclose(fp);
-  // fclose(fp2);
-  uint64_t all_empty_num = 0;
+  fd = -1;
+  SST_space::SpaceStats space;
   for (uint64_t i = 0; i < NUM; i++) {
-    all_empty_num += v[i].empty_num;
+    v[i].AddSpaceStats(&space);
   }
-
-  fprintf(stderr, "/n/n\n all_empty_num=%ld \n", all_empty_num);
-  fprintf(stderr, "/n/n\n outall=%ld\n", outall);
+  Info(opt_.log,
+       "Closed myCache: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64
+       " inserts, %" PRIu64 " evictions, %" PRIu64 " bytes free in %" PRIu64
+       " extents",
+       hits_.load(), misses_.load(), inserts_.load(), outall.load(),
+       space.free_bytes, space.free_extents);
   return Status::OK();
 }
 bool myCache::Erase(const Slice&) { return true; }
+
+Status myCache::EraseFile(const std::string& fname) {
+  if (fname.empty()) {
+    return Status::OK();
+  }
+  ReadLock _(&lock_);
+  if (closed_) {
+    return Status::OK();
+  }
+  size_t num_erased = v[getIndex(fname)].EraseFile(fname);
+  Info(opt_.log, "Erased %" ROCKSDB_PRIszt " blocks of %s from myCache",
+       num_erased, fname.c_str());
+  return Status::OK();
+}
 bool myCache::Reserve(const size_t, bool) { return true; }
 
 bool myCache::IsCompressed() { return opt_.is_compressed; }
 
+PersistentCache::StatsType myCache::Stats() {
+  std::map<std::string, double> stats;
+  Add(&stats, "persistentcache.mycache.insert_dropped",
+      insert_dropped_.load());
+  Add(&stats, "persistentcache.mycache.evictions", outall.load());
+  Add(&stats, "persistentcache.mycache.insert_admitted",
+      insert_admitted_.load());
+  Add(&stats, "persistentcache.mycache.insert_rejected",
+      insert_rejected_.load());
+  Add(&stats, "persistentcache.mycache.hits", hits_.load());
+  Add(&stats, "persistentcache.mycache.misses", misses_.load());
+  Add(&stats, "persistentcache.mycache.inserts", inserts_.load());
+  Add(&stats, "persistentcache.mycache.bytes_read", bytes_read_.load());
+  Add(&stats, "persistentcache.mycache.bytes_written", bytes_written_.load());
+
+  {
+    ReadLock _(&lock_);
+    if (!closed_) {
+      SST_space::SpaceStats space;
+      for (uint64_t i = 0; i < NUM; i++) {
+        v[i].AddSpaceStats(&space);
+      }
+      Add(&stats, "persistentcache.mycache.blocks", space.blocks);
+      Add(&stats, "persistentcache.mycache.fragmented_blocks",
+          space.fragmented_blocks);
+      Add(&stats, "persistentcache.mycache.used_bytes", space.used_bytes);
+      Add(&stats, "persistentcache.mycache.free_bytes", space.free_bytes);
+      Add(&stats, "persistentcache.mycache.free_extents", space.free_extents);
+      Add(&stats, "persistentcache.mycache.largest_free_extent",
+          space.largest_free_extent);
+    }
+  }
+
+  auto out = PersistentCacheTier::Stats();
+  out.push_back(stats);
+  return out;
+}
+
 std::string myCache::GetPrintableOptions() const { return opt_.ToString(); }
 
 }  // namespace rocksdb
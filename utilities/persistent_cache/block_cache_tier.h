@@ -11,6 +11,8 @@
 #endif // ! OS_WIN
 
 #include <atomic>
+#include <functional>
+#include <map>
 #include <list>
 #include <memory>
 #include <set>
@@ -20,6 +22,7 @@
 #include <thread>
 
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <unistd.h>
 #include <fcntl.h>
@@ -143,6 +146,8 @@ class BlockCacheTier : public PersistentCacheTier {
     std::atomic<uint64_t> cache_misses_{0};
     std::atomic<uint64_t> cache_errors_{0};
     std::atomic<uint64_t> insert_dropped_{0};
+    std::atomic<uint64_t> insert_admitted_{0};
+    std::atomic<uint64_t> insert_rejected_{0};
 
     double CacheHitPct() const {
       const auto lookups = cache_hits_ + cache_misses_;
@@ -182,15 +187,31 @@ class BlockCacheTier : public PersistentCacheTier {
 #define SST_SIZE (40 * 1024*1024)  //单个SST所占空间 800KB
 #define SPACE_SIZE (4 * 1024)  //单个空间大小     4KB
 
+struct Extent  // 连续空间
+{
+  uint32_t slot;  // first SPACE_SIZE slot of the extent
+  uint32_t num;   // number of slots
+};
 struct Record  // KV记录结构
 {
-  std::vector<uint64_t> offset;
+  // most blocks fit in one extent, more are only used when the free space
+  // of the partition is fragmented
+  std::vector<Extent> extents;
   size_t size;
+  uint32_t checksum = 0;  // crc32c of the data
+  // restored from the metadata of a previous run, the checksum is verified
+  // on the first read
+  bool unverified = false;
 };
 struct DLinkedNode  //双向链表节点
 {
   std::string key;
+  std::string fname;  // SST file the block belongs to
   int out=0; //is_meta 设置为1 淘汰时out-1 out=0时才会被淘汰
+  // readers doing I/O on the extents, which are freed by the last of them
+  // once the node is dropped
+  int refs = 0;
+  bool dropped = false;
   Record value;
   DLinkedNode* prev;
   DLinkedNode* next;
@@ -200,47 +221,132 @@ struct DLinkedNode  //双向链表节点
 class SST_space  // cache 管理单个SST所占空间
 {
  public:
-  SST_space(){};
+  SST_space() : head(nullptr), tail(nullptr) {}
+  ~SST_space() {
+    if (head == nullptr) {
+      return;
+    }
+    while (head->next != tail) {
+      DLinkedNode* node = removeTail();
+      assert(node->refs == 0);
+      delete node;
+    }
+    delete head;
+    delete tail;
+  }
   void Set_Par(int fd_, uint32_t num, uint64_t begin_) {
     fd = fd_;
     begin = begin_;
     all_num = num;
-    empty_num = num;
-    bit_map.resize(num);
-    bit_map.assign(num, 0);
+    empty_num = 0;
+    freeExtent(Extent{0, num});
     head = new DLinkedNode();
     tail = new DLinkedNode();
     head->next = tail;
     tail->prev = head;
   }
   SST_space(int fd_, int num, uint64_t begin_)
-      : fd(fd_), begin(begin_), all_num(num), empty_num(num)
+      : fd(fd_), begin(begin_), all_num(num), empty_num(0)
       {
-    bit_map.resize(num);
-    bit_map.assign(num, 0);
+    freeExtent(Extent{0, static_cast<uint32_t>(num)});
     head = new DLinkedNode();
     tail = new DLinkedNode();
     head->next = tail;
     tail->prev = head;
   }
 
+  // Get and Put only hold lock to update the index, the data is read and
+  // written without it
   Status Get(const std::string key, std::unique_ptr<char[]>* data,
              size_t* size);
 
-  void Put(const std::string &key, const std::string &value,uint64_t&,bool is_meta);
+  // A block to put
+  struct PutRequest {
+    Slice key;
+    Slice value;
+    Slice fname;
+    bool is_meta;
+  };
+
+  // What a Put() did
+  struct PutResult {
+    uint64_t added = 0;  // blocks written
+    uint64_t bytes_written = 0;
+    uint64_t evicted = 0;  // blocks evicted to make room
+  };
+
+  // Puts the blocks of reqs, in order, writing the extents adjacent in the
+  // file with one pwritev
+  PutResult Put(const PutRequest* reqs, size_t n);
+
+  // Space usage of a partition, summed up by AddSpaceStats()
+  struct SpaceStats {
+    uint64_t blocks = 0;
+    uint64_t fragmented_blocks = 0;  // blocks stored in several extents
+    uint64_t used_bytes = 0;  // slots taken by the blocks, in bytes
+    uint64_t free_bytes = 0;
+    uint64_t free_extents = 0;
+    uint64_t largest_free_extent = 0;  // bytes
+  };
+
+  // Adds the space usage of the partition to stats, in time linear in the
+  // number of blocks
+  void AddSpaceStats(SpaceStats* stats);
+
+  // Appends the entries of the partition to dst, most recently used first
+  void EncodeTo(std::string* dst);
+
+  // Restores the entries appended by EncodeTo() from input, skipping those
+  // whose SST file is not live or whose space is taken already
+  Status DecodeFrom(Slice* input,
+                    const std::function<bool(const std::string&)>& is_live);
+
+  // Frees the space of all the blocks of SST file fname, returns their number
+  size_t EraseFile(const std::string& fname);
 
 
  private:
+  // Takes num free slots, in as few extents as possible: the smallest free
+  // extent that fits, else the largest ones until num slots are found
+  void allocate(uint32_t num, std::vector<Extent>* extents);
+  // Returns the slots of extent to the free space, merged with its free
+  // neighbours
+  void freeExtent(Extent extent);
+  // Takes the slots of extent if they are all free
+  bool reserveExtent(Extent extent);
+
   void removeRecord(Record* record) {
-    int free_num = record->offset.size();
-    for (uint32_t i = 0; i < record->offset.size(); i++) {
-      uint64_t index = record->offset[i] / SPACE_SIZE;
-      empty_nodes.push_back(index);
-      bit_map[index] = 0;
+    for (const Extent& extent : record->extents) {
+      freeExtent(extent);
+    }
+    record->extents.clear();
+  }
+  void addToFile(DLinkedNode* node) { file_nodes[node->fname].insert(node); }
+  void removeFromFile(DLinkedNode* node) {
+    auto iter = file_nodes.find(node->fname);
+    assert(iter != file_nodes.end());
+    iter->second.erase(node);
+    if (iter->second.empty()) {
+      file_nodes.erase(iter);
+    }
+  }
+  // frees a node already taken out of the LRU list, or leaves that to
+  // unpin() while it has readers
+  void dropNode(DLinkedNode* node) {
+    cache.erase(node->key);
+    removeFromFile(node);
+    node->dropped = true;
+    if (node->refs == 0) {
+      removeRecord(&(node->value));
+      delete node;
+    }
+  }
+  void unpin(DLinkedNode* node) {
+    assert(node->refs > 0);
+    if (--node->refs == 0 && node->dropped) {
+      removeRecord(&(node->value));
+      delete node;
     }
-    record->offset.clear();
-    empty_num += free_num;
-    //fprintf(stderr,"in removeRecord empty_num=%d\n",empty_num);
   }
   void addToHead(DLinkedNode* node) {
     node->prev = head;
@@ -248,6 +354,12 @@ class SST_space  // cache 管理单个SST所占空间
     head->next->prev = node;
     head->next = node;
   }
+  void addToTail(DLinkedNode* node) {
+    node->next = tail;
+    node->prev = tail->prev;
+    tail->prev->next = node;
+    tail->prev = node;
+  }
 
   void removeNode(DLinkedNode* node) {
     node->prev->next = node->next;
@@ -268,23 +380,31 @@ class SST_space  // cache 管理单个SST所占空间
     return node;
   }
 
+  // Evicts blocks until there is space for the unpublished node, and
+  // allocates its extents. Returns false if the space is pinned by readers.
+  bool prepareNode(DLinkedNode* node, uint32_t need_num, uint64_t* out);
+  // Makes a node, whose data is written, visible to readers
+  void publishNode(DLinkedNode* node);
+
  public:
   port::Mutex lock;
   int fd=-1;
   uint64_t begin;             //指向该SST空间起始位置
-  std::vector<bool> bit_map;  // bitmap暂时用bool数组代替
+  std::map<uint32_t, uint32_t> free_extents;  // 空闲空间 first slot -> num
+  std::set<std::pair<uint32_t, uint32_t>> free_by_size;  // (num, first slot)
   uint32_t all_num;           //总空间数
   uint32_t empty_num;         //空空间数
   std::unordered_map<std::string, DLinkedNode*> cache;
+  // blocks of every SST file, to drop them when the file is deleted
+  std::unordered_map<std::string, std::unordered_set<DLinkedNode*>>
+      file_nodes;
   DLinkedNode *head, *tail;
-
-  std::vector<uint64_t> empty_nodes;
-  uint32_t last=0;
 };
 
 class myCache : public PersistentCacheTier {
  public:
-  explicit myCache(const PersistentCacheConfig& opt) : opt_(opt) {}
+  explicit myCache(const PersistentCacheConfig& opt)
+      : opt_(opt), checkpoint_cv_(&checkpoint_lock_) {}
   virtual ~myCache(){
       Close();
   }
@@ -293,76 +413,123 @@ class myCache : public PersistentCacheTier {
   // Pipelined operation
   struct myInsertOp {
     explicit myInsertOp(const bool signal) :signal_(signal) {}
-    explicit myInsertOp(std::string&& key, const std::string& value,bool is_meta_, 
-                        const std::string& fname)
-        : key_(std::move(key)), value_(value),is_meta(is_meta_), fname_(fname) {}
+    // the only copy of the data of an insert
+    explicit myInsertOp(std::string&& key, const char* data, size_t size,
+                        bool is_meta_, std::string&& fname, int index)
+        : key_(std::move(key)),
+          data_(new char[size]),
+          size_(size),
+          is_meta(is_meta_),
+          fname_(std::move(fname)),
+          index_(index) {
+      memcpy(data_.get(), data, size);
+    }
     ~myInsertOp() {}
 
     myInsertOp() = delete;
+    myInsertOp(const myInsertOp&) = delete;
+    myInsertOp& operator=(const myInsertOp&) = delete;
     myInsertOp(myInsertOp&& /*rhs*/) = default;
     myInsertOp& operator=(myInsertOp&& rhs) = default;
 
     // used for estimating size by bounded queue
-    size_t Size() { return value_.size() + key_.size(); }
+    size_t Size() { return size_ + key_.size(); }
 
 
     std::string key_;
-    std::string value_;
-    bool is_meta;
+    std::unique_ptr<char[]> data_;
+    size_t size_ = 0;
+    bool is_meta = false;
     std::string fname_;
-    
+    int index_ = 0;  // partition
+
     bool signal_ = false;  // signal to request processing thread to exit
   };
 
+  // most inserts an insert thread puts at once
+  static const size_t kMaxInsertBatch = 64;
+
   int getIndex(
       std::string fname,bool stat=false);  // filename 格式一般为 /.../0000123.sst
                           // 此处使用sst序号作为index，若非该格式 则放入最后
 
+  // Data file holding the cached blocks
+  std::string GetDataPath() const { return opt_.path + "/pcache_file"; }
+  // Metadata of the data file, saved by SaveMetadata()
+  std::string GetMetadataPath() const { return GetDataPath() + ".meta"; }
+
+  // Saves the entries of all partitions to the metadata file, replacing it
+  // atomically
+  Status SaveMetadata();
+  // Restores the entries saved by the last SaveMetadata(), dropping those of
+  // SST files that no longer exist
+  Status LoadMetadata();
+  // entry point for the thread saving the metadata periodically
+  void CheckpointMain();
+
+  static const uint64_t kMetadataMagic = 0x6d79436163686531ull;  // myCache1
+  static const uint32_t kMetadataVersion = 3;
+
 
  public:
-  void InsertMain();
+  // entry point of insert thread shard
+  void InsertMain(size_t shard);
   Status Insert(const Slice& key, const char* data, const size_t size,bool is_meta_block=false,
                 std::string fanme = "") override;
 
   Status Lookup(const Slice& key, std::unique_ptr<char[]>* data, size_t* size,
                 std::string fanme = "") override;
 
-  Status InsertImpl(const std::string& key, const std::string& value,bool is_meta,
-                        std::string& fname); 
+  Status InsertImpl(const Slice& key, const Slice& value, bool is_meta,
+                    const std::string& fname);
+  // Puts the blocks of reqs into partition index and records the outcome
+  void PutBlocks(int index, const SST_space::PutRequest* reqs, size_t n);
 
 
   Status Open() override;
   Status Close() override;
   bool Erase(const Slice& key) override;
+  Status EraseFile(const std::string& fname) override;
   bool Reserve(const size_t size,bool) override;
 
   bool IsCompressed() override;
 
   std::string GetPrintableOptions() const override;
 
-  // PersistentCache::StatsType Stats() override;
+  PersistentCache::StatsType Stats() override;
  private:
-  BoundedQueue<myInsertOp> insert_ops_;  // Ops waiting for insert
-  rocksdb::port::Thread insert_th_;      // Insert thread
-  //port::Mutex lock_;                   // Synchronization
+  // Ops waiting for insert, one queue per insert thread
+  std::vector<std::unique_ptr<BoundedQueue<myInsertOp>>> insert_ops_;
+  std::vector<port::Thread> insert_threads_;
+  std::atomic<uint64_t> insert_dropped_{0};
+  // decisions of opt_.admission_policy
+  std::atomic<uint64_t> insert_admitted_{0};
+  std::atomic<uint64_t> insert_rejected_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> inserts_{0};  // blocks written
+  std::atomic<uint64_t> bytes_read_{0};
+  std::atomic<uint64_t> bytes_written_{0};
+  // Insert(), Lookup() and the others using the partitions hold it shared;
+  // Close() takes it exclusively to wait for them before tearing down
+  port::RWMutex lock_;
+  // until Open() succeeds, and from the start of Close()
+  std::atomic<bool> closed_{true};
 
   int fd=-1;
   uint64_t NUM;
+  uint64_t partition_size;  // bytes, a multiple of SPACE_SIZE
 
   const PersistentCacheConfig opt_;  // BlockCache options
 
-  //std::vector<SST_space> v;
-  SST_space v[200];
-
-
+  port::Mutex checkpoint_lock_;
+  port::CondVar checkpoint_cv_;
+  bool stop_checkpoint_ = false;
+  rocksdb::port::Thread checkpoint_th_;  // Metadata checkpoint thread
 
+  std::unique_ptr<SST_space[]> v;  // NUM partitions
 
-  uint64_t outnum=0;
-  uint64_t outall=0;
-  FILE* fp,*fp2;
-  uint64_t allnum=0;
-  uint64_t smallnum=0;
-  uint64_t bignum=0;
+  std::atomic<uint64_t> outall{0};  // evictions
 };
 
 }  // namespace rocksdb
@@ -0,0 +1,85 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#ifndef ROCKSDB_LITE
+
+#include "utilities/persistent_cache/persistent_cache_admission.h"
+
+#include <algorithm>
+
+#include "util/hash.h"
+
+namespace rocksdb {
+
+TinyLFUAdmissionPolicy::TinyLFUAdmissionPolicy(size_t sample_size,
+                                               uint32_t min_frequency)
+    : sample_size_(std::max<size_t>(sample_size, 1)),
+      min_frequency_(min_frequency),
+      width_(1),
+      num_samples_(0) {
+  while (width_ < sample_size_) {
+    width_ <<= 1;
+  }
+  counters_.reset(new std::atomic<uint8_t>[kDepth * width_]);
+  for (size_t i = 0; i < kDepth * width_; i++) {
+    counters_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void TinyLFUAdmissionPolicy::GetCounters(
+    const Slice& key, std::atomic<uint8_t>* counters[kDepth]) const {
+  uint64_t hash = GetSliceNPHash64(key);
+  // double hashing, odd h2 to visit distinct columns
+  uint32_t h1 = static_cast<uint32_t>(hash);
+  uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+  for (int i = 0; i < kDepth; i++) {
+    counters[i] = &counters_[i * width_ + ((h1 + i * h2) & (width_ - 1))];
+  }
+}
+
+void TinyLFUAdmissionPolicy::RecordAccess(const Slice& key) {
+  std::atomic<uint8_t>* counters[kDepth];
+  GetCounters(key, counters);
+  // conservative update, only the smallest counters are incremented. Races
+  // only lose increments, which the estimates tolerate.
+  uint8_t min_count = kMaxCount;
+  for (auto* counter : counters) {
+    min_count = std::min(min_count, counter->load(std::memory_order_relaxed));
+  }
+  if (min_count < kMaxCount) {
+    for (auto* counter : counters) {
+      if (counter->load(std::memory_order_relaxed) == min_count) {
+        counter->store(static_cast<uint8_t>(min_count + 1),
+                       std::memory_order_relaxed);
+      }
+    }
+  }
+
+  if (num_samples_.fetch_add(1, std::memory_order_relaxed) + 1 ==
+      sample_size_) {
+    Age();
+    num_samples_.fetch_sub(sample_size_, std::memory_order_relaxed);
+  }
+}
+
+uint32_t TinyLFUAdmissionPolicy::EstimateFrequency(const Slice& key) const {
+  std::atomic<uint8_t>* counters[kDepth];
+  GetCounters(key, counters);
+  uint8_t min_count = kMaxCount;
+  for (auto* counter : counters) {
+    min_count = std::min(min_count, counter->load(std::memory_order_relaxed));
+  }
+  return min_count;
+}
+
+void TinyLFUAdmissionPolicy::Age() {
+  for (size_t i = 0; i < kDepth * width_; i++) {
+    counters_[i].store(counters_[i].load(std::memory_order_relaxed) >> 1,
+                       std::memory_order_relaxed);
+  }
+}
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,81 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#ifndef ROCKSDB_LITE
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// PersistentCacheAdmissionPolicy
+//
+// Decides which pages a persistent cache tier stores. Without one, a tier
+// inserts every page missing the RAM cache, so that a single scan can
+// replace its whole content, and wears the device out with pages that are
+// never read again.
+class PersistentCacheAdmissionPolicy {
+ public:
+  virtual ~PersistentCacheAdmissionPolicy() {}
+
+  virtual const char* Name() const = 0;
+
+  // Called on every lookup of the page key in the tier, hit or miss
+  virtual void RecordAccess(const Slice& key) = 0;
+
+  // Whether the page key is worth inserting into the tier
+  virtual bool Admit(const Slice& key) = 0;
+};
+
+// TinyLFUAdmissionPolicy
+//
+// Estimates the access frequency of the pages with a count-min sketch of
+// counters saturating at 15, all halved every sample_size accesses so that
+// the estimates follow the recent workload. A page is admitted once it was
+// accessed min_frequency times, which keeps out the pages read only once,
+// by a scan for instance.
+//
+// The sketch takes 4 bytes per sample, sample_size should be a few times
+// the number of pages the tier holds.
+class TinyLFUAdmissionPolicy : public PersistentCacheAdmissionPolicy {
+ public:
+  explicit TinyLFUAdmissionPolicy(size_t sample_size,
+                                  uint32_t min_frequency = 2);
+
+  const char* Name() const override { return "TinyLFUAdmissionPolicy"; }
+
+  void RecordAccess(const Slice& key) override;
+
+  bool Admit(const Slice& key) override {
+    return EstimateFrequency(key) >= min_frequency_;
+  }
+
+  // Number of accesses to key recorded, an upper bound
+  uint32_t EstimateFrequency(const Slice& key) const;
+
+ private:
+  static const int kDepth = 4;
+  static const uint8_t kMaxCount = 15;
+
+  // Counters of key, one per row
+  void GetCounters(const Slice& key, std::atomic<uint8_t>* counters[kDepth])
+      const;
+  // Halves all counters
+  void Age();
+
+  const size_t sample_size_;
+  const uint32_t min_frequency_;
+  size_t width_;  // counters per row, a power of 2
+  std::unique_ptr<std::atomic<uint8_t>[]> counters_;  // kDepth rows
+  std::atomic<size_t> num_samples_;
+};
+
+}  // namespace rocksdb
+
+#endif  // ROCKSDB_LITE
@@ -10,12 +10,14 @@
 int main() { fprintf(stderr, "Please install gflags to run tools\n"); }
 #else
 #include <atomic>
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <sstream>
 #include <unordered_map>
 
 #include "rocksdb/env.h"
+#include "rocksdb/statistics.h"
 
 #include "utilities/persistent_cache/block_cache_tier.h"
 #include "utilities/persistent_cache/persistent_cache_tier.h"
@@ -26,6 +28,7 @@ int main() { fprintf(stderr, "Please install gflags to run tools\n"); }
 #include "table/block_based/block_builder.h"
 #include "util/gflags_compat.h"
 #include "util/mutexlock.h"
+#include "util/random.h"
 #include "util/stop_watch.h"
 
 DEFINE_int32(nsec, 10, "nsec");
@@ -39,12 +42,29 @@ DEFINE_int32(writer_iosize, 4 * 1024, "File writer IO size");
 DEFINE_int32(writer_qdepth, 1, "File writer qdepth");
 DEFINE_bool(enable_pipelined_writes, false, "Enable async writes");
 DEFINE_string(cache_type, "block_cache",
-              "Cache type. (block_cache, volatile, tiered)");
+              "Cache type. (block_cache, volatile, tiered, mycache)");
 DEFINE_bool(benchmark, false, "Benchmark mode");
 DEFINE_int32(volatile_cache_pct, 10, "Percentage of cache in memory tier.");
+DEFINE_uint64(prepop_keys, 1024 * 1024, "Keys inserted before the run");
+DEFINE_string(key_dist, "uniform",
+              "Distribution of the keys read. (uniform, zipfian) The "
+              "zipfian one favors the keys inserted last");
+DEFINE_double(zipf_theta, 0.99, "Skew of the zipfian key distribution");
+DEFINE_uint64(keys_per_file, 1024,
+              "Keys of every SST file the blocks are attributed to, 0 to "
+              "attribute them to no file. myCache partitions the blocks by "
+              "file");
+DEFINE_int32(sst_deletes_per_sec, 0,
+             "SST files deleted per second, oldest first, and erased from "
+             "the cache. Requires keys_per_file");
+DEFINE_int32(mycache_partitions, 0, "myCache partitions, 0 for the default");
+DEFINE_int32(mycache_insert_threads, 1, "myCache insert threads");
+DEFINE_bool(statistics, false, "Report the statistics of the cache");
 
 namespace rocksdb {
 
+std::shared_ptr<Statistics> dbstats;
+
 std::unique_ptr<PersistentCacheTier> NewVolatileCache() {
   assert(FLAGS_cache_size != std::numeric_limits<uint64_t>::max());
   std::unique_ptr<PersistentCacheTier> pcache(
@@ -105,13 +125,87 @@ std::unique_ptr<PersistentTieredCache> NewTieredCache() {
   return NewTieredCache(FLAGS_cache_size * pct, opt);
 }
 
+std::unique_ptr<PersistentCacheTier> NewMyCache() {
+  assert(FLAGS_cache_size != std::numeric_limits<uint64_t>::max());
+  std::shared_ptr<Logger> log;
+  if (!Env::Default()->NewLogger(FLAGS_log_path, &log).ok()) {
+    fprintf(stderr, "Error creating log %s \n", FLAGS_log_path.c_str());
+    return nullptr;
+  }
+
+  PersistentCacheConfig opt(Env::Default(), FLAGS_path, FLAGS_cache_size, log);
+  opt.pipeline_writes = FLAGS_enable_pipelined_writes;
+  opt.num_partitions = FLAGS_mycache_partitions;
+  opt.num_insert_threads = FLAGS_mycache_insert_threads;
+  opt.statistics = dbstats;
+  std::unique_ptr<PersistentCacheTier> cache(new myCache(opt));
+  Status status = cache->Open();
+  if (!status.ok()) {
+    fprintf(stderr, "Error opening myCache %s\n", status.ToString().c_str());
+    return nullptr;
+  }
+  return cache;
+}
+
+// Zipfian distribution over [0, n), 0 being the most frequent, as generated
+// by YCSB (Gray et al., Quickly generating billion-record synthetic
+// databases)
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t n, double theta)
+      : n_(std::max<uint64_t>(n, 2)),
+        theta_(theta),
+        alpha_(1.0 / (1.0 - theta)),
+        zetan_(Zeta(n_, theta)) {
+    eta_ = (1.0 - std::pow(2.0 / n_, 1.0 - theta_)) /
+           (1.0 - Zeta(2, theta_) / zetan_);
+  }
+
+  // u uniform in [0, 1)
+  uint64_t Next(double u) const {
+    double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    return std::min(
+        n_ - 1, static_cast<uint64_t>(n_ * std::pow(eta_ * u - eta_ + 1.0,
+                                                    alpha_)));
+  }
+
+ private:
+  static double Zeta(uint64_t n, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+  }
+
+  const uint64_t n_;
+  const double theta_;
+  const double alpha_;
+  const double zetan_;
+  double eta_;
+};
+
 //
 // Benchmark driver
 //
 class CacheTierBenchmark {
  public:
   explicit CacheTierBenchmark(std::shared_ptr<PersistentCacheTier>&& cache)
-      : cache_(cache) {
+      : cache_(cache),
+        // myCache drops inserts when overloaded, and evicts or erases what
+        // the readers may look for
+        may_miss_(FLAGS_cache_type == "mycache"),
+        zipf_(FLAGS_key_dist == "zipfian"
+                  ? new ZipfianGenerator(
+                        std::max<uint64_t>(FLAGS_prepop_keys, 1),
+                        FLAGS_zipf_theta)
+                  : nullptr) {
     if (FLAGS_nthread_read) {
       fprintf(stdout, "Pre-populating\n");
       Prepop();
@@ -126,6 +220,9 @@ class CacheTierBenchmark {
           std::bind(&CacheTierBenchmark::Write, this));
     Spawn(FLAGS_nthread_read, &threads,
           std::bind(&CacheTierBenchmark::Read, this));
+    if (FLAGS_sst_deletes_per_sec > 0 && FLAGS_keys_per_file > 0) {
+      Spawn(1, &threads, std::bind(&CacheTierBenchmark::DeleteFiles, this));
+    }
 
     // Wait till FLAGS_nsec and then signal to quit
     StopWatchNano t(Env::Default(), /*auto_start=*/true);
@@ -158,8 +255,14 @@ class CacheTierBenchmark {
         << stats_.bytes_written_.ToString() << std::endl
         << "* Bytes read:" << std::endl
         << stats_.bytes_read_.ToString() << std::endl
+        << "* Reads: " << stats_.hits_ << " hits, " << stats_.misses_
+        << " misses" << std::endl
+        << "* SST files deleted: " << files_deleted_ << std::endl
         << "Cache stats:" << std::endl
         << cache_->PrintStats() << std::endl;
+    if (dbstats) {
+      msg << "Statistics:" << std::endl << dbstats->ToString() << std::endl;
+    }
     fprintf(stderr, "%s\n", msg.str().c_str());
   }
 
@@ -167,7 +270,7 @@ class CacheTierBenchmark {
   // Insert implementation and corresponding helper functions
   //
   void Prepop() {
-    for (uint64_t i = 0; i < 1024 * 1024; ++i) {
+    for (uint64_t i = 0; i < FLAGS_prepop_keys; ++i) {
       InsertKey(i);
       insert_key_limit_++;
       read_key_limit_++;
@@ -176,13 +279,17 @@ class CacheTierBenchmark {
     // Wait until data is flushed
     cache_->TEST_Flush();
     // warmup the cache
-    for (uint64_t i = 0; i < 1024 * 1024; ReadKey(i++)) {
+    for (uint64_t i = 0; i < FLAGS_prepop_keys; ReadKey(i++)) {
     }
   }
 
   void Write() {
     while (!quit_) {
       InsertKey(insert_key_limit_++);
+      if (may_miss_) {
+        // reading a key not written yet is only a miss
+        read_key_limit_++;
+      }
     }
   }
 
@@ -197,7 +304,8 @@ class CacheTierBenchmark {
     // insert
     StopWatchNano timer(Env::Default(), /*auto_start=*/true);
     while (true) {
-      Status status = cache_->Insert(block_key, block.get(), FLAGS_iosize);
+      Status status = cache_->Insert(block_key, block.get(), FLAGS_iosize,
+                                     /*is_meta_block=*/false, FileName(key));
       if (status.ok()) {
         break;
       }
@@ -216,8 +324,23 @@ class CacheTierBenchmark {
   // Read implementation
   //
   void Read() {
+    Random64 rnd(Env::Default()->NowNanos());
     while (!quit_) {
-      ReadKey(random() % read_key_limit_);
+      // keys of the deleted files are not read
+      const uint64_t min = read_key_min_;
+      const uint64_t limit = read_key_limit_;
+      if (limit <= min) {
+        continue;
+      }
+      uint64_t key;
+      if (zipf_) {
+        // the keys inserted last are the hottest
+        const double u = (rnd.Next() >> 11) * (1.0 / (uint64_t(1) << 53));
+        key = limit - 1 - zipf_->Next(u) % (limit - min);
+      } else {
+        key = min + rnd.Uniform(limit - min);
+      }
+      ReadKey(key);
     }
   }
 
@@ -230,12 +353,17 @@ class CacheTierBenchmark {
     StopWatchNano timer(Env::Default(), /*auto_start=*/true);
     std::unique_ptr<char[]> block;
     size_t size;
-    Status status = cache_->Lookup(key, &block, &size);
+    Status status = cache_->Lookup(key, &block, &size, FileName(val));
     if (!status.ok()) {
+      if (may_miss_) {
+        stats_.misses_++;
+        return;
+      }
       fprintf(stderr, "%s\n", status.ToString().c_str());
     }
     assert(status.ok());
     assert(size == (size_t) FLAGS_iosize);
+    stats_.hits_++;
 
     // adjust stats
     const size_t elapsed_micro = timer.ElapsedNanos() / 1000;
@@ -249,6 +377,40 @@ class CacheTierBenchmark {
     }
   }
 
+  //
+  // SST churn implementation
+  //
+  void DeleteFiles() {
+    const uint64_t interval_micros = 1000000 / FLAGS_sst_deletes_per_sec;
+    uint64_t next_file = 0;
+    while (!quit_) {
+      Env::Default()->SleepForMicroseconds(static_cast<int>(interval_micros));
+      // keep the file being written and the one before
+      if ((next_file + 2) * FLAGS_keys_per_file > insert_key_limit_) {
+        continue;
+      }
+      read_key_min_ = (next_file + 1) * FLAGS_keys_per_file;
+      Status status = cache_->EraseFile(FileName(next_file *
+                                                 FLAGS_keys_per_file));
+      if (!status.ok() && !status.IsNotSupported()) {
+        fprintf(stderr, "%s\n", status.ToString().c_str());
+      }
+      next_file++;
+      files_deleted_++;
+    }
+  }
+
+  // SST file the block of key is attributed to
+  std::string FileName(const uint64_t key) {
+    if (FLAGS_keys_per_file == 0) {
+      return "";
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "/bench/%06" PRIu64 ".sst",
+             key / FLAGS_keys_per_file);
+    return name;
+  }
+
   // create data for a key by filling with a certain pattern
   std::unique_ptr<char[]> NewBlock(const uint64_t val) {
     std::unique_ptr<char[]> data(new char[FLAGS_iosize]);
@@ -286,18 +448,26 @@ class CacheTierBenchmark {
       bytes_read_.Clear();
       read_latency_.Clear();
       write_latency_.Clear();
+      hits_ = 0;
+      misses_ = 0;
     }
 
     HistogramImpl bytes_written_;
     HistogramImpl bytes_read_;
     HistogramImpl read_latency_;
     HistogramImpl write_latency_;
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
   };
 
   std::shared_ptr<PersistentCacheTier> cache_;  // cache implementation
+  const bool may_miss_;                         // Lookups can miss ?
+  std::unique_ptr<ZipfianGenerator> zipf_;      // Null for uniform reads
   std::atomic<uint64_t> insert_key_limit_{0};   // data inserted upto
   std::atomic<uint64_t> read_key_limit_{0};     // data can be read safely upto
-  bool quit_ = false;                           // Quit thread ?
+  std::atomic<uint64_t> read_key_min_{0};       // data of deleted files below
+  std::atomic<uint64_t> files_deleted_{0};      // SST files deleted
+  std::atomic<bool> quit_{false};               // Quit thread ?
   mutable Stats stats_;                         // Stats
 };
 
@@ -325,10 +495,22 @@ int main(int argc, char** argv) {
       << std::endl
       << "* cache_type=" << FLAGS_cache_type << std::endl
       << "* benchmark=" << FLAGS_benchmark << std::endl
-      << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl;
+      << "* volatile_cache_pct=" << FLAGS_volatile_cache_pct << std::endl
+      << "* prepop_keys=" << FLAGS_prepop_keys << std::endl
+      << "* key_dist=" << FLAGS_key_dist << std::endl
+      << "* zipf_theta=" << FLAGS_zipf_theta << std::endl
+      << "* keys_per_file=" << FLAGS_keys_per_file << std::endl
+      << "* sst_deletes_per_sec=" << FLAGS_sst_deletes_per_sec << std::endl
+      << "* mycache_partitions=" << FLAGS_mycache_partitions << std::endl
+      << "* mycache_insert_threads=" << FLAGS_mycache_insert_threads
+      << std::endl;
 
   fprintf(stderr, "%s\n", msg.str().c_str());
 
+  if (FLAGS_statistics) {
+    rocksdb::dbstats = rocksdb::CreateDBStatistics();
+  }
+
   std::shared_ptr<rocksdb::PersistentCacheTier> cache;
   if (FLAGS_cache_type == "block_cache") {
     fprintf(stderr, "Using block cache implementation\n");
@@ -339,6 +521,9 @@ int main(int argc, char** argv) {
   } else if (FLAGS_cache_type == "tiered") {
     fprintf(stderr, "Using tiered cache implementation\n");
     cache = rocksdb::NewTieredCache();
+  } else if (FLAGS_cache_type == "mycache") {
+    fprintf(stderr, "Using myCache implementation\n");
+    cache = rocksdb::NewMyCache();
   } else {
     fprintf(stderr, "Unknown option for cache\n");
   }
@@ -10,6 +10,7 @@
 
 #include "utilities/persistent_cache/persistent_cache_test.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <thread>
@@ -291,6 +292,525 @@ TEST_F(PersistentCacheTierTest, FactoryTest) {
   }
 }
 
+// myCache finds its blocks again after a restart, except the ones of SST
+// files deleted in between
+TEST_F(PersistentCacheTierTest, MyCacheWarmRestart) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+  ASSERT_OK(env->CreateDirIfMissing(path));
+  const std::string live_file = path + "/000007.sst";
+  const std::string dead_file = path + "/000008.sst";
+  ASSERT_OK(WriteStringToFile(env, "", live_file));
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/2 * SST_SIZE,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  const std::string block(3 * SPACE_SIZE + 100, 'x');
+  {
+    myCache cache(opt);
+    ASSERT_OK(cache.Open());
+    for (int i = 0; i < 10; i++) {
+      const std::string key = "key" + ToString(i);
+      ASSERT_OK(cache.Insert(key, block.data(), block.size(),
+                             /*is_meta_block=*/false, live_file));
+      ASSERT_OK(cache.Insert(key, block.data(), block.size(),
+                             /*is_meta_block=*/false, dead_file));
+    }
+    ASSERT_OK(cache.Close());
+  }
+
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  for (int i = 0; i < 10; i++) {
+    const std::string key = "key" + ToString(i);
+    std::unique_ptr<char[]> data;
+    size_t size;
+    ASSERT_OK(cache.Lookup(key, &data, &size, live_file));
+    ASSERT_EQ(std::string(data.get(), size), block);
+    ASSERT_TRUE(cache.Lookup(key, &data, &size, dead_file).IsNotFound());
+  }
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+// the blocks of a deleted SST file free their space right away
+TEST_F(PersistentCacheTierTest, MyCacheEraseFile) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/SST_SIZE,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  opt.metadata_checkpoint_interval_sec = 0;
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  const std::string dead_file = path + "/000007.sst";
+  const std::string live_file = path + "/000008.sst";
+  // both files share the only partition, which the blocks of dead_file fill
+  const std::string block(SST_SIZE / 4, 'x');
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK(cache.Insert("dead" + ToString(i), block.data(), block.size(),
+                           /*is_meta_block=*/false, dead_file));
+  }
+  ASSERT_OK(cache.EraseFile(dead_file));
+
+  std::unique_ptr<char[]> data;
+  size_t size;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(cache.Lookup("dead" + ToString(i), &data, &size, dead_file)
+                    .IsNotFound());
+  }
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK(cache.Insert("live" + ToString(i), block.data(), block.size(),
+                           /*is_meta_block=*/false, live_file));
+  }
+  for (int i = 0; i < 4; i++) {
+    ASSERT_OK(cache.Lookup("live" + ToString(i), &data, &size, live_file));
+    ASSERT_EQ(size, block.size());
+  }
+  ASSERT_OK(cache.EraseFile(path + "/000009.sst"));
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+// blocks spread over several extents when the free space is fragmented
+TEST_F(PersistentCacheTierTest, MyCacheFragmentedSpace) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/SST_SIZE,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  opt.metadata_checkpoint_interval_sec = 0;
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  const std::string files[] = {path + "/000007.sst", path + "/000008.sst"};
+  // every other slot of the partition belongs to files[0]
+  const std::string small(SPACE_SIZE, 's');
+  const int num_slots = SST_SIZE / SPACE_SIZE;
+  for (int i = 0; i < num_slots; i++) {
+    ASSERT_OK(cache.Insert("small" + ToString(i), small.data(), small.size(),
+                           /*is_meta_block=*/false, files[i % 2]));
+  }
+  ASSERT_OK(cache.EraseFile(files[0]));
+
+  Random rnd(301);
+  std::string large;
+  test::RandomString(&rnd, 8 * SPACE_SIZE + 10, &large);
+  ASSERT_OK(cache.Insert("large", large.data(), large.size(),
+                         /*is_meta_block=*/false, files[0]));
+  std::unique_ptr<char[]> data;
+  size_t size;
+  ASSERT_OK(cache.Lookup("large", &data, &size, files[0]));
+  ASSERT_EQ(std::string(data.get(), size), large);
+  for (int i = 1; i < num_slots; i += 2) {
+    ASSERT_OK(cache.Lookup("small" + ToString(i), &data, &size, files[1]));
+    ASSERT_EQ(std::string(data.get(), size), small);
+  }
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+// lookups read blocks while they are evicted and their space reused
+TEST_F(PersistentCacheTierTest, MyCacheConcurrentEviction) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/4 * 1024 * 1024,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  opt.metadata_checkpoint_interval_sec = 0;
+  opt.num_partitions = 2;
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+
+  const int kNumKeys = 1000;
+  const std::string fname = path + "/000007.sst";
+  auto block = [](int i) {
+    return std::string(3 * SPACE_SIZE + i % 100,
+                       static_cast<char>('a' + i % 26));
+  };
+  std::atomic<bool> done(false);
+  std::atomic<int> num_found(0);
+  std::vector<port::Thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&, t]() {
+      Random rnd(301 + t);
+      while (!done.load()) {
+        int i = rnd.Uniform(kNumKeys);
+        std::unique_ptr<char[]> data;
+        size_t size;
+        if (cache.Lookup("key" + ToString(i), &data, &size, fname).ok()) {
+          ASSERT_EQ(std::string(data.get(), size), block(i));
+          num_found++;
+        }
+      }
+    });
+  }
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      const std::string value = block(i);
+      ASSERT_OK(cache.Insert("key" + ToString(i), value.data(), value.size(),
+                             /*is_meta_block=*/false, fname));
+    }
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  ASSERT_GT(num_found.load(), 0);
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+// pipelined inserts are spread over the insert threads by partition, and
+// dropped when the backlog is full
+TEST_F(PersistentCacheTierTest, MyCachePipelinedInserts) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+  ASSERT_OK(env->CreateDirIfMissing(path));
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/16 * 1024 * 1024,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = true;
+  opt.metadata_checkpoint_interval_sec = 0;
+  opt.num_partitions = 4;
+  opt.num_insert_threads = 4;
+  std::vector<std::string> files;
+  for (int f = 0; f < 8; f++) {
+    files.push_back(path + "/00000" + ToString(f) + ".sst");
+    ASSERT_OK(WriteStringToFile(env, "", files.back()));
+  }
+  auto block = [](int i) {
+    return std::string(SPACE_SIZE + i * 10, static_cast<char>('a' + i % 26));
+  };
+  {
+    myCache cache(opt);
+    ASSERT_OK(cache.Open());
+    for (int i = 0; i < 200; i++) {
+      const std::string value = block(i);
+      ASSERT_OK(cache.Insert("key" + ToString(i), value.data(), value.size(),
+                             /*is_meta_block=*/false, files[i % 8]));
+    }
+    // the pending inserts are done before closing
+    ASSERT_OK(cache.Close());
+  }
+  {
+    myCache cache(opt);
+    ASSERT_OK(cache.Open());
+    for (int i = 0; i < 200; i++) {
+      std::unique_ptr<char[]> data;
+      size_t size;
+      ASSERT_OK(cache.Lookup("key" + ToString(i), &data, &size, files[i % 8]));
+      ASSERT_EQ(std::string(data.get(), size), block(i));
+    }
+    ASSERT_OK(cache.Close());
+  }
+
+  opt.max_write_pipeline_backlog_size = 1;
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  const std::string value = block(0);
+  ASSERT_OK(cache.Insert("dropped", value.data(), value.size(),
+                         /*is_meta_block=*/false, files[0]));
+  auto stats = cache.Stats();
+  ASSERT_EQ(stats.back()["persistentcache.mycache.insert_dropped"], 1);
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+TEST_F(PersistentCacheTierTest, TinyLFUAdmissionPolicy) {
+  TinyLFUAdmissionPolicy policy(/*sample_size=*/1024, /*min_frequency=*/2);
+  ASSERT_EQ(policy.EstimateFrequency("key"), 0);
+  ASSERT_FALSE(policy.Admit("key"));
+  policy.RecordAccess("key");
+  ASSERT_FALSE(policy.Admit("key"));
+  policy.RecordAccess("key");
+  ASSERT_TRUE(policy.Admit("key"));
+  for (int i = 0; i < 20; i++) {
+    policy.RecordAccess("key");
+  }
+  // saturated
+  ASSERT_EQ(policy.EstimateFrequency("key"), 15);
+
+  // a scan of keys accessed once, which ages the sketch
+  for (int i = 0; i < 1024; i++) {
+    policy.RecordAccess("scan" + ToString(i));
+  }
+  ASSERT_EQ(policy.EstimateFrequency("key"), 7);
+  int num_admitted = 0;
+  for (int i = 0; i < 1024; i++) {
+    num_admitted += policy.Admit("scan" + ToString(i)) ? 1 : 0;
+  }
+  ASSERT_LT(num_admitted, 1024 / 10);
+}
+
+// a page is stored in the tier on its second miss
+TEST_F(PersistentCacheTierTest, MyCacheAdmissionPolicy) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/SST_SIZE,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  opt.metadata_checkpoint_interval_sec = 0;
+  opt.admission_policy = std::make_shared<TinyLFUAdmissionPolicy>(1024);
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  const std::string fname = path + "/000007.sst";
+  const std::string block(SPACE_SIZE, 'x');
+  std::unique_ptr<char[]> data;
+  size_t size;
+  for (int round = 0; round < 2; round++) {
+    ASSERT_TRUE(cache.Lookup("key", &data, &size, fname).IsNotFound());
+    ASSERT_OK(cache.Insert("key", block.data(), block.size(),
+                           /*is_meta_block=*/false, fname));
+  }
+  ASSERT_OK(cache.Lookup("key", &data, &size, fname));
+
+  auto stats = cache.Stats();
+  ASSERT_EQ(stats.back()["persistentcache.mycache.insert_rejected"], 1);
+  ASSERT_EQ(stats.back()["persistentcache.mycache.insert_admitted"], 1);
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+TEST_F(PersistentCacheTierTest, MyCacheStatistics) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/SST_SIZE,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  opt.metadata_checkpoint_interval_sec = 0;
+  opt.statistics = CreateDBStatistics();
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  const std::string fname = path + "/000007.sst";
+  const std::string block(2 * SPACE_SIZE, 'x');
+  std::unique_ptr<char[]> data;
+  size_t size;
+  ASSERT_TRUE(cache.Lookup("key", &data, &size, fname).IsNotFound());
+  ASSERT_OK(cache.Insert("key", block.data(), block.size(),
+                         /*is_meta_block=*/false, fname));
+  ASSERT_OK(cache.Lookup("key", &data, &size, fname));
+
+  Statistics* statistics = opt.statistics.get();
+  ASSERT_EQ(statistics->getTickerCount(PERSISTENT_CACHE_ADD), 1);
+  ASSERT_EQ(statistics->getTickerCount(PERSISTENT_CACHE_BYTES_WRITE),
+            block.size());
+  ASSERT_EQ(statistics->getTickerCount(PERSISTENT_CACHE_BYTES_READ),
+            block.size());
+  ASSERT_EQ(statistics->getTickerCount(PERSISTENT_CACHE_EVICT), 0);
+  HistogramData read_micros;
+  statistics->histogramData(PERSISTENT_CACHE_READ_MICROS, &read_micros);
+  ASSERT_EQ(read_micros.count, 2);
+
+  auto stats = cache.Stats();
+  ASSERT_EQ(stats.back()["persistentcache.mycache.hits"], 1);
+  ASSERT_EQ(stats.back()["persistentcache.mycache.misses"], 1);
+  ASSERT_EQ(stats.back()["persistentcache.mycache.blocks"], 1);
+  ASSERT_EQ(stats.back()["persistentcache.mycache.used_bytes"], block.size());
+  ASSERT_EQ(stats.back()["persistentcache.mycache.free_bytes"],
+            SST_SIZE - block.size());
+  ASSERT_EQ(stats.back()["persistentcache.mycache.free_extents"], 1);
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+namespace {
+// a block cache entry demoted to myCache when evicted, as
+// persistent_cache_demote_on_evict does
+struct DemotedEntry {
+  myCache* cache;
+  std::string fname;
+  std::string data;
+};
+
+void DemoteEntry(const Slice& key, void* value) {
+  auto entry = reinterpret_cast<DemotedEntry*>(value);
+  entry->cache->Insert(key, entry->data.data(), entry->data.size(),
+                       /*is_meta_block=*/false, entry->fname);
+  delete entry;
+}
+}  // namespace
+
+// the block cache keeps evicting, and demoting, while myCache closes, and
+// drops its last blocks once it is closed
+TEST_F(PersistentCacheTierTest, MyCacheEvictWhileClosing) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+  ASSERT_OK(env->CreateDirIfMissing(path));
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/8 * 1024 * 1024,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = true;
+  opt.metadata_checkpoint_interval_sec = 0;
+  opt.num_partitions = 4;
+  opt.num_insert_threads = 2;
+  const std::string fname = path + "/000007.sst";
+  ASSERT_OK(WriteStringToFile(env, "", fname));
+  auto block = [](int i) {
+    return std::string(SPACE_SIZE + i % 100, static_cast<char>('a' + i % 26));
+  };
+
+  for (int run = 0; run < 5; run++) {
+    myCache cache(opt);
+    ASSERT_OK(cache.Open());
+    std::shared_ptr<Cache> block_cache =
+        NewLRUCache(32 * SPACE_SIZE, /*num_shard_bits=*/0);
+    std::atomic<int> num_inserted(0);
+    std::vector<port::Thread> threads;
+    for (int t = 0; t < 4; t++) {
+      threads.emplace_back([&, t]() {
+        for (int i = t; i < 4000; i += 4) {
+          auto entry = new DemotedEntry{&cache, fname, block(i)};
+          ASSERT_OK(block_cache->Insert("key" + ToString(i), entry,
+                                        entry->data.size(), &DemoteEntry));
+          num_inserted++;
+        }
+      });
+    }
+    while (num_inserted.load() < 500 * (run + 1)) {
+      env->SleepForMicroseconds(100);
+    }
+    ASSERT_OK(cache.Close());
+    std::unique_ptr<char[]> data;
+    size_t size;
+    ASSERT_TRUE(cache.Lookup("key0", &data, &size, fname).IsNotFound());
+    for (auto& th : threads) {
+      th.join();
+    }
+    block_cache.reset();
+  }
+
+  // whatever made it to the cache is intact
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  int num_found = 0;
+  for (int i = 0; i < 4000; i++) {
+    std::unique_ptr<char[]> data;
+    size_t size;
+    if (cache.Lookup("key" + ToString(i), &data, &size, fname).ok()) {
+      ASSERT_EQ(std::string(data.get(), size), block(i));
+      num_found++;
+    }
+  }
+  ASSERT_GT(num_found, 0);
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+// the blocks written at once are complete even when pwritev() writes them
+// piecemeal, and a failed Open() leaves nothing to close
+TEST_F(PersistentCacheTierTest, MyCacheShortWrites) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/SPACE_SIZE - 1,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  opt.metadata_checkpoint_interval_sec = 0;
+  {
+    myCache cache(opt);
+    ASSERT_TRUE(cache.Open().IsInvalidArgument());
+    ASSERT_OK(cache.Close());
+  }
+
+  opt.cache_size = SST_SIZE;
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  int num_writes = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "SST_space::Put:Pwritev", [&](void* arg) {
+        // one iovec per call
+        *static_cast<int*>(arg) = 1;
+        num_writes++;
+      });
+  const std::string fname = path + "/000007.sst";
+  std::vector<std::string> keys, blocks;
+  for (int i = 0; i < 8; i++) {
+    keys.push_back("key" + ToString(i));
+    blocks.push_back(std::string(SPACE_SIZE / 2 + i * SPACE_SIZE,
+                                 static_cast<char>('a' + i)));
+  }
+  std::vector<SST_space::PutRequest> reqs;
+  for (int i = 0; i < 8; i++) {
+    reqs.push_back(
+        SST_space::PutRequest{keys[i], blocks[i], fname, /*is_meta=*/false});
+  }
+  cache.PutBlocks(/*index=*/0, reqs.data(), reqs.size());
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  // the blocks and the padding between them
+  ASSERT_EQ(num_writes, 15);
+  for (int i = 0; i < 8; i++) {
+    std::unique_ptr<char[]> data;
+    size_t size;
+    ASSERT_OK(cache.Lookup(keys[i], &data, &size, fname));
+    ASSERT_EQ(std::string(data.get(), size), blocks[i]);
+  }
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
+TEST_F(PersistentCacheTierTest, MyCacheShortReads) {
+  Env* env = Env::Default();
+  const std::string path = path_ + "_mycache";
+  test::DestroyDir(env, path);
+
+  PersistentCacheConfig opt(env, path, /*cache_size=*/SST_SIZE,
+                            std::make_shared<ConsoleLogger>());
+  opt.pipeline_writes = false;
+  opt.metadata_checkpoint_interval_sec = 0;
+  myCache cache(opt);
+  ASSERT_OK(cache.Open());
+  const std::string fname = path + "/000007.sst";
+  std::vector<std::string> keys, blocks;
+  for (int i = 0; i < 4; i++) {
+    keys.push_back("key" + ToString(i));
+    blocks.push_back(std::string(SPACE_SIZE / 2 + i * SPACE_SIZE,
+                                 static_cast<char>('a' + i)));
+    ASSERT_OK(cache.Insert(keys[i], blocks[i].data(), blocks[i].size(),
+                           /*is_meta=*/false, fname));
+  }
+
+  int num_reads = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "SST_space::Get:Pread", [&](void* arg) {
+        size_t* n = static_cast<size_t*>(arg);
+        *n = std::min<size_t>(*n, 1000);
+        num_reads++;
+      });
+  for (int i = 0; i < 4; i++) {
+    std::unique_ptr<char[]> data;
+    size_t size;
+    ASSERT_OK(cache.Lookup(keys[i], &data, &size, fname));
+    ASSERT_EQ(std::string(data.get(), size), blocks[i]);
+  }
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(num_reads, 4);
+
+  // the blocks are gone with the end of the data file
+  ASSERT_EQ(0, truncate((path + "/pcache_file").c_str(), 0));
+  for (int i = 0; i < 4; i++) {
+    std::unique_ptr<char[]> data;
+    size_t size;
+    ASSERT_TRUE(cache.Lookup(keys[i], &data, &size, fname).IsIOError());
+    ASSERT_EQ(data, nullptr);
+  }
+  ASSERT_OK(cache.Close());
+  test::DestroyDir(env, path);
+}
+
 PersistentCacheDBTest::PersistentCacheDBTest() : DBTestBase("/cache_test") {
 #ifdef OS_LINUX
   rocksdb::SyncPoint::GetInstance()->EnableProcessing();
@@ -435,6 +955,93 @@ void PersistentCacheDBTest::RunTest(
   }
 }
 
+namespace {
+// counts the blocks handed to the page cache
+class CountingVolatileCacheTier : public VolatileCacheTier {
+ public:
+  explicit CountingVolatileCacheTier(bool is_compressed)
+      : VolatileCacheTier(is_compressed) {}
+
+  Status Insert(const Slice& page_key, const char* data, const size_t size,
+                bool is_meta_block, std::string fname) override {
+    num_inserts_++;
+    return VolatileCacheTier::Insert(page_key, data, size, is_meta_block,
+                                     fname);
+  }
+
+  uint64_t num_inserts() const { return num_inserts_.load(); }
+
+ private:
+  std::atomic<uint64_t> num_inserts_{0};
+};
+}  // namespace
+
+// test the data blocks reaching the page cache when the block cache evicts
+// them
+TEST_F(PersistentCacheDBTest, DemoteOnEvict) {
+  Options options;
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.compression = kNoCompression;
+  options = CurrentOptions(options);
+
+  // compressed page caches are not supported
+  BlockBasedTableOptions table_options;
+  table_options.persistent_cache = MakeVolatileCache(dbname_);
+  table_options.persistent_cache_demote_on_evict = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+
+  // the block cache holds a few data blocks
+  auto pcache =
+      std::make_shared<CountingVolatileCacheTier>(/*is_compressed=*/false);
+  table_options.persistent_cache = pcache;
+  table_options.block_cache = NewLRUCache(16 * 1024, /*num_shard_bits=*/0);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int num_keys = 256;
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < num_keys; i++) {
+    values.push_back(RandomString(&rnd, 1000));
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  ASSERT_OK(Flush());
+  // the page cache only serves the tables from level 2
+  MoveFilesToLevel(2);
+  Reopen(options);
+
+  // the blocks read are not inserted, they are demoted when evicted
+  for (int i = 0; i < num_keys; i++) {
+    ASSERT_EQ(Get(Key(i)), values[i]);
+  }
+  ASSERT_EQ(TestGetTickerCount(options, PERSISTENT_CACHE_HIT), 0);
+  ASSERT_GT(TestGetTickerCount(options, PERSISTENT_CACHE_MISS), 0);
+
+  // the blocks still cached are dropped once their table is closed, rather
+  // than all demoted when the block cache goes
+  uint64_t num_inserts = pcache->num_inserts();
+  ASSERT_GT(num_inserts, 0);
+  Close();
+  table_options.block_cache->EraseUnRefEntries();
+  ASSERT_EQ(pcache->num_inserts(), num_inserts);
+  Reopen(options);
+
+  // the evicted blocks are promoted from the page cache, and not demoted
+  // again: only the blocks read from the file are
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < num_keys; i++) {
+      ASSERT_EQ(Get(Key(i)), values[i]);
+    }
+  }
+  ASSERT_GT(TestGetTickerCount(options, PERSISTENT_CACHE_HIT), 0);
+  ASSERT_LE(pcache->num_inserts(),
+            TestGetTickerCount(options, PERSISTENT_CACHE_MISS));
+
+  Close();
+  ASSERT_OK(pcache->Close());
+}
+
 #if defined(TRAVIS) || defined(ROCKSDB_VALGRIND_RUN)
 // Travis is unable to handle the normal version of the tests running out of
 // fds, out of space and timeouts. This is an easier version of the test
@@ -11,6 +11,8 @@
 #include <string>
 #include <sstream>
 
+#include "rocksdb/listener.h"
+
 namespace rocksdb {
 
 std::string PersistentCacheConfig::ToString() const {
@@ -49,6 +51,19 @@ std::string PersistentCacheConfig::ToString() const {
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "    is_compressed: %d\n", is_compressed);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "    metadata_checkpoint_interval_sec: %" PRIu64 "\n",
+           metadata_checkpoint_interval_sec);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    num_partitions: %" PRIu32 "\n",
+           num_partitions);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    num_insert_threads: %" PRIu32 "\n",
+           num_insert_threads);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    admission_policy: %s\n",
+           admission_policy ? admission_policy->Name() : "none");
+  ret.append(buffer);
 
   return ret;
 }
@@ -123,6 +138,24 @@ bool PersistentTieredCache::Erase(const Slice& key) {
   return tiers_.front()->Erase(key);
 }
 
+Status PersistentTieredCache::EraseFile(const std::string& fname) {
+  assert(!tiers_.empty());
+  // the pages of fname may be in any tier
+  bool supported = false;
+  Status ret;
+  for (auto& tier : tiers_) {
+    Status s = tier->EraseFile(fname);
+    if (s.IsNotSupported()) {
+      continue;
+    }
+    supported = true;
+    if (ret.ok()) {
+      ret = s;
+    }
+  }
+  return supported ? ret : Status::NotSupported();
+}
+
 PersistentCache::StatsType PersistentTieredCache::Stats() {
   assert(!tiers_.empty());
   return tiers_.front()->Stats();
@@ -158,6 +191,32 @@ bool PersistentTieredCache::IsCompressed() {
   return tiers_.front()->IsCompressed();
 }
 
+//
+// PersistentCacheFileEraser implementation
+//
+namespace {
+class PersistentCacheFileEraser : public EventListener {
+ public:
+  explicit PersistentCacheFileEraser(
+      const std::shared_ptr<PersistentCache>& cache)
+      : cache_(cache) {}
+
+  void OnTableFileDeleted(const TableFileDeletionInfo& info) override {
+    if (info.status.ok()) {
+      cache_->EraseFile(info.file_path);
+    }
+  }
+
+ private:
+  std::shared_ptr<PersistentCache> cache_;
+};
+}  // namespace
+
+std::shared_ptr<EventListener> NewPersistentCacheFileEraser(
+    const std::shared_ptr<PersistentCache>& cache) {
+  return std::make_shared<PersistentCacheFileEraser>(cache);
+}
+
 }  // namespace rocksdb
 
 #endif
@@ -16,7 +16,9 @@
 #include "monitoring/histogram.h"
 #include "rocksdb/env.h"
 #include "rocksdb/persistent_cache.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
+#include "utilities/persistent_cache/persistent_cache_admission.h"
 
 // Persistent Cache
 //
@@ -217,6 +219,52 @@ struct PersistentCacheConfig {
   // uncompressed mode
   bool is_compressed = true;
 
+  // metadata-checkpoint-interval-sec
+  //
+  // myCache keeps the index of its data file in memory. The index is saved
+  // next to the data file on Close() and every that many seconds, and loaded
+  // again on Open(), so that the cache is warm after a restart, including one
+  // after a crash. 0 saves it on Close() only.
+  //
+  // default: 300
+  uint64_t metadata_checkpoint_interval_sec = 300;
+
+  // num-partitions
+  //
+  // myCache splits its data file into that many partitions, each with its
+  // own lock and LRU list. The blocks of an SST file all go to the same
+  // partition. 0 uses one partition per 40MB of cache_size.
+  //
+  // default: 0
+  uint32_t num_partitions = 0;
+
+  // num-insert-threads
+  //
+  // Number of threads myCache writes the pipelined inserts with, each for
+  // its own share of the partitions. The inserts are dropped when the
+  // backlog of a thread exceeds its share of
+  // max_write_pipeline_backlog_size, so that readers never wait for them.
+  //
+  // default: 1
+  uint32_t num_insert_threads = 1;
+
+  // admission-policy
+  //
+  // Decides which of the pages inserted into the tier are stored, the
+  // others are dropped. Supported by myCache and BlockCacheTier.
+  //
+  // default: nullptr, all pages are stored
+  std::shared_ptr<PersistentCacheAdmissionPolicy> admission_policy;
+
+  // statistics
+  //
+  // Where the tier records its PERSISTENT_CACHE_* tickers and histograms,
+  // except the hits and misses, which the table readers record. Supported
+  // by myCache.
+  //
+  // default: nullptr
+  std::shared_ptr<Statistics> statistics;
+
   PersistentCacheConfig MakePersistentCacheConfig(
       const std::string& path, const uint64_t size,
       const std::shared_ptr<Logger>& log);
@@ -297,6 +345,7 @@ class PersistentTieredCache : public PersistentCacheTier {
   Status Open() override;
   Status Close() override;
   bool Erase(const Slice& key) override;
+  Status EraseFile(const std::string& fname) override;
   std::string PrintStats() override;
   PersistentCache::StatsType Stats() override;
   Status Insert(const Slice& page_key, const char* data,
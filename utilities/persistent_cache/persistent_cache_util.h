@@ -6,6 +6,7 @@
 
 #include <limits>
 #include <list>
+#include <vector>
 
 #include "util/mutexlock.h"
 
@@ -15,7 +16,8 @@ namespace rocksdb {
 // Simple synchronized queue implementation with the option of
 // bounding the queue
 //
-// On overflow, the elements will be discarded
+// On overflow, the elements will be discarded, except the ones of size 0
+// (signals)
 //
 template <class T>
 class BoundedQueue {
@@ -26,17 +28,19 @@ class BoundedQueue {
 
   virtual ~BoundedQueue() {}
 
-  void Push(T&& t) {
+  // Returns false if t was discarded
+  bool Push(T&& t) {
     MutexLock _(&lock_);
-    if (max_size_ != std::numeric_limits<size_t>::max() &&
+    if (max_size_ != std::numeric_limits<size_t>::max() && t.Size() > 0 &&
         size_ + t.Size() >= max_size_) {
       // overflow
-      return;
+      return false;
     }
 
     size_ += t.Size();
     q_.push_back(std::move(t));
     cond_empty_.SignalAll();
+    return true;
   }
 
   T Pop() {
@@ -51,6 +55,20 @@ class BoundedQueue {
     return t;
   }
 
+  // Appends up to max_count elements to ts, waiting for the first one
+  void PopBatch(std::vector<T>* ts, size_t max_count) {
+    MutexLock _(&lock_);
+    while (q_.empty()) {
+      cond_empty_.Wait();
+    }
+
+    while (!q_.empty() && max_count-- > 0) {
+      size_ -= q_.front().Size();
+      ts->push_back(std::move(q_.front()));
+      q_.pop_front();
+    }
+  }
+
   size_t Size() const {
     MutexLock _(&lock_);
     return size_;